@@ -0,0 +1,146 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <mla/matrix/all.h++>
+#include <mla/vector/all.h++>
+
+#include <mla/parsers/MatrixMarketLoader.h++>
+#include <mla/Snapshot.h++>
+#include <mla/matrix/SparseCRSView.h++>
+
+#include <mla/operations/level2/gemv.h++>
+
+#include "matrices.h++"
+
+
+using Scalar = double;
+
+
+/**
+ * Writes the laplacian of a n-by-n grid as a MatrixMarket file and as a snapshot, and
+ * returns their common path without extension
+ */
+static std::string
+write_laplacian(size_t n)
+{
+	std::string const base_path = std::string(BENCHMARK_OUTPUT_PATH) + "snapshot_laplacian_" + std::to_string(n);
+
+	if( std::ifstream(base_path + ".snapshot").good() )
+		return base_path;
+
+	auto const A = laplacian_2d_crs<Scalar>(n);
+
+	FILE *file = std::fopen((base_path + ".mtx").c_str(), "w");
+	std::fprintf(file, "%%%%MatrixMarket matrix coordinate real general\n");
+	std::fprintf(file, "%zu %zu %zu\n", A.rows(), A.columns(), A.data.row_pointer.back());
+	for(size_t i = 0; i < A.rows(); i++)
+		for(size_t k = A.data.row_pointer[i]; k < A.data.row_pointer[i+1]; k++)
+			std::fprintf(file, "%zu %zu %.13e\n", i+1, A.data.column_index[k]+1, A.data.values[k]);
+	std::fclose(file);
+
+	mla::save_snapshot(A, base_path + ".snapshot");
+
+	return base_path;
+}
+
+
+static void
+set_counters(benchmark::State &state, size_t nnz)
+{
+	state.counters["nnz"] = nnz;
+	state.counters["nnz/s"] = benchmark::Counter(nnz, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+
+/**
+ * Parses the MatrixMarket file into a SparseCRS
+ */
+static void
+BM_load_MatrixMarketLoader(benchmark::State &state)
+{
+	std::string const path = write_laplacian(state.range(0)) + ".mtx";
+
+	size_t nnz = 0;
+	for(auto _: state)
+	{
+		mla::matrix::SparseCRS<Scalar> A;
+		mla::MatrixMarketLoader(path).load(A);
+		nnz = A.data.values.size();
+		benchmark::DoNotOptimize(A.data.values.data());
+	}
+
+	set_counters(state, nnz);
+}
+BENCHMARK(BM_load_MatrixMarketLoader)->RangeMultiplier(4)->Range(256, 1024)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+/**
+ * Copies the snapshot into a SparseCRS
+ */
+static void
+BM_load_snapshot(benchmark::State &state)
+{
+	std::string const path = write_laplacian(state.range(0)) + ".snapshot";
+
+	size_t nnz = 0;
+	for(auto _: state)
+	{
+		mla::matrix::SparseCRS<Scalar> A;
+		mla::load_snapshot(path, A);
+		nnz = A.data.values.size();
+		benchmark::DoNotOptimize(A.data.values.data());
+	}
+
+	set_counters(state, nnz);
+}
+BENCHMARK(BM_load_snapshot)->RangeMultiplier(4)->Range(256, 1024)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+/**
+ * Maps the snapshot, without reading it
+ */
+static void
+BM_map_SparseCRSView(benchmark::State &state)
+{
+	std::string const path = write_laplacian(state.range(0)) + ".snapshot";
+
+	size_t nnz = 0;
+	for(auto _: state)
+	{
+		mla::matrix::SparseCRSView<Scalar> A(path);
+		nnz = A.nnz();
+		benchmark::DoNotOptimize(A.data.values);
+	}
+
+	set_counters(state, nnz);
+}
+BENCHMARK(BM_map_SparseCRSView)->RangeMultiplier(4)->Range(256, 1024)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+
+/**
+ * Maps the snapshot and runs a first matrix-vector product, which reads every page
+ */
+static void
+BM_map_SparseCRSView_gemv(benchmark::State &state)
+{
+	std::string const path = write_laplacian(state.range(0)) + ".snapshot";
+
+	size_t nnz = 0;
+	for(auto _: state)
+	{
+		mla::matrix::SparseCRSView<Scalar> A(path);
+		mla::vector::Dense<Scalar> x(A.columns()), y(A.rows());
+		mla::gemv((Scalar)1, A, x, (Scalar)0, y);
+		nnz = A.nnz();
+		benchmark::DoNotOptimize(y.data.data());
+	}
+
+	set_counters(state, nnz);
+}
+BENCHMARK(BM_map_SparseCRSView_gemv)->RangeMultiplier(4)->Range(256, 1024)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+BENCHMARK_MAIN();
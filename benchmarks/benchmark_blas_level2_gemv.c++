@@ -0,0 +1,115 @@
+#include <benchmark/benchmark.h>
+
+#include <mla/matrix/all.h++>
+#include <mla/vector/all.h++>
+
+#include <mla/operations/level2/gemv.h++>
+
+#include "matrices.h++"
+
+
+using Scalar = double;
+
+
+static mla::matrix::SparseCRS<Scalar> &
+bcsstk14()
+{
+	static mla::matrix::SparseCRS<Scalar> A = load_matrix_market_crs<Scalar>("coordinate/bcsstk14.mtx");
+	return A;
+}
+
+
+static void
+set_counters(benchmark::State &state, mla::matrix::SparseCRS<Scalar> const &A)
+{
+	size_t const nnz = A.data.row_pointer[A.rows()];
+	state.counters["nnz"] = nnz;
+	state.counters["nnz/s"] = benchmark::Counter(nnz, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+
+/**
+ * SparseCRS x Dense through the specialized CRS kernel
+ */
+static void
+BM_gemv_SparseCRS_bcsstk14(benchmark::State &state)
+{
+	auto &A = bcsstk14();
+	mla::vector::Dense<Scalar> x(A.columns()), y(A.rows());
+	std::fill(x.data.begin(), x.data.end(), 1.0);
+
+	for(auto _: state)
+	{
+		mla::gemv( (Scalar)1, A, x, (Scalar)0, y);
+		benchmark::DoNotOptimize(y.data.data());
+	}
+
+	set_counters(state, A);
+}
+BENCHMARK(BM_gemv_SparseCRS_bcsstk14);
+
+
+/**
+ * SparseCRS x Dense through the generic gemv, which visits A with for_each_nonzero
+ */
+static void
+BM_gemv_generic_bcsstk14(benchmark::State &state)
+{
+	auto &A = bcsstk14();
+	mla::vector::Dense<Scalar> x(A.columns()), y(A.rows());
+	std::fill(x.data.begin(), x.data.end(), 1.0);
+
+	for(auto _: state)
+	{
+		mla::gemv<Scalar, mla::matrix::SparseCRS, mla::vector::Dense, mla::vector::Dense>( (Scalar)1, A, x, (Scalar)1, y);
+		benchmark::DoNotOptimize(y.data.data());
+	}
+
+	set_counters(state, A);
+}
+BENCHMARK(BM_gemv_generic_bcsstk14)->Unit(benchmark::kMillisecond);
+
+
+/**
+ * SparseCRS x Dense on the laplacian of a state.range(0)-by-state.range(0) grid
+ */
+static void
+BM_gemv_SparseCRS_laplacian(benchmark::State &state)
+{
+	auto A = laplacian_2d_crs<Scalar>(state.range(0));
+	mla::vector::Dense<Scalar> x(A.columns()), y(A.rows());
+	std::fill(x.data.begin(), x.data.end(), 1.0);
+
+	for(auto _: state)
+	{
+		mla::gemv( (Scalar)1, A, x, (Scalar)0, y);
+		benchmark::DoNotOptimize(y.data.data());
+	}
+
+	set_counters(state, A);
+}
+BENCHMARK(BM_gemv_SparseCRS_laplacian)->RangeMultiplier(4)->Range(64, 2048)->Unit(benchmark::kMicrosecond);
+
+
+/**
+ * SparseCRS x Dense on the laplacian through the generic gemv
+ */
+static void
+BM_gemv_generic_laplacian(benchmark::State &state)
+{
+	auto A = laplacian_2d_crs<Scalar>(state.range(0));
+	mla::vector::Dense<Scalar> x(A.columns()), y(A.rows());
+	std::fill(x.data.begin(), x.data.end(), 1.0);
+
+	for(auto _: state)
+	{
+		mla::gemv<Scalar, mla::matrix::SparseCRS, mla::vector::Dense, mla::vector::Dense>( (Scalar)1, A, x, (Scalar)1, y);
+		benchmark::DoNotOptimize(y.data.data());
+	}
+
+	set_counters(state, A);
+}
+BENCHMARK(BM_gemv_generic_laplacian)->RangeMultiplier(4)->Range(64, 2048)->Unit(benchmark::kMicrosecond);
+
+
+BENCHMARK_MAIN();
@@ -0,0 +1,145 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include <mla/matrix/all.h++>
+#include <mla/vector/all.h++>
+
+#include <mla/operations/level3/gemm.h++>
+#include <mla/operations/level3/syrk.h++>
+
+#include "matrices.h++"
+
+
+using Scalar = double;
+
+
+static mla::matrix::DenseRowMajor<Scalar>
+random_dense(size_t rows, size_t columns)
+{
+	std::mt19937 generator(rows*31 + columns);
+	std::uniform_real_distribution<Scalar> distribution(-1.0, 1.0);
+
+	mla::matrix::DenseRowMajor<Scalar> A(rows, columns);
+	for(auto &a: A.data.element_vector)
+	{
+		a = distribution(generator);
+	}
+	return A;
+}
+
+
+static void
+set_counters(benchmark::State &state, double flops)
+{
+	state.counters["GFLOP/s"] = benchmark::Counter(flops*1e-9, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+
+/**
+ * Square dense gemm through the packed kernels
+ */
+static void
+BM_gemm_DenseRowMajor(benchmark::State &state)
+{
+	size_t const n = state.range(0);
+	auto A = random_dense(n, n), B = random_dense(n, n), C = random_dense(n, n);
+
+	for(auto _: state)
+	{
+		mla::gemm( (Scalar)1, A, B, (Scalar)0, C);
+		benchmark::DoNotOptimize(C.data.element_vector.data());
+	}
+
+	set_counters(state, 2.0*n*n*n);
+}
+BENCHMARK(BM_gemm_DenseRowMajor)->RangeMultiplier(2)->Range(64, 2048)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+/**
+ * Square dense gemm through the generic element-wise implementation
+ */
+static void
+BM_gemm_naive(benchmark::State &state)
+{
+	size_t const n = state.range(0);
+	auto A = random_dense(n, n), B = random_dense(n, n), C = random_dense(n, n);
+
+	for(auto _: state)
+	{
+		mla::gemm<Scalar, mla::matrix::DenseRowMajor, mla::matrix::DenseRowMajor, mla::matrix::DenseRowMajor>( (Scalar)1, A, B, (Scalar)0, C);
+		benchmark::DoNotOptimize(C.data.element_vector.data());
+	}
+
+	set_counters(state, 2.0*n*n*n);
+}
+BENCHMARK(BM_gemm_naive)->RangeMultiplier(2)->Range(64, 512)->Unit(benchmark::kMillisecond);
+
+
+/**
+ * Rank-k update of one triangle, with k = n
+ */
+static void
+BM_syrk_DenseRowMajor(benchmark::State &state)
+{
+	size_t const n = state.range(0);
+	auto A = random_dense(n, n), C = random_dense(n, n);
+
+	for(auto _: state)
+	{
+		mla::syrk( (Scalar)1, A, (Scalar)0, C, mla::TRIANGLE_LOWER);
+		benchmark::DoNotOptimize(C.data.element_vector.data());
+	}
+
+	set_counters(state, 1.0*n*(n+1)*n);
+}
+BENCHMARK(BM_syrk_DenseRowMajor)->RangeMultiplier(2)->Range(64, 2048)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+/**
+ * SparseCRS x DenseRowMajor on bcsstk14, with state.range(0) columns on the right
+ */
+static void
+BM_gemm_SparseCRS_bcsstk14(benchmark::State &state)
+{
+	static mla::matrix::SparseCRS<Scalar> A = load_matrix_market_crs<Scalar>("coordinate/bcsstk14.mtx");
+
+	size_t const n = state.range(0);
+	auto B = random_dense(A.columns(), n);
+	mla::matrix::DenseRowMajor<Scalar> C(A.rows(), n);
+
+	for(auto _: state)
+	{
+		mla::gemm( (Scalar)1, A, B, (Scalar)0, C);
+		benchmark::DoNotOptimize(C.data.element_vector.data());
+	}
+
+	set_counters(state, 2.0*A.data.row_pointer[A.rows()]*n);
+}
+BENCHMARK(BM_gemm_SparseCRS_bcsstk14)->RangeMultiplier(4)->Range(1, 64)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+
+/**
+ * SparseCRS x DenseRowMajor on the laplacian of a 512-by-512 grid
+ */
+static void
+BM_gemm_SparseCRS_laplacian(benchmark::State &state)
+{
+	static mla::matrix::SparseCRS<Scalar> A = laplacian_2d_crs<Scalar>(512);
+
+	size_t const n = state.range(0);
+	auto B = random_dense(A.columns(), n);
+	mla::matrix::DenseRowMajor<Scalar> C(A.rows(), n);
+
+	for(auto _: state)
+	{
+		mla::gemm( (Scalar)1, A, B, (Scalar)0, C);
+		benchmark::DoNotOptimize(C.data.element_vector.data());
+	}
+
+	set_counters(state, 2.0*A.data.row_pointer[A.rows()]*n);
+}
+BENCHMARK(BM_gemm_SparseCRS_laplacian)->RangeMultiplier(4)->Range(1, 64)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+BENCHMARK_MAIN();
@@ -0,0 +1,265 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <utility>
+
+#include <mla/matrix/all.h++>
+#include <mla/matrix/convert.h++>
+
+
+using Scalar = double;
+
+
+/**
+ * Fills a SparseCRS matrix through the SparseDOK and SparseCOO staging formats, and
+ * through a std::map with the former SparseDOK layout, with two insertion patterns:
+ *  - random: state.range(0) coordinates drawn uniformly from a square matrix with
+ *    state.range(0)/8 rows
+ *  - finite elements: the 4x4 element matrices of a square mesh of bilinear
+ *    quadrilaterals, with about state.range(0) non-zero elements
+ * At 10^8 non-zero elements the staging formats need several GiB of memory.
+ */
+
+
+/**
+ * Linear congruential generator, cheap enough to not hide the insertion cost
+ */
+struct Random
+{
+	uint64_t state;
+
+	explicit Random(uint64_t seed = 1) : state(seed) {}
+
+	size_t operator()(size_t n)
+	{
+		state = state*6364136223846793005ull + 1442695040888963407ull;
+		return (size_t)((state >> 33) % n);
+	}
+};
+
+
+/**
+ * Calls insert(i, j, value) for each element of the random pattern
+ */
+template<typename Insert>
+static void
+random_pattern(size_t nnz, Insert insert)
+{
+	size_t const n = nnz/8;
+	Random random;
+	for(size_t k = 0; k < nnz; k++)
+	{
+		insert(random(n), random(n), (Scalar)1);
+	}
+}
+
+
+/**
+ * Number of nodes of the finite element mesh with about nnz non-zero elements, as each
+ * node of a quadrilateral mesh is coupled with 9 nodes
+ */
+static size_t
+fe_mesh_nodes(size_t nnz)
+{
+	size_t const nodes_per_side = (size_t)std::sqrt(nnz/9.0);
+	return nodes_per_side*nodes_per_side;
+}
+
+
+/**
+ * Calls insert(i, j, value) for each entry of the element matrices of the mesh
+ */
+template<typename Insert>
+static void
+fe_pattern(size_t nnz, Insert insert)
+{
+	size_t const side = (size_t)std::sqrt((double)fe_mesh_nodes(nnz));
+	Scalar const element[4][4] = {
+		{ 4, -1, -2, -1},
+		{-1,  4, -1, -2},
+		{-2, -1,  4, -1},
+		{-1, -2, -1,  4}
+	};
+
+	for(size_t ey = 0; ey+1 < side; ey++)
+	{
+		for(size_t ex = 0; ex+1 < side; ex++)
+		{
+			size_t const node[4] = { ey*side + ex, ey*side + ex+1, (ey+1)*side + ex+1, (ey+1)*side + ex };
+			for(size_t a = 0; a < 4; a++)
+				for(size_t b = 0; b < 4; b++)
+					insert(node[a], node[b], element[a][b]/6);
+		}
+	}
+}
+
+
+enum Pattern
+{
+	PATTERN_RANDOM,
+	PATTERN_FE
+};
+
+
+/**
+ * Returns the number of rows and columns of the matrix of the pattern
+ */
+static size_t
+pattern_size(Pattern pattern, size_t nnz)
+{
+	return pattern == PATTERN_RANDOM ? nnz/8 : fe_mesh_nodes(nnz);
+}
+
+
+template<typename Insert>
+static void
+fill(Pattern pattern, size_t nnz, Insert insert)
+{
+	if(pattern == PATTERN_RANDOM)
+		random_pattern(nnz, insert);
+	else
+		fe_pattern(nnz, insert);
+}
+
+
+static void
+set_counters(benchmark::State &state, size_t nnz)
+{
+	state.counters["nnz"] = nnz;
+	state.counters["nnz/s"] = benchmark::Counter(nnz, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+
+static void
+assemble_SparseDOK(benchmark::State &state, Pattern pattern)
+{
+	size_t const n = pattern_size(pattern, state.range(0));
+
+	size_t nnz = 0;
+	for(auto _: state)
+	{
+		mla::matrix::SparseDOK<Scalar> dok(n, n);
+		fill(pattern, state.range(0), [&dok](size_t i, size_t j, Scalar value) { dok(i,j) += value; });
+
+		mla::matrix::SparseCRS<Scalar> A;
+		mla::matrix::convert(dok, A);
+		nnz = A.data.values.size();
+		benchmark::DoNotOptimize(A.data.values.data());
+	}
+
+	set_counters(state, nnz);
+}
+
+
+static void
+assemble_SparseCOO(benchmark::State &state, Pattern pattern)
+{
+	size_t const n = pattern_size(pattern, state.range(0));
+
+	size_t nnz = 0;
+	for(auto _: state)
+	{
+		mla::matrix::SparseCOO<Scalar> coo(n, n);
+		fill(pattern, state.range(0), [&coo](size_t i, size_t j, Scalar value) { coo.addValue(i, j, value); });
+
+		mla::matrix::SparseCRS<Scalar> A;
+		mla::matrix::convert(coo, A);
+		nnz = A.data.values.size();
+		benchmark::DoNotOptimize(A.data.values.data());
+	}
+
+	set_counters(state, nnz);
+}
+
+
+/**
+ * The former SparseDOK storage, a node-based ordered map
+ */
+static void
+assemble_std_map(benchmark::State &state, Pattern pattern)
+{
+	size_t const n = pattern_size(pattern, state.range(0));
+
+	size_t nnz = 0;
+	for(auto _: state)
+	{
+		std::map< std::pair<size_t,size_t>, Scalar> map;
+		fill(pattern, state.range(0), [&map](size_t i, size_t j, Scalar value) { map[std::make_pair(i,j)] += value; });
+
+		// the map is sorted by row and column
+		mla::matrix::SparseCRS<Scalar> A;
+		A.data.n_columns = n;
+		A.data.row_pointer.assign(n+1, 0);
+		A.data.column_index.clear();
+		A.data.values.clear();
+		for(auto const &kv: map)
+		{
+			A.data.row_pointer[kv.first.first+1]++;
+			A.data.column_index.push_back(kv.first.second);
+			A.data.values.push_back(kv.second);
+		}
+		for(size_t i = 0; i < n; i++)
+		{
+			A.data.row_pointer[i+1] += A.data.row_pointer[i];
+		}
+
+		nnz = A.data.values.size();
+		benchmark::DoNotOptimize(A.data.values.data());
+	}
+
+	set_counters(state, nnz);
+}
+
+
+static void
+BM_SparseDOK_random(benchmark::State &state)
+{
+	assemble_SparseDOK(state, PATTERN_RANDOM);
+}
+BENCHMARK(BM_SparseDOK_random)->Arg(1000000)->Arg(10000000)->Arg(100000000)->Unit(benchmark::kMillisecond);
+
+
+static void
+BM_SparseCOO_random(benchmark::State &state)
+{
+	assemble_SparseCOO(state, PATTERN_RANDOM);
+}
+BENCHMARK(BM_SparseCOO_random)->Arg(1000000)->Arg(10000000)->Arg(100000000)->Unit(benchmark::kMillisecond);
+
+
+static void
+BM_SparseDOK_fe(benchmark::State &state)
+{
+	assemble_SparseDOK(state, PATTERN_FE);
+}
+BENCHMARK(BM_SparseDOK_fe)->Arg(1000000)->Arg(10000000)->Arg(100000000)->Unit(benchmark::kMillisecond);
+
+
+static void
+BM_SparseCOO_fe(benchmark::State &state)
+{
+	assemble_SparseCOO(state, PATTERN_FE);
+}
+BENCHMARK(BM_SparseCOO_fe)->Arg(1000000)->Arg(10000000)->Arg(100000000)->Unit(benchmark::kMillisecond);
+
+
+// the std::map baselines run last, as freeing their nodes slows down the benchmarks that follow
+static void
+BM_std_map_random(benchmark::State &state)
+{
+	assemble_std_map(state, PATTERN_RANDOM);
+}
+BENCHMARK(BM_std_map_random)->Arg(1000000)->Arg(10000000)->Unit(benchmark::kMillisecond);
+
+
+static void
+BM_std_map_fe(benchmark::State &state)
+{
+	assemble_std_map(state, PATTERN_FE);
+}
+BENCHMARK(BM_std_map_fe)->Arg(1000000)->Arg(10000000)->Unit(benchmark::kMillisecond);
+
+
+BENCHMARK_MAIN();
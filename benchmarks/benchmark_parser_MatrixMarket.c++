@@ -0,0 +1,176 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include <mla/matrix/all.h++>
+#include <mla/matrix/convert.h++>
+
+#include <mla/parsers/MatrixMarket.h++>
+#include <mla/parsers/MatrixMarketLoader.h++>
+
+#include "matrices.h++"
+
+
+using Scalar = double;
+
+
+/**
+ * Writes the laplacian of a n-by-n grid with random values, formatted as the
+ * SuiteSparse files, and returns its path.  Symmetric files only hold the lower triangle.
+ */
+static std::string
+write_laplacian(size_t n, bool symmetric)
+{
+	std::string const file_path = std::string(BENCHMARK_OUTPUT_PATH) + "laplacian_" + std::to_string(n) + (symmetric ? "_symmetric" : "_general") + ".mtx";
+
+	if( std::ifstream(file_path).good() )
+		return file_path;
+
+	auto const A = laplacian_2d_crs<Scalar>(n);
+
+	std::mt19937 generator(n);
+	std::uniform_real_distribution<Scalar> distribution(-1.0, 1.0);
+
+	size_t nnz = 0;
+	for(size_t i = 0; i < A.rows(); i++)
+		for(size_t k = A.data.row_pointer[i]; k < A.data.row_pointer[i+1]; k++)
+			if(!symmetric || A.data.column_index[k] <= i)
+				nnz++;
+
+	FILE *file = std::fopen(file_path.c_str(), "w");
+	std::fprintf(file, "%%%%MatrixMarket matrix coordinate real %s\n", symmetric ? "symmetric" : "general");
+	std::fprintf(file, "%zu %zu %zu\n", A.rows(), A.columns(), nnz);
+	for(size_t i = 0; i < A.rows(); i++)
+	{
+		for(size_t k = A.data.row_pointer[i]; k < A.data.row_pointer[i+1]; k++)
+		{
+			size_t const j = A.data.column_index[k];
+			if(!symmetric || j <= i)
+				std::fprintf(file, "%zu %zu %.13e\n", i+1, j+1, A.data.values[k]*distribution(generator));
+		}
+	}
+	std::fclose(file);
+
+	return file_path;
+}
+
+
+static std::string
+bcsstk14()
+{
+	return std::string(FULL_MATRIX_MARKET_FILES_PATH) + "coordinate/bcsstk14.mtx";
+}
+
+
+static void
+set_counters(benchmark::State &state, std::string const &file_path)
+{
+	std::ifstream file(file_path, std::ifstream::binary | std::ifstream::ate);
+	double const bytes = file.tellg();
+
+	state.counters["MB"] = bytes*1e-6;
+	state.counters["MB/s"] = benchmark::Counter(bytes*1e-6, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+
+/**
+ * The stream parser, into a SparseDOK converted to SparseCRS
+ */
+static void
+parse_MatrixMarket(benchmark::State &state, std::string const &file_path)
+{
+	for(auto _: state)
+	{
+		std::ifstream file(file_path, std::ifstream::in);
+		mla::MatrixMarket parser;
+		mla::matrix::SparseDOK<Scalar> dok;
+		parser.parse(file, dok);
+
+		mla::matrix::SparseCRS<Scalar> A;
+		mla::matrix::convert(dok, A);
+		benchmark::DoNotOptimize(A.data.values.data());
+	}
+
+	set_counters(state, file_path);
+}
+
+
+template<template<typename> class MatrixStoragePolicy>
+static void
+load_MatrixMarketLoader(benchmark::State &state, std::string const &file_path)
+{
+	for(auto _: state)
+	{
+		mla::MatrixMarketLoader loader(file_path);
+		MatrixStoragePolicy<Scalar> A;
+		loader.load(A);
+		benchmark::DoNotOptimize(A.data.values.data());
+	}
+
+	set_counters(state, file_path);
+}
+
+
+static void
+BM_MatrixMarket_bcsstk14(benchmark::State &state)
+{
+	parse_MatrixMarket(state, bcsstk14());
+}
+BENCHMARK(BM_MatrixMarket_bcsstk14)->Unit(benchmark::kMillisecond);
+
+
+static void
+BM_MatrixMarketLoader_SparseCRS_bcsstk14(benchmark::State &state)
+{
+	load_MatrixMarketLoader<mla::matrix::SparseCRS>(state, bcsstk14());
+}
+BENCHMARK(BM_MatrixMarketLoader_SparseCRS_bcsstk14)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+/**
+ * Laplacians of state.range(0)-by-state.range(0) grids, stored in full and as symmetric
+ */
+static void
+BM_MatrixMarket_laplacian_general(benchmark::State &state)
+{
+	parse_MatrixMarket(state, write_laplacian(state.range(0), false));
+}
+BENCHMARK(BM_MatrixMarket_laplacian_general)->RangeMultiplier(4)->Range(64, 256)->Unit(benchmark::kMillisecond);
+
+
+static void
+BM_MatrixMarketLoader_SparseCRS_laplacian_general(benchmark::State &state)
+{
+	load_MatrixMarketLoader<mla::matrix::SparseCRS>(state, write_laplacian(state.range(0), false));
+}
+BENCHMARK(BM_MatrixMarketLoader_SparseCRS_laplacian_general)->RangeMultiplier(4)->Range(64, 1024)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+static void
+BM_MatrixMarketLoader_SparseCCS_laplacian_general(benchmark::State &state)
+{
+	load_MatrixMarketLoader<mla::matrix::SparseCCS>(state, write_laplacian(state.range(0), false));
+}
+BENCHMARK(BM_MatrixMarketLoader_SparseCCS_laplacian_general)->RangeMultiplier(4)->Range(64, 1024)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+static void
+BM_MatrixMarket_laplacian_symmetric(benchmark::State &state)
+{
+	parse_MatrixMarket(state, write_laplacian(state.range(0), true));
+}
+BENCHMARK(BM_MatrixMarket_laplacian_symmetric)->RangeMultiplier(4)->Range(64, 256)->Unit(benchmark::kMillisecond);
+
+
+static void
+BM_MatrixMarketLoader_SparseCRS_laplacian_symmetric(benchmark::State &state)
+{
+	load_MatrixMarketLoader<mla::matrix::SparseCRS>(state, write_laplacian(state.range(0), true));
+}
+BENCHMARK(BM_MatrixMarketLoader_SparseCRS_laplacian_symmetric)->RangeMultiplier(4)->Range(64, 1024)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+BENCHMARK_MAIN();
@@ -0,0 +1,90 @@
+#include <benchmark/benchmark.h>
+
+#include <mla/matrix/all.h++>
+#include <mla/vector/all.h++>
+
+#include <mla/solvers/CG.h++>
+
+#include "matrices.h++"
+
+
+using Scalar = double;
+
+
+static mla::matrix::SparseCRS<Scalar> &
+bcsstk14()
+{
+	static mla::matrix::SparseCRS<Scalar> A = load_matrix_market_crs<Scalar>("coordinate/bcsstk14.mtx");
+	return A;
+}
+
+
+/**
+ * Solves [A]{x} = {1} with a PCG solver whose preconditioner is set up once
+ */
+template<template<typename> class Preconditioner>
+static void
+run_pcg(benchmark::State &state, mla::matrix::SparseCRS<Scalar> &A, Preconditioner<Scalar> const &preconditioner = Preconditioner<Scalar>())
+{
+	mla::vector::Dense<Scalar> x(A.rows()), b(A.rows());
+	std::fill(b.data.begin(), b.data.end(), 1.0);
+
+	mla::PCG<Scalar, mla::matrix::SparseCRS, Preconditioner> solver(preconditioner);
+	solver.compute(A);
+
+	for(auto _: state)
+	{
+		x.setZero();
+		solver.solve(x, b, 1e-8, 100000);
+		benchmark::DoNotOptimize(x.data.data());
+	}
+
+	auto const &statistics = solver.statistics();
+	state.counters["iterations"] = statistics.iterations;
+	state.counters["residual"] = statistics.residual_history.back();
+	state.counters["setup_s"] = statistics.setup_time;
+	state.counters["matvec_s"] = statistics.matvec_time;
+	state.counters["preconditioner_s"] = statistics.preconditioner_time;
+	state.counters["vector_s"] = statistics.vector_time;
+}
+
+
+template<template<typename> class Preconditioner>
+static void
+BM_pcg_bcsstk14(benchmark::State &state)
+{
+	run_pcg<Preconditioner>(state, bcsstk14());
+}
+BENCHMARK_TEMPLATE(BM_pcg_bcsstk14, mla::IdentityPreconditioner)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_pcg_bcsstk14, mla::JacobiPreconditioner)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_pcg_bcsstk14, mla::SSORPreconditioner)->Unit(benchmark::kMillisecond);
+
+
+/**
+ * IC(0) breaks down on bcsstk14, so the factorization is computed on a shifted diagonal
+ */
+static void
+BM_pcg_bcsstk14_IC0_shifted(benchmark::State &state)
+{
+	run_pcg<mla::IC0Preconditioner>(state, bcsstk14(), mla::IC0Preconditioner<Scalar>(0.01));
+}
+BENCHMARK(BM_pcg_bcsstk14_IC0_shifted)->Unit(benchmark::kMillisecond);
+
+
+/**
+ * PCG on the laplacian of a state.range(0)-by-state.range(0) grid
+ */
+template<template<typename> class Preconditioner>
+static void
+BM_pcg_laplacian(benchmark::State &state)
+{
+	auto A = laplacian_2d_crs<Scalar>(state.range(0));
+	run_pcg<Preconditioner>(state, A);
+}
+BENCHMARK_TEMPLATE(BM_pcg_laplacian, mla::IdentityPreconditioner)->RangeMultiplier(4)->Range(32, 512)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_pcg_laplacian, mla::JacobiPreconditioner)->RangeMultiplier(4)->Range(32, 512)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_pcg_laplacian, mla::SSORPreconditioner)->RangeMultiplier(4)->Range(32, 512)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_pcg_laplacian, mla::IC0Preconditioner)->RangeMultiplier(4)->Range(32, 512)->Unit(benchmark::kMillisecond);
+
+
+BENCHMARK_MAIN();
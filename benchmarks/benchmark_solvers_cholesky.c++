@@ -0,0 +1,112 @@
+#include <benchmark/benchmark.h>
+
+#include <mla/matrix/all.h++>
+#include <mla/vector/all.h++>
+
+#include <mla/solvers/SparseCholesky.h++>
+
+#include "matrices.h++"
+
+
+using Scalar = double;
+using Cholesky = mla::SparseCholesky<Scalar>;
+
+
+static mla::matrix::SparseCRS<Scalar> &
+bcsstk14()
+{
+	static mla::matrix::SparseCRS<Scalar> A = load_matrix_market_crs<Scalar>("coordinate/bcsstk14.mtx");
+	return A;
+}
+
+
+static void
+set_counters(benchmark::State &state, Cholesky const &cholesky)
+{
+	state.counters["nnz(L)"] = cholesky.nnz();
+	state.counters["supernodes"] = cholesky.supernodes();
+	state.counters["flop/s"] = benchmark::Counter(cholesky.flops(), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+
+/**
+ * Ordering and symbolic analysis
+ */
+static void
+BM_cholesky_analyze_bcsstk14(benchmark::State &state)
+{
+	auto &A = bcsstk14();
+	Cholesky cholesky( (Cholesky::Ordering)state.range(0) );
+
+	for(auto _: state)
+	{
+		cholesky.analyze(A);
+	}
+
+	state.counters["nnz(L)"] = cholesky.nnz();
+}
+BENCHMARK(BM_cholesky_analyze_bcsstk14)->ArgName("ordering")->DenseRange(Cholesky::ORDERING_NATURAL, Cholesky::ORDERING_AMD)->Unit(benchmark::kMillisecond);
+
+
+/**
+ * Numeric factorization over an analyzed sparsity pattern
+ */
+static void
+BM_cholesky_factorize_bcsstk14(benchmark::State &state)
+{
+	auto &A = bcsstk14();
+	Cholesky cholesky( (Cholesky::Ordering)state.range(0) );
+	cholesky.analyze(A);
+
+	for(auto _: state)
+	{
+		cholesky.factorize(A);
+	}
+
+	set_counters(state, cholesky);
+}
+BENCHMARK(BM_cholesky_factorize_bcsstk14)->ArgName("ordering")->DenseRange(Cholesky::ORDERING_NATURAL, Cholesky::ORDERING_AMD)->Unit(benchmark::kMillisecond);
+
+
+static void
+BM_cholesky_solve_bcsstk14(benchmark::State &state)
+{
+	auto &A = bcsstk14();
+	Cholesky cholesky( (Cholesky::Ordering)state.range(0) );
+	cholesky.factorize(A);
+
+	mla::vector::Dense<Scalar> x, b(A.rows());
+	std::fill(b.data.begin(), b.data.end(), 1.0);
+
+	for(auto _: state)
+	{
+		cholesky.solve(x, b);
+		benchmark::DoNotOptimize(x.data.data());
+	}
+
+	state.counters["nnz(L)"] = cholesky.nnz();
+}
+BENCHMARK(BM_cholesky_solve_bcsstk14)->ArgName("ordering")->DenseRange(Cholesky::ORDERING_NATURAL, Cholesky::ORDERING_AMD)->Unit(benchmark::kMicrosecond);
+
+
+/**
+ * Analysis and factorization of the laplacian of a 128-by-128 grid
+ */
+static void
+BM_cholesky_laplacian(benchmark::State &state)
+{
+	auto A = laplacian_2d_crs<Scalar>(128);
+	Cholesky cholesky( (Cholesky::Ordering)state.range(0) );
+
+	for(auto _: state)
+	{
+		cholesky.analyze(A);
+		cholesky.factorize(A);
+	}
+
+	set_counters(state, cholesky);
+}
+BENCHMARK(BM_cholesky_laplacian)->ArgName("ordering")->DenseRange(Cholesky::ORDERING_NATURAL, Cholesky::ORDERING_AMD)->Unit(benchmark::kMillisecond);
+
+
+BENCHMARK_MAIN();
@@ -0,0 +1,115 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include <mla/matrix/all.h++>
+#include <mla/vector/all.h++>
+
+#include <mla/solvers/umfpack.h++>
+
+#include "matrices.h++"
+
+
+static mla::matrix::SparseCCS<double> &
+bcsstk14()
+{
+	static mla::matrix::SparseCCS<double> A = load_matrix_market_ccs<double>("coordinate/bcsstk14.mtx");
+	return A;
+}
+
+
+/**
+ * Builds state.range(0) right-hand sides
+ */
+static std::vector<mla::vector::Dense<double> >
+right_hand_sides(benchmark::State &state, size_t size)
+{
+	std::vector<mla::vector::Dense<double> > b(state.range(0), mla::vector::Dense<double>(size));
+	for(size_t k = 0; k < b.size(); k++)
+	{
+		for(size_t i = 0; i < size; i++)
+		{
+			b[k].data[i] = 1.0 + (i+k) % 7;
+		}
+	}
+	return b;
+}
+
+
+/**
+ * One-shot umfpack() call per right-hand side: analysis, factorization and solve each time
+ */
+static void
+BM_umfpack_per_rhs(benchmark::State &state)
+{
+	auto &A = bcsstk14();
+	auto b = right_hand_sides(state, A.rows());
+	mla::vector::Dense<double> x(A.rows());
+
+	for(auto _: state)
+	{
+		for(auto &rhs: b)
+		{
+			mla::umfpack(A, x, rhs, nullptr);
+			benchmark::DoNotOptimize(x.data.data());
+		}
+	}
+
+	state.counters["rhs/s"] = benchmark::Counter(b.size(), benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_umfpack_per_rhs)->RangeMultiplier(4)->Range(1, 64)->Unit(benchmark::kMillisecond);
+
+
+/**
+ * A single factorization shared by every right-hand side
+ */
+static void
+BM_umfpack_factorization(benchmark::State &state)
+{
+	auto &A = bcsstk14();
+	auto b = right_hand_sides(state, A.rows());
+	std::vector<mla::vector::Dense<double> > x;
+
+	mla::UmfpackFactorization lu;
+
+	for(auto _: state)
+	{
+		lu.factorize(A);
+		lu.solve(x, b);
+		benchmark::DoNotOptimize(x.data());
+	}
+
+	state.counters["rhs/s"] = benchmark::Counter(b.size(), benchmark::Counter::kIsIterationInvariantRate);
+	state.counters["numeric_s"] = lu.info(UMFPACK_NUMERIC_WALLTIME);
+	state.counters["nnz(L)"] = lu.info(UMFPACK_LNZ);
+	state.counters["nnz(U)"] = lu.info(UMFPACK_UNZ);
+}
+BENCHMARK(BM_umfpack_factorization)->RangeMultiplier(4)->Range(1, 64)->Unit(benchmark::kMillisecond);
+
+
+/**
+ * Numeric refactorization over the analyzed sparsity pattern, then the solves
+ */
+static void
+BM_umfpack_refactorize(benchmark::State &state)
+{
+	auto &A = bcsstk14();
+	auto b = right_hand_sides(state, A.rows());
+	std::vector<mla::vector::Dense<double> > x;
+
+	mla::UmfpackFactorization lu;
+	lu.analyze(A);
+
+	for(auto _: state)
+	{
+		lu.refactorize(A);
+		lu.solve(x, b);
+		benchmark::DoNotOptimize(x.data());
+	}
+
+	state.counters["rhs/s"] = benchmark::Counter(b.size(), benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_umfpack_refactorize)->RangeMultiplier(4)->Range(1, 64)->Unit(benchmark::kMillisecond);
+
+
+BENCHMARK_MAIN();
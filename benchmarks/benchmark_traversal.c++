@@ -0,0 +1,528 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <mla/matrix/all.h++>
+#include <mla/matrix/for_each_nonzero.h++>
+#include <mla/vector/all.h++>
+#include <mla/vector/for_each_nonzero.h++>
+
+#include <mla/MatrixCursor.h++>
+#include <mla/VectorCursor.h++>
+
+#include <mla/operations/level1/asum.h++>
+#include <mla/operations/level1/axpy.h++>
+#include <mla/operations/level1/dot.h++>
+#include <mla/operations/level1/scale.h++>
+#include <mla/operations/level2/gemv.h++>
+
+#include "matrices.h++"
+
+
+/**
+ * Compares the operations built on the compile-time dispatched for_each_nonzero with
+ * the same operations written against the virtual MatrixCursor and VectorCursor
+ * interfaces, which is how the generic algorithms used to reach the storages.  The
+ * throughput of each operation x storage pair is reported as stored elements per
+ * second.
+ */
+
+
+using Scalar = double;
+
+typedef mla::matrix::SparseCRS<Scalar>	SparseCRS;
+typedef mla::matrix::SparseCCS<Scalar>	SparseCCS;
+typedef mla::matrix::Diagonal<Scalar>	Diagonal;
+typedef mla::matrix::DenseRowMajor<Scalar>	DenseRowMajor;
+typedef mla::matrix::StaticDenseRowMajor<Scalar, 64, 64>	StaticDenseRowMajor64;
+typedef mla::matrix::StaticDenseRowMajor<Scalar, 512, 512>	StaticDenseRowMajor512;
+typedef mla::vector::Dense<Scalar>	Dense;
+typedef mla::vector::SparseCS<Scalar>	SparseCS;
+
+
+static void
+set_counters(benchmark::State &state, size_t nnz)
+{
+	state.counters["nnz"] = nnz;
+	state.counters["nnz/s"] = benchmark::Counter(nnz, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+
+/**
+ * Test matrices: the laplacian of a n-by-n grid for the sparse storages, and n-by-n
+ * diagonal and dense matrices
+ */
+static void
+make_matrix(SparseCRS &A, size_t n)
+{
+	A = laplacian_2d_crs<Scalar>(n);
+}
+
+
+static void
+make_matrix(SparseCCS &A, size_t n)
+{
+	// the laplacian is symmetric, so its CRS arrays are also its CCS arrays
+	SparseCRS crs = laplacian_2d_crs<Scalar>(n);
+	A.data.n_rows = crs.rows();
+	A.data.values = crs.data.values;
+	A.data.row_index = crs.data.column_index;
+	A.data.column_pointer = crs.data.row_pointer;
+}
+
+
+static void
+make_matrix(Diagonal &A, size_t n)
+{
+	A.resize(n, n);
+	for(size_t i = 0; i < n; i++)
+	{
+		A.data.data[i] = (Scalar)(i % 7) + 1;
+	}
+}
+
+
+static void
+make_matrix(DenseRowMajor &A, size_t n)
+{
+	A.resize(n, n);
+	for(size_t k = 0; k < A.data.element_vector.size(); k++)
+	{
+		A.data.element_vector[k] = (Scalar)(k % 7) + 1;
+	}
+}
+
+
+template<size_t rows, size_t columns>
+static void
+make_matrix(mla::matrix::StaticDenseRowMajor<Scalar, rows, columns> &A, size_t)
+{
+	for(size_t k = 0; k < A.data.size(); k++)
+	{
+		A.data[k] = (Scalar)(k % 7) + 1;
+	}
+}
+
+
+template<typename Matrix>
+static size_t
+matrix_nnz(Matrix const &A)
+{
+	size_t nnz = 0;
+	mla::matrix::for_each_nonzero(A, [&nnz](size_t, size_t, Scalar) { nnz++; });
+	return nnz;
+}
+
+
+/**
+ * Test vectors of size n: dense, or with every fourth element stored
+ */
+static void
+make_vector(Dense &x, size_t n)
+{
+	x.resize(n);
+	for(size_t i = 0; i < n; i++)
+	{
+		x[i] = (Scalar)(i % 5) + 1;
+	}
+}
+
+
+static void
+make_vector(SparseCS &x, size_t n)
+{
+	x.resize(n);
+	x.reserve(n/4);
+	for(size_t i = 0; i < n; i += 4)
+	{
+		x.push_back(i, (Scalar)(i % 5) + 1);
+	}
+}
+
+
+template<typename Vector>
+static size_t
+vector_nnz(Vector const &x)
+{
+	size_t nnz = 0;
+	mla::vector::for_each_nonzero(x, [&nnz](size_t, Scalar) { nnz++; });
+	return nnz;
+}
+
+
+/**
+ * Hides the dynamic type of a cursor from the compiler, so that its methods are called
+ * through the virtual table, as they are from a generic algorithm
+ */
+template<typename Cursor>
+static Cursor &
+opaque(Cursor &cursor)
+{
+	Cursor *pointer = &cursor;
+	benchmark::DoNotOptimize(pointer);
+	return *pointer;
+}
+
+
+/**
+ * The former generic gemv, {y} := a[A]{x} + b{y} with b applied once per matched
+ * element, walking A and x through the virtual cursor interfaces
+ */
+template<template<typename> class MatrixPolicy>
+static void
+cursor_gemv(Scalar const a, MatrixPolicy<Scalar> &A, Dense &x, Scalar const b, Dense &y)
+{
+	auto A_concrete = A.cursor();
+	auto x_concrete = x.cursor();
+	auto &A_cursor = opaque<mla::MatrixCursor<Scalar, MatrixPolicy> >(A_concrete);
+	auto &x_cursor = opaque<mla::VectorCursor<Scalar, mla::vector::Dense> >(x_concrete);
+
+	A_cursor.reset();
+
+	while( !A_cursor.at_end_of_rows() )
+	{
+		x_cursor.reset();
+
+		Scalar Yval = y.getValue(A_cursor.current_row());
+
+		while( !A_cursor.at_end_of_rows() )
+		{
+			if(A_cursor.current_column()  == x_cursor.current())
+			{
+				Yval = a*A_cursor.element()*x_cursor.element() + b*Yval;
+
+				x_cursor.next();
+				A_cursor.increment_column();
+
+				if( x_cursor.at_end() ||  A_cursor.at_end_of_current_row() )
+				{
+					y.setValue( A_cursor.current_row(), Yval );
+					A_cursor.start_next_row_nn();
+					break;
+				}
+			}
+			else if(A_cursor.current_column() > x_cursor.current())
+			{
+				x_cursor.next();
+				if( x_cursor.at_end() )
+				{
+					y.setValue( A_cursor.current_row(), Yval );
+					A_cursor.start_next_column_nn();
+					break;
+				}
+			}
+			else
+			{
+				A_cursor.increment_column();
+				if(A_cursor.at_end_of_current_row() )
+				{
+					y.setValue( A_cursor.current_row(), Yval );
+					A_cursor.start_next_row_nn();
+					break;
+				}
+			}
+		}
+	}
+}
+
+
+/**
+ * The former level 1 operations, walking x through the virtual cursor interface
+ */
+template<template<typename> class VectorPolicy>
+static Scalar
+cursor_dot(VectorPolicy<Scalar> &x, Dense &y)
+{
+	auto concrete = x.cursor();
+	auto &cursor = opaque<mla::VectorCursor<Scalar, VectorPolicy> >(concrete);
+	cursor.reset();
+
+	Scalar accumulator = 0;
+	while( !cursor.at_end() )
+	{
+		accumulator += cursor.element()*y.getValue(cursor.current());
+		cursor.next();
+	}
+	return accumulator;
+}
+
+
+template<template<typename> class VectorPolicy>
+static Scalar
+cursor_asum(VectorPolicy<Scalar> &x)
+{
+	auto concrete = x.cursor();
+	auto &cursor = opaque<mla::VectorCursor<Scalar, VectorPolicy> >(concrete);
+	cursor.reset();
+
+	Scalar absolute_sum = 0;
+	while( !cursor.at_end() )
+	{
+		absolute_sum += std::abs(cursor.element());
+		cursor.next();
+	}
+	return absolute_sum;
+}
+
+
+template<template<typename> class VectorPolicy>
+static void
+cursor_axpy(Scalar const a, VectorPolicy<Scalar> &x, Dense &y)
+{
+	auto concrete = x.cursor();
+	auto &cursor = opaque<mla::VectorCursor<Scalar, VectorPolicy> >(concrete);
+	cursor.reset();
+
+	while( !cursor.at_end() )
+	{
+		size_t i = cursor.current();
+		y.setValue(i, y.getValue(i) + cursor.element()*a);
+		cursor.next();
+	}
+}
+
+
+template<template<typename> class VectorPolicy>
+static void
+cursor_scale(Scalar const a, VectorPolicy<Scalar> &x)
+{
+	auto concrete = x.cursor();
+	auto &cursor = opaque<mla::VectorCursor<Scalar, VectorPolicy> >(concrete);
+	cursor.reset();
+
+	while( !cursor.at_end() )
+	{
+		x.setValue(cursor.current(), cursor.element()*a);
+		cursor.next();
+	}
+}
+
+
+/**
+ * gemv through the generic, for_each_nonzero based, implementation.  The matrix type is
+ * given explicitly, which selects the overload for storages given as a type, so that
+ * SparseCRS doesn't go through its own kernel.
+ */
+template<typename Matrix>
+static void
+BM_gemv_for_each_nonzero(benchmark::State &state)
+{
+	Matrix A;
+	make_matrix(A, state.range(0));
+	Dense x(A.columns()), y(A.rows());
+	std::fill(x.data.begin(), x.data.end(), 1.0);
+
+	for(auto _: state)
+	{
+		mla::gemv<Scalar, Matrix, mla::vector::Dense, mla::vector::Dense>( (Scalar)1, A, x, (Scalar)1, y);
+		benchmark::DoNotOptimize(y.data.data());
+	}
+
+	set_counters(state, matrix_nnz(A));
+}
+
+
+/**
+ * The cursor gemv scans every column of every row, so only small sparse matrices are
+ * measured
+ */
+template<typename Matrix>
+static void
+BM_gemv_cursor(benchmark::State &state)
+{
+	Matrix A;
+	make_matrix(A, state.range(0));
+	Dense x(A.columns()), y(A.rows());
+	std::fill(x.data.begin(), x.data.end(), 1.0);
+
+	for(auto _: state)
+	{
+		cursor_gemv( (Scalar)1, A, x, (Scalar)1, y);
+		benchmark::DoNotOptimize(y.data.data());
+	}
+
+	set_counters(state, matrix_nnz(A));
+}
+
+
+BENCHMARK_TEMPLATE(BM_gemv_for_each_nonzero, SparseCRS)->Arg(32)->Arg(512)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_gemv_cursor, SparseCRS)->Arg(32)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_gemv_for_each_nonzero, SparseCCS)->Arg(32)->Arg(512)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_gemv_for_each_nonzero, Diagonal)->Arg(1 << 10)->Arg(1 << 20)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_gemv_cursor, Diagonal)->Arg(1 << 10)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_gemv_for_each_nonzero, DenseRowMajor)->Arg(64)->Arg(1024)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_gemv_cursor, DenseRowMajor)->Arg(64)->Arg(1024)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_gemv_for_each_nonzero, StaticDenseRowMajor64)->Arg(64)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_gemv_for_each_nonzero, StaticDenseRowMajor512)->Arg(512)->Unit(benchmark::kMicrosecond);
+
+
+/**
+ * Level 1 operations on a vector of size state.range(0), with a dense y where needed
+ */
+template<typename Vector>
+static void
+BM_dot_for_each_nonzero(benchmark::State &state)
+{
+	Vector x;
+	Dense y;
+	make_vector(x, state.range(0));
+	make_vector(y, state.range(0));
+
+	for(auto _: state)
+	{
+		benchmark::DoNotOptimize(mla::dot(x, y));
+	}
+
+	set_counters(state, vector_nnz(x));
+}
+
+
+template<typename Vector>
+static void
+BM_dot_cursor(benchmark::State &state)
+{
+	Vector x;
+	Dense y;
+	make_vector(x, state.range(0));
+	make_vector(y, state.range(0));
+
+	for(auto _: state)
+	{
+		benchmark::DoNotOptimize(cursor_dot(x, y));
+	}
+
+	set_counters(state, vector_nnz(x));
+}
+
+
+template<typename Vector>
+static void
+BM_asum_for_each_nonzero(benchmark::State &state)
+{
+	Vector x;
+	make_vector(x, state.range(0));
+
+	for(auto _: state)
+	{
+		benchmark::DoNotOptimize(mla::asum(x));
+	}
+
+	set_counters(state, vector_nnz(x));
+}
+
+
+template<typename Vector>
+static void
+BM_asum_cursor(benchmark::State &state)
+{
+	Vector x;
+	make_vector(x, state.range(0));
+
+	for(auto _: state)
+	{
+		benchmark::DoNotOptimize(cursor_asum(x));
+	}
+
+	set_counters(state, vector_nnz(x));
+}
+
+
+template<typename Vector>
+static void
+BM_axpy_for_each_nonzero(benchmark::State &state)
+{
+	Vector x;
+	Dense y;
+	make_vector(x, state.range(0));
+	make_vector(y, state.range(0));
+
+	for(auto _: state)
+	{
+		mla::axpy( (Scalar)-1, x, y);
+		benchmark::DoNotOptimize(y.data.data());
+	}
+
+	set_counters(state, vector_nnz(x));
+}
+
+
+template<typename Vector>
+static void
+BM_axpy_cursor(benchmark::State &state)
+{
+	Vector x;
+	Dense y;
+	make_vector(x, state.range(0));
+	make_vector(y, state.range(0));
+
+	for(auto _: state)
+	{
+		cursor_axpy( (Scalar)-1, x, y);
+		benchmark::DoNotOptimize(y.data.data());
+	}
+
+	set_counters(state, vector_nnz(x));
+}
+
+
+template<typename Vector>
+static void
+BM_scale_for_each_nonzero(benchmark::State &state)
+{
+	Vector x;
+	make_vector(x, state.range(0));
+
+	for(auto _: state)
+	{
+		mla::scale( (Scalar)-1, x);
+		benchmark::DoNotOptimize(x.data);
+	}
+
+	set_counters(state, vector_nnz(x));
+}
+
+
+/**
+ * setValue searches the stored indices of a SparseCS, so the cursor scale is
+ * quadratic on sparse vectors
+ */
+template<typename Vector>
+static void
+BM_scale_cursor(benchmark::State &state)
+{
+	Vector x;
+	make_vector(x, state.range(0));
+
+	for(auto _: state)
+	{
+		cursor_scale( (Scalar)-1, x);
+		benchmark::DoNotOptimize(x.data);
+	}
+
+	set_counters(state, vector_nnz(x));
+}
+
+
+BENCHMARK_TEMPLATE(BM_dot_for_each_nonzero, Dense)->Arg(1 << 12)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_dot_cursor, Dense)->Arg(1 << 12)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_dot_for_each_nonzero, SparseCS)->Arg(1 << 12)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_dot_cursor, SparseCS)->Arg(1 << 12)->Arg(1 << 20);
+
+BENCHMARK_TEMPLATE(BM_asum_for_each_nonzero, Dense)->Arg(1 << 12)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_asum_cursor, Dense)->Arg(1 << 12)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_asum_for_each_nonzero, SparseCS)->Arg(1 << 12)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_asum_cursor, SparseCS)->Arg(1 << 12)->Arg(1 << 20);
+
+BENCHMARK_TEMPLATE(BM_axpy_for_each_nonzero, Dense)->Arg(1 << 12)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_axpy_cursor, Dense)->Arg(1 << 12)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_axpy_for_each_nonzero, SparseCS)->Arg(1 << 12)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_axpy_cursor, SparseCS)->Arg(1 << 12)->Arg(1 << 20);
+
+BENCHMARK_TEMPLATE(BM_scale_for_each_nonzero, Dense)->Arg(1 << 12)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_scale_cursor, Dense)->Arg(1 << 12)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_scale_for_each_nonzero, SparseCS)->Arg(1 << 12)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_scale_cursor, SparseCS)->Arg(1 << 12);
+
+
+BENCHMARK_MAIN();
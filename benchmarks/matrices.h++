@@ -0,0 +1,121 @@
+#ifndef MLA_BENCHMARKS_MATRICES_HPP
+#define MLA_BENCHMARKS_MATRICES_HPP
+
+#include <fstream>
+#include <string>
+
+#include <mla/LAException.h++>
+#include <mla/matrix/all.h++>
+#include <mla/matrix/convert.h++>
+#include <mla/parsers/MatrixMarket.h++>
+#include <mla/parsers/MatrixMarketLoader.h++>
+
+#include "config_paths.h"
+
+
+/**
+ * Helper routines that build the matrices used by the benchmarks
+ */
+
+
+/**
+ * Loads a matrix from the MatrixMarket files bundled with the unit tests
+ *@param file_name	path relative to unit_tests/MatrixMarket
+ */
+template<typename Scalar, template<typename> class MatrixStoragePolicy>
+MatrixStoragePolicy<Scalar>
+load_matrix_market(std::string const &file_name)
+{
+	std::string file_path = FULL_MATRIX_MARKET_FILES_PATH + file_name;
+	std::ifstream file(file_path, std::ifstream::in);
+	if( !file.is_open() )
+	{
+		throw LAException("unable to open " + file_path);
+	}
+
+	mla::MatrixMarket parser;
+	mla::matrix::SparseDOK<Scalar> dok;
+	parser.parse(file, dok);
+
+	MatrixStoragePolicy<Scalar> A;
+	mla::matrix::convert(dok, A);
+
+	return A;
+}
+
+
+template<typename Scalar>
+mla::matrix::SparseCRS<Scalar>
+load_matrix_market_crs(std::string const &file_name)
+{
+	mla::matrix::SparseCRS<Scalar> A;
+	mla::MatrixMarketLoader(FULL_MATRIX_MARKET_FILES_PATH + file_name).load(A);
+	return A;
+}
+
+
+template<typename Scalar>
+mla::matrix::SparseCCS<Scalar>
+load_matrix_market_ccs(std::string const &file_name)
+{
+	mla::matrix::SparseCCS<Scalar> A;
+	mla::MatrixMarketLoader(FULL_MATRIX_MARKET_FILES_PATH + file_name).load(A);
+	return A;
+}
+
+
+/**
+ * Builds the 5-point finite difference laplacian of a n-by-n grid
+ */
+template<typename Scalar>
+mla::matrix::SparseCRS<Scalar>
+laplacian_2d_crs(size_t n)
+{
+	size_t const size = n*n;
+
+	mla::matrix::SparseCRS<Scalar> A(size, size);
+	auto &data = A.data;
+	data.values.clear();
+	data.column_index.clear();
+	data.values.reserve(5*size);
+	data.column_index.reserve(5*size);
+
+	for(size_t i = 0; i < size; i++)
+	{
+		size_t const x = i % n;
+		size_t const y = i / n;
+
+		data.row_pointer[i] = data.values.size();
+
+		if(y > 0)
+		{
+			data.column_index.push_back(i-n);
+			data.values.push_back(-1);
+		}
+		if(x > 0)
+		{
+			data.column_index.push_back(i-1);
+			data.values.push_back(-1);
+		}
+
+		data.column_index.push_back(i);
+		data.values.push_back(4);
+
+		if(x+1 < n)
+		{
+			data.column_index.push_back(i+1);
+			data.values.push_back(-1);
+		}
+		if(y+1 < n)
+		{
+			data.column_index.push_back(i+n);
+			data.values.push_back(-1);
+		}
+	}
+	data.row_pointer[size] = data.values.size();
+
+	return A;
+}
+
+
+#endif
@@ -0,0 +1,214 @@
+#ifndef MLA_MAPPED_FILE_HPP
+#define MLA_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MLA_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <mla/LAException.h++>
+
+
+namespace mla
+{
+
+/**
+ * Read-only view of the contents of a file, which is memory-mapped where the platform
+ * supports it and read into memory otherwise.  The view stays valid until the object
+ * is destroyed.
+ */
+class MappedFile
+{
+protected:
+	char const	*m_data;
+	size_t	m_size;
+
+#ifdef MLA_HAVE_MMAP
+	void	*m_mapping;
+#else
+	std::vector<char>	m_buffer;
+#endif
+
+public:
+	MappedFile();
+
+	/**
+	 * Maps the whole file, sequential access expected
+	 */
+	explicit MappedFile(std::string const &file_name);
+	~MappedFile();
+
+	MappedFile(MappedFile const &) = delete;
+	MappedFile & operator=(MappedFile const &) = delete;
+
+	MappedFile(MappedFile &&other);
+	MappedFile & operator=(MappedFile &&other);
+
+	char const * data() const	{ return m_data; }
+	size_t size() const	{ return m_size; }
+
+	bool isOpen() const	{ return m_data != nullptr; }
+
+	/**
+	 * Unmaps the file
+	 */
+	void close();
+
+protected:
+	void swap(MappedFile &other);
+};
+
+
+
+inline
+MappedFile::MappedFile()
+	: m_data(nullptr), m_size(0)
+#ifdef MLA_HAVE_MMAP
+	, m_mapping(nullptr)
+#endif
+{
+}
+
+
+#ifdef MLA_HAVE_MMAP
+
+inline
+MappedFile::MappedFile(std::string const &file_name)
+	: MappedFile()
+{
+	int const fd = ::open(file_name.c_str(), O_RDONLY);
+	if(fd < 0)
+	{
+		throw LAException("MappedFile: unable to open " + file_name);
+	}
+
+	struct stat status;
+	if(::fstat(fd, &status) != 0)
+	{
+		::close(fd);
+		throw LAException("MappedFile: unable to stat " + file_name);
+	}
+
+	m_size = status.st_size;
+	if(m_size == 0)
+	{
+		// empty files can't be mapped
+		::close(fd);
+		m_data = "";
+		return;
+	}
+
+	void *mapping = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if(mapping == MAP_FAILED)
+	{
+		m_size = 0;
+		throw LAException("MappedFile: unable to map " + file_name);
+	}
+
+	::madvise(mapping, m_size, MADV_SEQUENTIAL);
+
+	m_mapping = mapping;
+	m_data = static_cast<char const *>(mapping);
+}
+
+
+inline void
+MappedFile::close()
+{
+	if(m_mapping != nullptr)
+	{
+		::munmap(m_mapping, m_size);
+	}
+
+	m_mapping = nullptr;
+	m_data = nullptr;
+	m_size = 0;
+}
+
+
+inline void
+MappedFile::swap(MappedFile &other)
+{
+	std::swap(m_data, other.m_data);
+	std::swap(m_size, other.m_size);
+	std::swap(m_mapping, other.m_mapping);
+}
+
+#else	// MLA_HAVE_MMAP
+
+inline
+MappedFile::MappedFile(std::string const &file_name)
+	: MappedFile()
+{
+	std::ifstream file(file_name, std::ifstream::in | std::ifstream::binary);
+	if( !file.is_open() )
+	{
+		throw LAException("MappedFile: unable to open " + file_name);
+	}
+
+	file.seekg(0, std::ifstream::end);
+	m_buffer.resize( static_cast<size_t>(file.tellg()) );
+	file.seekg(0, std::ifstream::beg);
+	file.read(m_buffer.data(), m_buffer.size());
+
+	m_size = m_buffer.size();
+	m_data = m_size > 0 ? m_buffer.data() : "";
+}
+
+
+inline void
+MappedFile::close()
+{
+	std::vector<char>().swap(m_buffer);
+	m_data = nullptr;
+	m_size = 0;
+}
+
+
+inline void
+MappedFile::swap(MappedFile &other)
+{
+	std::swap(m_data, other.m_data);
+	std::swap(m_size, other.m_size);
+	m_buffer.swap(other.m_buffer);
+}
+
+#endif	// MLA_HAVE_MMAP
+
+
+inline
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+
+inline
+MappedFile::MappedFile(MappedFile &&other)
+	: MappedFile()
+{
+	swap(other);
+}
+
+
+inline MappedFile &
+MappedFile::operator=(MappedFile &&other)
+{
+	close();
+	swap(other);
+	return *this;
+}
+
+
+}	// namespace mla
+
+#endif
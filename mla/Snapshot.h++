@@ -0,0 +1,578 @@
+#ifndef MLA_SNAPSHOT_HPP
+#define MLA_SNAPSHOT_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <mla/LAException.h++>
+#include <mla/MappedFile.h++>
+
+#include <mla/matrix/SparseCRS.h++>
+#include <mla/matrix/SparseCCS.h++>
+#include <mla/matrix/DenseRowMajor.h++>
+#include <mla/vector/Dense.h++>
+
+
+namespace mla
+{
+
+/**
+ * Binary snapshots of matrices and vectors, meant to be loaded far faster than text
+ * files.
+ *
+ * A snapshot is a 128 byte header followed by the arrays of the Data struct of the
+ * stored object, in the byte order of the host that wrote it.  The header records the
+ * kind of object, its dimensions, its number of non-zero elements, the scalar type and
+ * the width of the row/column indices, and the offset of each array.  Arrays start at
+ * 64 byte boundaries, so a memory-mapped snapshot can be used in place by the read-only
+ * views SparseCRSView, SparseCCSView, DenseRowMajorView and vector::DenseView.
+ *
+ * Layout of each kind of snapshot, by array:
+ *	SparseCRS	row_pointer, column_index, values
+ *	SparseCCS	column_pointer, row_index, values
+ *	DenseRowMajor	element_vector
+ *	vector::Dense	data
+ */
+
+enum SnapshotKind
+{
+	SNAPSHOT_SPARSE_CRS	= 1,
+	SNAPSHOT_SPARSE_CCS	= 2,
+	SNAPSHOT_DENSE_ROW_MAJOR	= 3,
+	SNAPSHOT_VECTOR_DENSE	= 4
+};
+
+enum SnapshotScalarType
+{
+	SNAPSHOT_FLOAT32	= 1,
+	SNAPSHOT_FLOAT64	= 2
+};
+
+/**
+ * Width in bytes of the stored indices.  32 bit indices halve the size of sparse
+ * snapshots, but can only be mapped by views with 32 bit indices.
+ */
+enum SnapshotIndexWidth
+{
+	SNAPSHOT_INDEX_32	= 4,
+	SNAPSHOT_INDEX_64	= 8
+};
+
+
+namespace detail
+{
+
+template<typename Scalar>
+struct SnapshotScalar;
+
+template<>
+struct SnapshotScalar<float>
+{
+	static const uint32_t type = SNAPSHOT_FLOAT32;
+};
+
+template<>
+struct SnapshotScalar<double>
+{
+	static const uint32_t type = SNAPSHOT_FLOAT64;
+};
+
+
+struct SnapshotHeader
+{
+	char	magic[8];	// "MLASNAP"
+	uint32_t	version;
+	uint32_t	byte_order;	// snapshot_byte_order, as written by the host
+	uint32_t	kind;
+	uint32_t	scalar_type;
+	uint32_t	index_width;	// 0 for dense objects
+	uint32_t	n_arrays;
+	uint64_t	rows;
+	uint64_t	columns;
+	uint64_t	nnz;
+	uint64_t	offset[3];	// of each array, from the start of the file
+	uint64_t	size[3];	// of each array, in bytes
+	uint8_t	reserved[24];
+};
+
+static_assert(sizeof(SnapshotHeader) == 128, "SnapshotHeader must take 128 bytes");
+
+static const uint32_t snapshot_version = 1;
+static const uint32_t snapshot_byte_order = 0x01020304;
+static const uint64_t snapshot_alignment = 64;
+
+
+/**
+ * An array to be written to a snapshot, optionally narrowing size_t indices to 32 bits
+ */
+struct SnapshotArray
+{
+	void const	*data;
+	size_t	count;	// number of elements
+	size_t	element_size;	// in memory
+	bool	narrow;	// store size_t elements as uint32_t
+
+	size_t stored_size() const	{ return count*(narrow ? sizeof(uint32_t) : element_size); }
+};
+
+
+template<typename T>
+SnapshotArray
+snapshot_array(std::vector<T> const &v)
+{
+	SnapshotArray array = { v.data(), v.size(), sizeof(T), false };
+	return array;
+}
+
+
+inline SnapshotArray
+snapshot_index_array(std::vector<size_t> const &v, SnapshotIndexWidth width)
+{
+	SnapshotArray array = { v.data(), v.size(), sizeof(size_t), width == SNAPSHOT_INDEX_32 };
+	return array;
+}
+
+
+inline void
+write_snapshot(std::string const &file_name, SnapshotHeader header, std::vector<SnapshotArray> const &arrays)
+{
+	std::memcpy(header.magic, "MLASNAP", 8);
+	header.version = snapshot_version;
+	header.byte_order = snapshot_byte_order;
+	header.n_arrays = arrays.size();
+	std::memset(header.reserved, 0, sizeof(header.reserved));
+
+	uint64_t position = sizeof(SnapshotHeader);
+	for(size_t a = 0; a < 3; a++)
+	{
+		header.offset[a] = 0;
+		header.size[a] = 0;
+		if(a < arrays.size())
+		{
+			position = (position + snapshot_alignment-1)/snapshot_alignment*snapshot_alignment;
+			header.offset[a] = position;
+			header.size[a] = arrays[a].stored_size();
+			position += header.size[a];
+		}
+	}
+
+	std::ofstream file(file_name, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+	if( !file.is_open() )
+	{
+		throw LAException("write_snapshot: unable to open " + file_name);
+	}
+
+	file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+
+	char const padding[snapshot_alignment] = {};
+	std::vector<uint32_t> narrowed;
+	for(size_t a = 0; a < arrays.size(); a++)
+	{
+		file.write(padding, header.offset[a] - file.tellp());
+
+		SnapshotArray const &array = arrays[a];
+		if( !array.narrow )
+		{
+			file.write(static_cast<char const *>(array.data), header.size[a]);
+			continue;
+		}
+
+		// narrow the indices in blocks
+		size_t const *indices = static_cast<size_t const *>(array.data);
+		size_t const block = 1 << 16;
+		for(size_t k = 0; k < array.count; k += block)
+		{
+			size_t const n = std::min(block, array.count - k);
+			narrowed.assign(indices + k, indices + k + n);
+			file.write(reinterpret_cast<char const *>(narrowed.data()), n*sizeof(uint32_t));
+		}
+	}
+
+	if( !file )
+	{
+		throw LAException("write_snapshot: unable to write " + file_name);
+	}
+}
+
+
+inline void
+check_index_width(SnapshotIndexWidth width, size_t largest_index)
+{
+	if(width != SNAPSHOT_INDEX_32 && width != SNAPSHOT_INDEX_64)
+	{
+		throw LAException("save_snapshot: invalid index width");
+	}
+	if(width == SNAPSHOT_INDEX_32 && largest_index > std::numeric_limits<uint32_t>::max())
+	{
+		throw LAException("save_snapshot: the indices don't fit in 32 bits");
+	}
+}
+
+}	// namespace detail
+
+
+
+/**
+ * A memory-mapped snapshot, with its header checked against the expected contents
+ */
+class SnapshotFile
+{
+protected:
+	MappedFile	m_file;
+	detail::SnapshotHeader const	*m_header;
+
+public:
+	SnapshotFile()
+		: m_header(nullptr)
+	{}
+
+	/**
+	 * Maps the snapshot and checks that it holds an object of the given kind and scalar type
+	 */
+	SnapshotFile(std::string const &file_name, SnapshotKind kind, uint32_t scalar_type);
+
+	detail::SnapshotHeader const & header() const	{ return *m_header; }
+
+	/**
+	 * Returns the index width of the stored sparse object
+	 */
+	SnapshotIndexWidth indexWidth() const	{ return static_cast<SnapshotIndexWidth>(m_header->index_width); }
+
+	/**
+	 * Returns a pointer to the elements of array a, which must be of type T
+	 */
+	template<typename T>
+	T const * array(size_t a) const
+	{
+		return reinterpret_cast<T const *>(m_file.data() + m_header->offset[a]);
+	}
+
+	/**
+	 * Returns the number of elements of array a, as stored
+	 */
+	size_t count(size_t a) const;
+
+	/**
+	 * Copies array a to v, widening 32 bit indices
+	 */
+	void copyIndices(size_t a, std::vector<size_t> &v) const;
+};
+
+
+inline
+SnapshotFile::SnapshotFile(std::string const &file_name, SnapshotKind kind, uint32_t scalar_type)
+	: m_file(file_name)
+{
+	if(m_file.size() < sizeof(detail::SnapshotHeader))
+	{
+		throw LAException("SnapshotFile: " + file_name + " is too small to be a snapshot");
+	}
+
+	m_header = reinterpret_cast<detail::SnapshotHeader const *>(m_file.data());
+
+	if(std::memcmp(m_header->magic, "MLASNAP", 8) != 0)
+	{
+		throw LAException("SnapshotFile: " + file_name + " isn't a snapshot");
+	}
+	if(m_header->byte_order != detail::snapshot_byte_order)
+	{
+		throw LAException("SnapshotFile: " + file_name + " was written with a different byte order");
+	}
+	if(m_header->version != detail::snapshot_version)
+	{
+		throw LAException("SnapshotFile: unsupported snapshot version " + std::to_string(m_header->version));
+	}
+	if(m_header->kind != static_cast<uint32_t>(kind))
+	{
+		throw LAException("SnapshotFile: " + file_name + " holds a different kind of object");
+	}
+	if(m_header->scalar_type != scalar_type)
+	{
+		throw LAException("SnapshotFile: " + file_name + " holds a different scalar type");
+	}
+
+	bool const sparse = (kind == SNAPSHOT_SPARSE_CRS || kind == SNAPSHOT_SPARSE_CCS);
+	if(sparse ? (m_header->index_width != SNAPSHOT_INDEX_32 && m_header->index_width != SNAPSHOT_INDEX_64) : m_header->index_width != 0)
+	{
+		throw LAException("SnapshotFile: invalid index width");
+	}
+	if(m_header->n_arrays != (sparse ? 3u : 1u))
+	{
+		throw LAException("SnapshotFile: invalid number of arrays");
+	}
+
+	// every array must be aligned and inside the file, with the size given by the header
+	size_t const scalar_size = (scalar_type == SNAPSHOT_FLOAT32) ? 4 : 8;
+	size_t const index_width = m_header->index_width;
+	size_t const n_major = (kind == SNAPSHOT_SPARSE_CCS) ? m_header->columns : m_header->rows;
+
+	// the header isn't trusted, so the sizes are checked for overflow before they are computed
+	if(m_header->nnz > SIZE_MAX/std::max(scalar_size, index_width))
+	{
+		throw LAException("SnapshotFile: the dimensions are too large");
+	}
+	if(kind == SNAPSHOT_DENSE_ROW_MAJOR && m_header->columns != 0 && m_header->rows > SIZE_MAX/m_header->columns)
+	{
+		throw LAException("SnapshotFile: the dimensions are too large");
+	}
+
+	std::vector<uint64_t> expected_size;
+	if(sparse)
+	{
+		// which also makes sure the pointer array holds at least one element
+		if(n_major >= SIZE_MAX/index_width - 1)
+		{
+			throw LAException("SnapshotFile: the dimensions are too large");
+		}
+		expected_size = { (n_major+1)*index_width, m_header->nnz*index_width, m_header->nnz*scalar_size };
+	}
+	else
+	{
+		expected_size = { m_header->nnz*scalar_size };
+	}
+
+	for(size_t a = 0; a < m_header->n_arrays; a++)
+	{
+		if(m_header->size[a] != expected_size[a])
+		{
+			throw LAException("SnapshotFile: the array sizes don't match the dimensions");
+		}
+		if(m_header->offset[a] % detail::snapshot_alignment != 0 || m_header->offset[a] < sizeof(detail::SnapshotHeader) || m_header->offset[a] > m_file.size() || m_header->size[a] > m_file.size() - m_header->offset[a])
+		{
+			throw LAException("SnapshotFile: " + file_name + " is truncated or corrupted");
+		}
+	}
+}
+
+
+inline size_t
+SnapshotFile::count(size_t a) const
+{
+	size_t const element_size = (a < 2 && m_header->index_width != 0) ? m_header->index_width : (m_header->scalar_type == SNAPSHOT_FLOAT32 ? 4 : 8);
+	return m_header->size[a]/element_size;
+}
+
+
+inline void
+SnapshotFile::copyIndices(size_t a, std::vector<size_t> &v) const
+{
+	size_t const n = count(a);
+	if(m_header->index_width == SNAPSHOT_INDEX_32)
+	{
+		uint32_t const *indices = array<uint32_t>(a);
+		v.assign(indices, indices + n);
+	}
+	else
+	{
+		uint64_t const *indices = array<uint64_t>(a);
+		v.assign(indices, indices + n);
+	}
+}
+
+
+namespace detail
+{
+
+/**
+ * Checks that the compressed arrays describe a valid sparse matrix, with n_major+1
+ * non-decreasing pointers from 0 to nnz and nnz indices below n_minor
+ *@param caller	the function named in the error messages
+ */
+template<typename Index>
+void
+check_compressed(char const *caller, Index const *pointer, size_t n_major, Index const *index, size_t nnz, size_t n_minor)
+{
+	if(pointer[0] != 0 || pointer[n_major] != nnz)
+	{
+		throw LAException(std::string(caller) + ": corrupted pointer array");
+	}
+	for(size_t m = 0; m < n_major; m++)
+	{
+		if(pointer[m] > pointer[m+1])
+			throw LAException(std::string(caller) + ": corrupted pointer array");
+	}
+	for(size_t k = 0; k < nnz; k++)
+	{
+		if(index[k] >= n_minor)
+			throw LAException(std::string(caller) + ": corrupted index array");
+	}
+}
+
+
+inline void
+check_compressed(std::vector<size_t> const &pointer, std::vector<size_t> const &index, size_t n_minor)
+{
+	check_compressed("load_snapshot", pointer.data(), pointer.size()-1, index.data(), index.size(), n_minor);
+}
+
+}	// namespace detail
+
+
+
+/**
+ * Saves A to a snapshot file
+ */
+template<typename Scalar>
+void
+save_snapshot(matrix::SparseCRS<Scalar> const &A, std::string const &file_name, SnapshotIndexWidth index_width = SNAPSHOT_INDEX_64)
+{
+	size_t const nnz = A.data.row_pointer.back();
+	detail::check_index_width(index_width, std::max(nnz, A.columns()));
+
+	detail::SnapshotHeader header;
+	header.kind = SNAPSHOT_SPARSE_CRS;
+	header.scalar_type = detail::SnapshotScalar<Scalar>::type;
+	header.index_width = index_width;
+	header.rows = A.rows();
+	header.columns = A.columns();
+	header.nnz = nnz;
+
+	// only the elements up to the last row pointer belong to the matrix
+	detail::SnapshotArray column_index = detail::snapshot_index_array(A.data.column_index, index_width);
+	detail::SnapshotArray values = detail::snapshot_array(A.data.values);
+	column_index.count = nnz;
+	values.count = nnz;
+
+	detail::write_snapshot(file_name, header, { detail::snapshot_index_array(A.data.row_pointer, index_width), column_index, values });
+}
+
+
+template<typename Scalar>
+void
+save_snapshot(matrix::SparseCCS<Scalar> const &A, std::string const &file_name, SnapshotIndexWidth index_width = SNAPSHOT_INDEX_64)
+{
+	size_t const nnz = A.data.column_pointer.back();
+	detail::check_index_width(index_width, std::max(nnz, A.rows()));
+
+	detail::SnapshotHeader header;
+	header.kind = SNAPSHOT_SPARSE_CCS;
+	header.scalar_type = detail::SnapshotScalar<Scalar>::type;
+	header.index_width = index_width;
+	header.rows = A.rows();
+	header.columns = A.columns();
+	header.nnz = nnz;
+
+	// only the elements up to the last column pointer belong to the matrix
+	detail::SnapshotArray row_index = detail::snapshot_index_array(A.data.row_index, index_width);
+	detail::SnapshotArray values = detail::snapshot_array(A.data.values);
+	row_index.count = nnz;
+	values.count = nnz;
+
+	detail::write_snapshot(file_name, header, { detail::snapshot_index_array(A.data.column_pointer, index_width), row_index, values });
+}
+
+
+template<typename Scalar>
+void
+save_snapshot(matrix::DenseRowMajor<Scalar> const &A, std::string const &file_name)
+{
+	detail::SnapshotHeader header;
+	header.kind = SNAPSHOT_DENSE_ROW_MAJOR;
+	header.scalar_type = detail::SnapshotScalar<Scalar>::type;
+	header.index_width = 0;
+	header.rows = A.rows();
+	header.columns = A.columns();
+	header.nnz = A.data.element_vector.size();
+
+	detail::write_snapshot(file_name, header, { detail::snapshot_array(A.data.element_vector) });
+}
+
+
+template<typename Scalar>
+void
+save_snapshot(vector::Dense<Scalar> const &v, std::string const &file_name)
+{
+	detail::SnapshotHeader header;
+	header.kind = SNAPSHOT_VECTOR_DENSE;
+	header.scalar_type = detail::SnapshotScalar<Scalar>::type;
+	header.index_width = 0;
+	header.rows = v.size();
+	header.columns = 1;
+	header.nnz = v.data.size();
+
+	detail::write_snapshot(file_name, header, { detail::snapshot_array(v.data) });
+}
+
+
+/**
+ * Loads a snapshot into A, copying its contents
+ */
+template<typename Scalar>
+void
+load_snapshot(std::string const &file_name, matrix::SparseCRS<Scalar> &A)
+{
+	SnapshotFile file(file_name, SNAPSHOT_SPARSE_CRS, detail::SnapshotScalar<Scalar>::type);
+	auto const &header = file.header();
+
+	matrix::SparseCRS<Scalar> B;
+	B.data.n_columns = header.columns;
+	file.copyIndices(0, B.data.row_pointer);
+	file.copyIndices(1, B.data.column_index);
+	B.data.values.assign(file.array<Scalar>(2), file.array<Scalar>(2) + header.nnz);
+	detail::check_compressed(B.data.row_pointer, B.data.column_index, header.columns);
+
+	std::swap(A.data, B.data);
+}
+
+
+template<typename Scalar>
+void
+load_snapshot(std::string const &file_name, matrix::SparseCCS<Scalar> &A)
+{
+	SnapshotFile file(file_name, SNAPSHOT_SPARSE_CCS, detail::SnapshotScalar<Scalar>::type);
+	auto const &header = file.header();
+
+	matrix::SparseCCS<Scalar> B;
+	B.data.n_rows = header.rows;
+	file.copyIndices(0, B.data.column_pointer);
+	file.copyIndices(1, B.data.row_index);
+	B.data.values.assign(file.array<Scalar>(2), file.array<Scalar>(2) + header.nnz);
+	detail::check_compressed(B.data.column_pointer, B.data.row_index, header.rows);
+
+	std::swap(A.data, B.data);
+}
+
+
+template<typename Scalar>
+void
+load_snapshot(std::string const &file_name, matrix::DenseRowMajor<Scalar> &A)
+{
+	SnapshotFile file(file_name, SNAPSHOT_DENSE_ROW_MAJOR, detail::SnapshotScalar<Scalar>::type);
+	auto const &header = file.header();
+
+	if(header.nnz != header.rows*header.columns)
+	{
+		throw LAException("load_snapshot: the number of elements doesn't match the dimensions");
+	}
+
+	A.data.n_rows = header.rows;
+	A.data.n_columns = header.columns;
+	A.data.element_vector.assign(file.array<Scalar>(0), file.array<Scalar>(0) + header.nnz);
+}
+
+
+template<typename Scalar>
+void
+load_snapshot(std::string const &file_name, vector::Dense<Scalar> &v)
+{
+	SnapshotFile file(file_name, SNAPSHOT_VECTOR_DENSE, detail::SnapshotScalar<Scalar>::type);
+	auto const &header = file.header();
+
+	if(header.nnz != header.rows)
+	{
+		throw LAException("load_snapshot: the number of elements doesn't match the dimensions");
+	}
+
+	v.t_size = header.rows;
+	v.data.assign(file.array<Scalar>(0), file.array<Scalar>(0) + header.nnz);
+}
+
+
+}	// namespace mla
+
+#endif
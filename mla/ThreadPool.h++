@@ -0,0 +1,235 @@
+#ifndef MLA_THREAD_POOL_HPP
+#define MLA_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace mla
+{
+
+/**
+ * A fixed-size pool of worker threads used to run data-parallel kernels.
+ * Work is handed out as a set of task indices [0, n_tasks), which the workers
+ * and the calling thread consume until the whole set is processed.
+ */
+class ThreadPool
+{
+protected:
+	std::vector<std::thread>	m_workers;
+
+	std::mutex	m_run_mutex;	// serializes calls to run()
+	std::mutex	m_mutex;
+	std::condition_variable	m_work_ready;
+	std::condition_variable	m_work_done;
+
+	std::function<void (size_t)> const *m_task;
+	size_t	m_n_tasks;
+	std::atomic<size_t>	m_next_task;
+	size_t	m_generation;
+	size_t	m_busy_workers;
+	bool	m_stop;
+	std::exception_ptr	m_exception;	// first exception thrown by a task of the current run
+
+public:
+	/**
+	 * @param n_threads	total number of threads, including the calling thread
+	 */
+	explicit ThreadPool(size_t n_threads = std::thread::hardware_concurrency());
+	~ThreadPool();
+
+	ThreadPool(ThreadPool const &) = delete;
+	ThreadPool & operator=(ThreadPool const &) = delete;
+
+	/**
+	 * Returns the number of threads that run tasks, including the calling thread
+	 */
+	size_t size() const	{ return m_workers.size() + 1; }
+
+	/**
+	 * Runs task(0) ... task(n_tasks-1) and blocks until every task has finished.
+	 * Calls issued from within a task are run serially by the calling thread.
+	 * If tasks throw, the remaining tasks are skipped and the first exception is
+	 * rethrown once every thread has stopped running tasks.
+	 */
+	void run(size_t n_tasks, std::function<void (size_t)> const &task);
+
+	/**
+	 * Returns the pool shared by all mla kernels
+	 */
+	static ThreadPool & global();
+
+protected:
+	void worker_loop();
+	void consume_tasks();
+
+	static bool & in_worker();
+
+	/**
+	 * Marks the current thread as running tasks for as long as it lives
+	 */
+	class WorkerScope
+	{
+	protected:
+		bool	m_previous;
+
+	public:
+		WorkerScope() : m_previous(in_worker())	{ in_worker() = true; }
+		~WorkerScope()	{ in_worker() = m_previous; }
+	};
+};
+
+
+
+inline
+ThreadPool::ThreadPool(size_t n_threads)
+	: m_task(nullptr), m_n_tasks(0), m_next_task(0), m_generation(0), m_busy_workers(0), m_stop(false)
+{
+	for(size_t t = 1; t < n_threads; t++)
+	{
+		m_workers.emplace_back( &ThreadPool::worker_loop, this );
+	}
+}
+
+
+inline
+ThreadPool::~ThreadPool()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_work_ready.notify_all();
+
+	for(auto &worker: m_workers)
+	{
+		worker.join();
+	}
+}
+
+
+inline void
+ThreadPool::run(size_t n_tasks, std::function<void (size_t)> const &task)
+{
+	if(n_tasks == 0)
+		return;
+
+	// run serially if there is nobody to share the work with
+	if(n_tasks == 1 || m_workers.empty() || in_worker() )
+	{
+		for(size_t t = 0; t < n_tasks; t++)
+		{
+			task(t);
+		}
+		return;
+	}
+
+	std::unique_lock<std::mutex> run_lock(m_run_mutex);
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_task = &task;
+		m_n_tasks = n_tasks;
+		m_next_task = 0;
+		m_busy_workers = m_workers.size();
+		m_generation++;
+	}
+	m_work_ready.notify_all();
+
+	{
+		WorkerScope scope;
+		consume_tasks();
+	}
+
+	std::exception_ptr exception;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_work_done.wait(lock, [this]{ return m_busy_workers == 0; });
+		m_task = nullptr;
+		exception = m_exception;
+		m_exception = nullptr;
+	}
+
+	if(exception)
+	{
+		std::rethrow_exception(exception);
+	}
+}
+
+
+inline ThreadPool &
+ThreadPool::global()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+
+inline void
+ThreadPool::worker_loop()
+{
+	in_worker() = true;
+
+	size_t seen_generation = 0;
+	for(;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_work_ready.wait(lock, [&]{ return m_stop || m_generation != seen_generation; });
+			if(m_stop)
+				return;
+			seen_generation = m_generation;
+		}
+
+		consume_tasks();
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_busy_workers--;
+		}
+		m_work_done.notify_one();
+	}
+}
+
+
+inline void
+ThreadPool::consume_tasks()
+{
+	for(size_t t = m_next_task++; t < m_n_tasks; t = m_next_task++)
+	{
+		try
+		{
+			(*m_task)(t);
+		}
+		catch(...)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if(!m_exception)
+			{
+				m_exception = std::current_exception();
+			}
+
+			// skip the tasks that weren't handed out yet
+			m_next_task = m_n_tasks;
+		}
+	}
+}
+
+
+inline bool &
+ThreadPool::in_worker()
+{
+	static thread_local bool flag = false;
+	return flag;
+}
+
+
+}	// namespace mla
+
+#endif
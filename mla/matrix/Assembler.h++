@@ -0,0 +1,367 @@
+#ifndef MLA_MATRIX_ASSEMBLER_HPP
+#define MLA_MATRIX_ASSEMBLER_HPP
+
+#include <vector>
+#include <algorithm>
+
+#include <mla/LAException.h++>
+#include <mla/matrix/SparseCRS.h++>
+#include <mla/matrix/SparseCCS.h++>
+
+
+namespace mla
+{
+namespace matrix
+{
+
+/**
+Assembler: builds SparseCRS and SparseCCS matrices from a list of (row, column, value)
+triplets.  Triplets are appended in any order and may repeat coordinates, whose values
+are summed, as in finite element stiffness matrix assembly.
+
+The first call to assemble() sorts the triplets with a two-pass counting sort and
+records where each triplet landed in the compressed matrix.  After restart(), the same
+sequence of coordinates can be added again to refill the values of a matrix with that
+sparsity pattern, without allocating memory or sorting.
+**/
+template<typename Scalar>
+class Assembler
+{
+public:
+	typedef Scalar scalar_type;
+
+	struct Data
+	{
+		size_t	n_rows;		// number of rows
+		size_t	n_columns;	// number of columns
+
+		std::vector<size_t> row_index;
+		std::vector<size_t> column_index;
+		std::vector<Scalar> values;
+
+		// position of each triplet in the values array of the assembled matrix
+		std::vector<size_t> slot;
+	} data;
+
+protected:
+	enum Pattern
+	{
+		PATTERN_NONE,
+		PATTERN_CRS,
+		PATTERN_CCS
+	};
+
+	Pattern	m_pattern;	// format of the recorded sparsity pattern
+	bool	m_fixed_pattern;	// true if add() refills the values of a recorded pattern
+	size_t	m_cursor;	// next triplet to be refilled
+	size_t	m_pattern_nnz;	// number of non-zero elements of the recorded pattern
+
+public:
+	Assembler(size_t rows = 0, size_t columns = 0);
+
+	size_t rows() const		{ return data.n_rows; };
+	size_t columns() const		{ return data.n_columns; };
+
+	/**
+	 * Returns the number of triplets added so far
+	 **/
+	size_t size() const	{ return m_fixed_pattern ? m_cursor : data.values.size(); }
+
+	/**
+	 * Changes the matrix size, dropping all triplets and the recorded pattern
+	 **/
+	void resize(size_t rows, size_t columns);
+
+	/**
+	 * Reserve memory for at least size-many triplets
+	 **/
+	void reserve(size_t size);
+
+	/**
+	 * Drops all triplets and the recorded pattern
+	 **/
+	void clear();
+
+	/**
+	 * Adds value to the element in (row, column).  In fixed pattern mode the
+	 * coordinates must follow the sequence used to assemble the pattern.
+	 *@param row	the element row
+	 *@param column	the element column
+	 */
+	void add(size_t row, size_t column, Scalar value);
+
+	/**
+	 * Starts a numeric-only reassembly over the recorded sparsity pattern
+	 **/
+	void restart();
+
+	/**
+	 * Check if add() refills the values of a recorded pattern
+	 **/
+	bool isFixedPattern() const	{ return m_fixed_pattern; }
+
+	/**
+	 * Builds the matrix from the triplets, or refills its values in fixed pattern mode
+	 **/
+	void assemble(SparseCRS<Scalar> &A);
+	void assemble(SparseCCS<Scalar> &A);
+
+protected:
+	/**
+	 * Compresses the triplets along the major index, with minor indices sorted
+	 * and duplicate entries summed.
+	 *@param major	row index for CRS, column index for CCS
+	 *@param minor	column index for CRS, row index for CCS
+	 */
+	void compress(std::vector<size_t> const &major, size_t n_major, std::vector<size_t> const &minor, size_t n_minor, std::vector<size_t> &pointer, std::vector<size_t> &index, std::vector<Scalar> &values);
+
+	/**
+	 * Adds the triplet values to the recorded slots of values
+	 **/
+	void scatter(std::vector<Scalar> &values) const;
+};
+
+
+
+template<typename Scalar>
+Assembler<Scalar>::Assembler(size_t rows, size_t columns)
+{
+	resize(rows, columns);
+}
+
+
+template<typename Scalar>
+void
+Assembler<Scalar>::resize(size_t rows, size_t columns)
+{
+	clear();
+
+	data.n_rows = rows;
+	data.n_columns = columns;
+}
+
+
+template<typename Scalar>
+void
+Assembler<Scalar>::reserve(size_t size)
+{
+	data.row_index.reserve(size);
+	data.column_index.reserve(size);
+	data.values.reserve(size);
+}
+
+
+template<typename Scalar>
+void
+Assembler<Scalar>::clear()
+{
+	data.row_index.clear();
+	data.column_index.clear();
+	data.values.clear();
+	data.slot.clear();
+
+	m_pattern = PATTERN_NONE;
+	m_fixed_pattern = false;
+	m_cursor = 0;
+	m_pattern_nnz = 0;
+}
+
+
+template<typename Scalar>
+void
+Assembler<Scalar>::add(size_t row, size_t column, Scalar value)
+{
+	if(row >= this->rows())
+	{
+		throw LAException("Assembler::add(): row >= rows()");
+	}
+	if(column >= this->columns())
+	{
+		throw LAException("Assembler::add(): column >= columns()");
+	}
+
+	if(m_fixed_pattern)
+	{
+		if(m_cursor >= data.values.size() || data.row_index[m_cursor] != row || data.column_index[m_cursor] != column)
+		{
+			throw LAException("Assembler::add(): element doesn't follow the recorded pattern");
+		}
+
+		data.values[m_cursor++] = value;
+		return;
+	}
+
+	data.row_index.push_back(row);
+	data.column_index.push_back(column);
+	data.values.push_back(value);
+}
+
+
+template<typename Scalar>
+void
+Assembler<Scalar>::restart()
+{
+	if(m_pattern == PATTERN_NONE)
+	{
+		throw LAException("Assembler::restart(): no pattern was assembled");
+	}
+
+	m_fixed_pattern = true;
+	m_cursor = 0;
+}
+
+
+template<typename Scalar>
+void
+Assembler<Scalar>::assemble(SparseCRS<Scalar> &A)
+{
+	if(m_fixed_pattern)
+	{
+		if(m_pattern != PATTERN_CRS)
+		{
+			throw LAException("Assembler::assemble(): the recorded pattern isn't a CRS pattern");
+		}
+		if(m_cursor != data.values.size())
+		{
+			throw LAException("Assembler::assemble(): missing elements in the recorded pattern");
+		}
+		if(A.rows() != this->rows() || A.columns() != this->columns() || A.data.values.size() != m_pattern_nnz)
+		{
+			throw LAException("Assembler::assemble(): matrix doesn't match the recorded pattern");
+		}
+
+		scatter(A.data.values);
+		m_cursor = 0;
+		return;
+	}
+
+	A.data.n_columns = this->columns();
+	compress(data.row_index, this->rows(), data.column_index, this->columns(), A.data.row_pointer, A.data.column_index, A.data.values);
+	m_pattern = PATTERN_CRS;
+}
+
+
+template<typename Scalar>
+void
+Assembler<Scalar>::assemble(SparseCCS<Scalar> &A)
+{
+	if(m_fixed_pattern)
+	{
+		if(m_pattern != PATTERN_CCS)
+		{
+			throw LAException("Assembler::assemble(): the recorded pattern isn't a CCS pattern");
+		}
+		if(m_cursor != data.values.size())
+		{
+			throw LAException("Assembler::assemble(): missing elements in the recorded pattern");
+		}
+		if(A.rows() != this->rows() || A.columns() != this->columns() || A.data.values.size() != m_pattern_nnz)
+		{
+			throw LAException("Assembler::assemble(): matrix doesn't match the recorded pattern");
+		}
+
+		scatter(A.data.values);
+		m_cursor = 0;
+		return;
+	}
+
+	A.data.n_rows = this->rows();
+	compress(data.column_index, this->columns(), data.row_index, this->rows(), A.data.column_pointer, A.data.row_index, A.data.values);
+	m_pattern = PATTERN_CCS;
+}
+
+
+template<typename Scalar>
+void
+Assembler<Scalar>::compress(std::vector<size_t> const &major, size_t n_major, std::vector<size_t> const &minor, size_t n_minor, std::vector<size_t> &pointer, std::vector<size_t> &index, std::vector<Scalar> &values)
+{
+	size_t const n = data.values.size();
+
+	// first pass: stable counting sort by the minor index
+	std::vector<size_t> count(std::max(n_major, n_minor)+1, 0);
+	for(size_t k = 0; k < n; k++)
+	{
+		count[minor[k]+1]++;
+	}
+	for(size_t i = 0; i < n_minor; i++)
+	{
+		count[i+1] += count[i];
+	}
+
+	std::vector<size_t> by_minor(n);
+	for(size_t k = 0; k < n; k++)
+	{
+		by_minor[ count[minor[k]]++ ] = k;
+	}
+
+	// second pass: stable counting sort by the major index, which leaves minor indices sorted
+	std::fill(count.begin(), count.end(), 0);
+	for(size_t k = 0; k < n; k++)
+	{
+		count[major[k]+1]++;
+	}
+	for(size_t i = 0; i < n_major; i++)
+	{
+		count[i+1] += count[i];
+	}
+
+	std::vector<size_t> order(n);
+	for(size_t t = 0; t < n; t++)
+	{
+		size_t const k = by_minor[t];
+		order[ count[major[k]]++ ] = k;
+	}
+
+	// compress, summing duplicate entries
+	pointer.assign(n_major+1, 0);
+	index.clear();
+	values.clear();
+	index.reserve(n);
+	values.reserve(n);
+	data.slot.resize(n);
+
+	size_t t = 0;
+	for(size_t i = 0; i < n_major; i++)
+	{
+		pointer[i] = index.size();
+		size_t const row_start = index.size();
+
+		for(; t < n && major[order[t]] == i; t++)
+		{
+			size_t const k = order[t];
+
+			if(index.size() > row_start && index.back() == minor[k])
+			{
+				values.back() += data.values[k];
+			}
+			else
+			{
+				index.push_back(minor[k]);
+				values.push_back(data.values[k]);
+			}
+			data.slot[k] = values.size()-1;
+		}
+	}
+	pointer[n_major] = index.size();
+
+	m_pattern_nnz = values.size();
+}
+
+
+template<typename Scalar>
+void
+Assembler<Scalar>::scatter(std::vector<Scalar> &values) const
+{
+	std::fill(values.begin(), values.end(), (Scalar)0);
+
+	for(size_t k = 0; k < data.slot.size(); k++)
+	{
+		values[data.slot[k]] += data.values[k];
+	}
+}
+
+
+}	// namespace matrix
+}	// namespace mla
+
+#endif
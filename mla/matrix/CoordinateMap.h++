@@ -0,0 +1,343 @@
+#ifndef MLA_MATRIX_COORDINATE_MAP_HPP
+#define MLA_MATRIX_COORDINATE_MAP_HPP
+
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+
+namespace mla
+{
+namespace matrix
+{
+
+/**
+CoordinateMap: an open addressing hash map from (row, column) coordinates to values,
+used as the SparseDOK storage.
+
+Entries are kept in a single array of slots with linear probing and erased by
+shifting the following entries back, so there are no tombstones and no per-element
+heap allocation.  The table doubles once it is three quarters full.  Iteration
+visits the entries in no particular order.
+**/
+template<typename Scalar>
+class CoordinateMap
+{
+public:
+	typedef std::pair<size_t,size_t>	key_type;
+	typedef Scalar	mapped_type;
+	typedef std::pair<key_type, Scalar>	value_type;
+
+	/**
+	 * Forward iterator over the occupied slots
+	 **/
+	template<typename Value>
+	class Iterator
+	{
+	public:
+		typedef std::forward_iterator_tag	iterator_category;
+		typedef Value	value_type;
+		typedef std::ptrdiff_t	difference_type;
+		typedef Value *	pointer;
+		typedef Value &	reference;
+
+	protected:
+		template<typename> friend class Iterator;
+
+		Value	*m_slot;
+		Value	*m_end;
+
+		void skip()	{ while(m_slot != m_end && m_slot->first.first == CoordinateMap::empty_row()) ++m_slot; }
+
+	public:
+		Iterator(Value *slot = nullptr, Value *end = nullptr)
+			: m_slot(slot), m_end(end)
+		{
+			skip();
+		}
+
+		// iterator to const_iterator conversion
+		template<typename Other>
+		Iterator(Iterator<Other> const &other)
+			: m_slot(other.m_slot), m_end(other.m_end)
+		{ }
+
+		Value & operator*() const	{ return *m_slot; }
+		Value * operator->() const	{ return m_slot; }
+
+		Iterator & operator++()	{ ++m_slot; skip(); return *this; }
+		Iterator operator++(int)	{ Iterator previous = *this; ++(*this); return previous; }
+
+		bool operator==(Iterator const &other) const	{ return m_slot == other.m_slot; }
+		bool operator!=(Iterator const &other) const	{ return m_slot != other.m_slot; }
+	};
+
+	typedef Iterator<value_type>	iterator;
+	typedef Iterator<value_type const>	const_iterator;
+
+protected:
+	std::vector<value_type>	m_slots;	// size is zero or a power of two
+	size_t	m_size;	// number of occupied slots
+
+public:
+	CoordinateMap()
+		: m_size(0)
+	{ }
+
+	/**
+	 * Row index that marks an empty slot
+	 **/
+	static size_t empty_row()	{ return ~(size_t)0; }
+
+	size_t size() const	{ return m_size; }
+	bool empty() const	{ return m_size == 0; }
+
+	/**
+	 * Returns the number of slots in the table
+	 **/
+	size_t bucket_count() const	{ return m_slots.size(); }
+
+	/**
+	 * Erases all entries, keeping the table allocated
+	 **/
+	void clear();
+
+	/**
+	 * Grows the table to hold at least n entries without rehashing
+	 **/
+	void reserve(size_t n);
+
+	/**
+	 * Returns a reference to the value of key, inserting a zero if it isn't stored
+	 **/
+	Scalar & operator[](key_type const &key);
+
+	iterator find(key_type const &key);
+	const_iterator find(key_type const &key) const;
+
+	size_t count(key_type const &key) const	{ return find(key) != end() ? 1 : 0; }
+
+	/**
+	 * Erases key, returning the number of erased entries
+	 **/
+	size_t erase(key_type const &key);
+
+	/**
+	 * Replaces every key k by new_key(k).  new_key must be injective on the stored keys
+	 * and map any key it changes to either a free key or to another changed key, as a
+	 * permutation of rows or columns does.  Only the entries whose key changes are moved.
+	 **/
+	template<typename Function>
+	void remap(Function new_key);
+
+	iterator begin()	{ return iterator(m_slots.data(), m_slots.data() + m_slots.size()); }
+	iterator end()	{ return iterator(m_slots.data() + m_slots.size(), m_slots.data() + m_slots.size()); }
+	const_iterator begin() const	{ return const_iterator(m_slots.data(), m_slots.data() + m_slots.size()); }
+	const_iterator end() const	{ return const_iterator(m_slots.data() + m_slots.size(), m_slots.data() + m_slots.size()); }
+
+protected:
+	static size_t hash(key_type const &key)
+	{
+		// 64 bit finalizer of MurmurHash3 on the row and the block of 8 columns, so
+		// that the elements of a block land on consecutive slots
+		uint64_t h = (uint64_t)key.first*0x9e3779b97f4a7c15ull + (uint64_t)(key.second >> 3);
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ull;
+		h ^= h >> 33;
+		return (size_t)(h & ~(uint64_t)7) + (key.second & 7);
+	}
+
+	/**
+	 * Returns the slot that holds key, or the empty slot where it would be inserted.
+	 * The table must not be empty.
+	 **/
+	size_t probe(key_type const &key) const;
+
+	/**
+	 * Moves all entries to a table with the given number of slots
+	 **/
+	void rehash(size_t slots);
+};
+
+
+
+template<typename Scalar>
+void
+CoordinateMap<Scalar>::clear()
+{
+	for(auto &slot: m_slots)
+	{
+		slot.first.first = empty_row();
+	}
+	m_size = 0;
+}
+
+
+template<typename Scalar>
+void
+CoordinateMap<Scalar>::reserve(size_t n)
+{
+	size_t slots = 16;
+	while(slots/4*3 < n)
+	{
+		slots *= 2;
+	}
+
+	if(slots > m_slots.size())
+	{
+		rehash(slots);
+	}
+}
+
+
+template<typename Scalar>
+size_t
+CoordinateMap<Scalar>::probe(key_type const &key) const
+{
+	size_t const mask = m_slots.size()-1;
+
+	size_t k = hash(key) & mask;
+	while(m_slots[k].first.first != empty_row() && m_slots[k].first != key)
+	{
+		k = (k+1) & mask;
+	}
+	return k;
+}
+
+
+template<typename Scalar>
+Scalar &
+CoordinateMap<Scalar>::operator[](key_type const &key)
+{
+	if((m_size+1) > m_slots.size()/4*3)
+	{
+		reserve(m_size+1);
+	}
+
+	size_t const k = probe(key);
+	if(m_slots[k].first.first == empty_row())
+	{
+		m_slots[k].first = key;
+		m_slots[k].second = (Scalar)0;
+		m_size++;
+	}
+	return m_slots[k].second;
+}
+
+
+template<typename Scalar>
+typename CoordinateMap<Scalar>::iterator
+CoordinateMap<Scalar>::find(key_type const &key)
+{
+	if(m_size == 0)
+		return end();
+
+	size_t const k = probe(key);
+	if(m_slots[k].first.first == empty_row())
+		return end();
+
+	return iterator(m_slots.data() + k, m_slots.data() + m_slots.size());
+}
+
+
+template<typename Scalar>
+typename CoordinateMap<Scalar>::const_iterator
+CoordinateMap<Scalar>::find(key_type const &key) const
+{
+	if(m_size == 0)
+		return end();
+
+	size_t const k = probe(key);
+	if(m_slots[k].first.first == empty_row())
+		return end();
+
+	return const_iterator(m_slots.data() + k, m_slots.data() + m_slots.size());
+}
+
+
+template<typename Scalar>
+size_t
+CoordinateMap<Scalar>::erase(key_type const &key)
+{
+	if(m_size == 0)
+		return 0;
+
+	size_t const mask = m_slots.size()-1;
+
+	size_t hole = probe(key);
+	if(m_slots[hole].first.first == empty_row())
+		return 0;
+
+	// shift back the following entries of the cluster that may fill the hole
+	for(size_t k = (hole+1) & mask; m_slots[k].first.first != empty_row(); k = (k+1) & mask)
+	{
+		size_t const home = hash(m_slots[k].first) & mask;
+		if( ((k - home) & mask) >= ((k - hole) & mask) )
+		{
+			m_slots[hole] = m_slots[k];
+			hole = k;
+		}
+	}
+
+	m_slots[hole].first.first = empty_row();
+	m_size--;
+	return 1;
+}
+
+
+template<typename Scalar>
+template<typename Function>
+void
+CoordinateMap<Scalar>::remap(Function new_key)
+{
+	std::vector<value_type> moved;
+	for(auto const &slot: m_slots)
+	{
+		if(slot.first.first != empty_row() && new_key(slot.first) != slot.first)
+		{
+			moved.push_back(slot);
+		}
+	}
+
+	for(auto const &entry: moved)
+	{
+		erase(entry.first);
+	}
+
+	for(auto const &entry: moved)
+	{
+		(*this)[new_key(entry.first)] = entry.second;
+	}
+}
+
+
+template<typename Scalar>
+void
+CoordinateMap<Scalar>::rehash(size_t slots)
+{
+	std::vector<value_type> old(slots, value_type(key_type(empty_row(), 0), (Scalar)0));
+	old.swap(m_slots);
+
+	size_t const mask = m_slots.size()-1;
+	for(auto const &slot: old)
+	{
+		if(slot.first.first != empty_row())
+		{
+			size_t k = hash(slot.first) & mask;
+			while(m_slots[k].first.first != empty_row())
+			{
+				k = (k+1) & mask;
+			}
+			m_slots[k] = slot;
+		}
+	}
+}
+
+
+}	// namespace matrix
+}	// namespace mla
+
+#endif
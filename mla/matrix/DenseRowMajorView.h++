@@ -0,0 +1,101 @@
+#ifndef MLA_MATRIX_DENSE_ROW_MAJOR_VIEW_HPP
+#define MLA_MATRIX_DENSE_ROW_MAJOR_VIEW_HPP
+
+#include <string>
+
+#include <mla/LAException.h++>
+#include <mla/Snapshot.h++>
+
+
+namespace mla
+{
+namespace matrix
+{
+
+/**
+DenseRowMajorView: a read-only DenseRowMajor matrix whose elements are used in place
+from a memory-mapped snapshot, with the element layout of DenseRowMajor.
+**/
+template<typename Scalar>
+class DenseRowMajorView
+{
+public:
+	typedef Scalar scalar_type;
+
+	struct Data
+	{
+		size_t	n_rows;		// number of rows
+		size_t	n_columns;	// number of columns
+
+		Scalar const	*element_vector;
+
+		size_t getElementIndex(size_t i, size_t j) const {return i+ n_rows*j;}
+	} data;
+
+protected:
+	SnapshotFile	m_file;
+
+public:
+	/**
+	 * Maps a snapshot saved from a DenseRowMajor<Scalar>
+	 */
+	explicit DenseRowMajorView(std::string const &file_name);
+
+	size_t rows() const		{ return data.n_rows; };
+	size_t columns() const		{ return data.n_columns; };
+
+	/*
+	Returns the value in [row,column] 
+	*/
+	Scalar getValue(size_t i, size_t j) const;
+
+	Scalar const & operator() (size_t i, size_t j) const;
+};
+
+
+
+template<typename Scalar>
+DenseRowMajorView<Scalar>::DenseRowMajorView(std::string const &file_name)
+	: m_file(file_name, SNAPSHOT_DENSE_ROW_MAJOR, detail::SnapshotScalar<Scalar>::type)
+{
+	auto const &header = m_file.header();
+	if(header.nnz != header.rows*header.columns)
+	{
+		throw LAException("DenseRowMajorView: the number of elements doesn't match the dimensions");
+	}
+
+	data.n_rows = header.rows;
+	data.n_columns = header.columns;
+	data.element_vector = m_file.array<Scalar>(0);
+}
+
+
+template<typename Scalar>
+Scalar
+DenseRowMajorView<Scalar>::getValue(size_t i, size_t j) const
+{
+	return (*this)(i,j);
+}
+
+
+template<typename Scalar>
+Scalar const &
+DenseRowMajorView<Scalar>::operator() (size_t i, size_t j) const
+{
+	if(i >= this->rows())
+	{
+		throw LAException("DenseRowMajorView::operator(): i >= rows()");
+	}
+	if(j >= this->columns())
+	{
+		throw LAException("DenseRowMajorView::operator(): j >= columns()");
+	}
+
+	return data.element_vector[data.getElementIndex(i,j)];
+}
+
+
+}	// namespace matrix
+}	// namespace mla
+
+#endif
@@ -119,15 +119,7 @@ SparseCCS<Scalar>::getValue(size_t row, size_t column) const
 		throw LAException("column >= columns()");
 	}
 
-	size_t i = data.column_pointer[column];
-
-	if(row == data.row_index[i])
-		return data.values[i];
-
-	if(row < data.row_index[i])
-		return 0;
-
-	for(i = data.column_pointer[column]; i < data.column_pointer[column+1]; i++)
+	for(size_t i = data.column_pointer[column]; i < data.column_pointer[column+1]; i++)
 	{
 		if(data.row_index[i] < row)
 			continue;
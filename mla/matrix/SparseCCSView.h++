@@ -0,0 +1,137 @@
+#ifndef MLA_MATRIX_SPARSE_CCS_VIEW_HPP
+#define MLA_MATRIX_SPARSE_CCS_VIEW_HPP
+
+#include <algorithm>
+#include <string>
+#include <type_traits>
+
+#include <mla/LAException.h++>
+#include <mla/Snapshot.h++>
+
+
+namespace mla
+{
+namespace matrix
+{
+
+/**
+SparseCCSView: a read-only SparseCCS matrix whose arrays are used in place from a
+memory-mapped snapshot, so opening it costs no parsing nor copying.  Pages are read
+from the file as the elements are accessed.
+
+The snapshot must have been saved with indices of the same width as Index.
+
+Opening a view only checks the header and the first and last column pointers, so that it
+stays O(1) whatever the size of the matrix.  The other elements are trusted: the column
+pointers must be non-decreasing and the row indices below rows(), or the accesses
+may fall outside of the mapping.  verify() checks them in O(nnz), for snapshots that
+may have been corrupted.
+**/
+template<typename Scalar, typename Index = size_t>
+class SparseCCSView
+{
+	static_assert(std::is_unsigned<Index>::value && (sizeof(Index) == 4 || sizeof(Index) == 8), "SparseCCSView: Index must be a 32 or 64 bit unsigned integer");
+
+public:
+	typedef Scalar scalar_type;
+	typedef Index index_type;
+
+	struct Data
+	{
+		size_t	n_rows;
+		size_t	n_columns;
+		size_t	nnz;
+
+		Index const	*column_pointer;
+		Index const	*row_index;
+		Scalar const	*values;
+	} data;
+
+protected:
+	SnapshotFile	m_file;
+
+public:
+	/**
+	 * Maps a snapshot saved from a SparseCCS<Scalar>
+	 */
+	explicit SparseCCSView(std::string const &file_name);
+
+	size_t rows() const		{ return data.n_rows; };
+	size_t columns() const		{ return data.n_columns; };
+
+	/**
+	 * Returns the number of stored elements
+	 */
+	size_t nnz() const		{ return data.nnz; };
+
+	/*
+	Returns the value in [row,column] 
+	*/
+	Scalar getValue(size_t row, size_t column) const;
+
+	/**
+	 * Checks that the column pointers are non-decreasing and the row indices in range,
+	 * throwing an LAException otherwise
+	 */
+	void verify() const;
+};
+
+
+
+template<typename Scalar, typename Index>
+SparseCCSView<Scalar, Index>::SparseCCSView(std::string const &file_name)
+	: m_file(file_name, SNAPSHOT_SPARSE_CCS, detail::SnapshotScalar<Scalar>::type)
+{
+	if(m_file.indexWidth() != sizeof(Index))
+	{
+		throw LAException("SparseCCSView: the snapshot indices have a different width");
+	}
+
+	auto const &header = m_file.header();
+	data.n_rows = header.rows;
+	data.n_columns = header.columns;
+	data.nnz = header.nnz;
+	data.column_pointer = m_file.array<Index>(0);
+	data.row_index = m_file.array<Index>(1);
+	data.values = m_file.array<Scalar>(2);
+
+	if(data.column_pointer[0] != 0 || data.column_pointer[data.n_columns] != data.nnz)
+	{
+		throw LAException("SparseCCSView: corrupted column pointer array");
+	}
+}
+
+
+template<typename Scalar, typename Index>
+void
+SparseCCSView<Scalar, Index>::verify() const
+{
+	detail::check_compressed("SparseCCSView", data.column_pointer, data.n_columns, data.row_index, data.nnz, data.n_rows);
+}
+
+
+template<typename Scalar, typename Index>
+Scalar
+SparseCCSView<Scalar, Index>::getValue(size_t row, size_t column) const
+{
+	if(row >= this->rows())
+	{
+		throw LAException("SparseCCSView::getValue(): row >= rows()");
+	}
+	if(column >= this->columns())
+	{
+		throw LAException("SparseCCSView::getValue(): column >= columns()");
+	}
+
+	Index const *begin = data.row_index + data.column_pointer[column];
+	Index const *end = data.row_index + data.column_pointer[column+1];
+	Index const *position = std::lower_bound(begin, end, static_cast<Index>(row));
+
+	return (position != end && *position == row) ? data.values[position - data.row_index] : (Scalar)0;
+}
+
+
+}	// namespace matrix
+}	// namespace mla
+
+#endif
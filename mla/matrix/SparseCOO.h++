@@ -1,7 +1,8 @@
 #ifndef MLA_MATRIX_STORAGE_POLICY_SPARSE_COO_HPP
 #define MLA_MATRIX_STORAGE_POLICY_SPARSE_COO_HPP
 
-#include <list>
+#include <cmath>
+#include <vector>
 #include <algorithm>
 
 #include <mla/matrix/traits.h++>
@@ -18,7 +19,15 @@ namespace matrix
 /**
 SparseCOO: a storage policy class for the Matrix host class.
 This class implements the interface for the sparse coordinate list (COO) 
-matrix format
+matrix format.
+
+The coordinates and values are stored in three parallel arrays.  The leading
+data.n_sorted elements are sorted by row and column, without repeated coordinates, and
+are looked up by binary search; elements inserted afterwards are appended to the
+unsorted tail, which is sorted and merged into the leading part by compress() once it
+grows past about sqrt(2 nnz) elements.  addValue() appends without any lookup and leaves
+repeated coordinates to be summed by compress(), which is the fast path to fill a
+matrix before converting it to a compressed format.
 **/
 template<typename Scalar>
 class SparseCOO
@@ -34,29 +43,53 @@ public:
 		size_t	n_rows;		// number of rows
 		size_t	n_columns;	// number of columns
 
-		struct Coordinate {
-			size_t i;
-			size_t j;
-			Scalar value;
-		};
+		std::vector<size_t>	row_index;
+		std::vector<size_t>	column_index;
+		std::vector<Scalar>	values;
 
-		std::list<Coordinate> coordinate_list;
+		size_t	n_sorted;	// number of leading elements sorted by (row, column), without repeats
+		bool	repeated;	// true if the unsorted tail may hold repeated coordinates
 
-		Scalar & getKeyReference(size_t const i, size_t const j)	
+		/**
+		 * Returns the position of the element in (i, j) in the sorted part, or n_sorted
+		 * if it isn't there
+		 **/
+		size_t findSorted(size_t const i, size_t const j) const;
+
+		/**
+		 * Returns the position of the first element in (i, j), or values.size() if it
+		 * isn't stored
+		 **/
+		size_t find(size_t const i, size_t const j) const;
+
+		Scalar & getKeyReference(size_t const i, size_t const j);
+
+		/**
+		 * Sorts all elements by row and column and sums the repeated coordinates
+		 **/
+		void compress();
+
+		/**
+		 * Appends an element to the unsorted tail
+		 **/
+		void push_back(size_t const i, size_t const j, Scalar const value)
 		{	
-			auto predicate = [&](typename Data::Coordinate const &c) { return c.i == i && c.j == j; };
-			auto it = std::find_if(coordinate_list.begin(), coordinate_list.end(), predicate);
-			if( it == coordinate_list.end())
-			{
-				Coordinate c{i,j,(Scalar)0};
-				coordinate_list.push_back(c);
-				return coordinate_list.back().value;
-			}
-			else
-			{
-				return it->value;
-			}
+			row_index.push_back(i);
+			column_index.push_back(j);
+			values.push_back(value);
 		}
+
+		/**
+		 * Drops all elements
+		 **/
+		void clear();
+
+	protected:
+		/**
+		 * Returns the positions of the unsorted tail in (row, column) order, keeping the
+		 * insertion order of repeated coordinates
+		 **/
+		std::vector<size_t> sortTail() const;
 	} data;
 
 public:
@@ -82,6 +115,14 @@ public:
 	 */
 	void setValue(size_t row, size_t column, Scalar value);
 
+	/**
+	 * Adds value to the element in (row, column) by appending a new element, without
+	 * looking up the coordinates.  Repeated coordinates are summed by compress().
+	 *@param row	the element row
+	 *@param column	the element column
+	 */
+	void addValue(size_t row, size_t column, Scalar value);
+
 	/**
 	 * Returns a reference to the element in (row, column)
 	 *@param row	the element row
@@ -92,6 +133,16 @@ public:
 
 	void resize(size_t row, size_t column);
 
+	/**
+	 * Reserve memory for at least nnz-many elements
+	 **/
+	void reserve(size_t nnz);
+
+	/**
+	 * Sorts the elements by row and column and sums the repeated coordinates
+	 **/
+	void compress()	{ data.compress(); }
+
 	/**
 	Sets ones on the main diagonal and zeros elsewhere
 	**/
@@ -103,7 +154,8 @@ public:
 	bool isSquare() const { return rows() == columns(); }
 
 	/**
-	* Returns the number of non-zero coefficients
+	* Returns the number of stored elements, including repeated coordinates added
+	* with addValue() and not yet compressed
 	**/
 	size_t nnz() const;
 
@@ -140,10 +192,218 @@ public:
 	 * returns an object with the right part of the current matrix
 	 **/
 	SparseCOO<Scalar> splitOutRight(std::size_t column_index);
+
+protected:
+	/**
+	 * Moves the elements that satisfy predicate to other, applying shift to their
+	 * coordinates, and keeps the remaining ones in order
+	 **/
+	template<typename Predicate, typename Shift>
+	void splitOut(SparseCOO<Scalar> &other, Predicate predicate, Shift shift);
 };
 
 
 
+template<typename Scalar>
+size_t 
+SparseCOO<Scalar>::Data::findSorted(size_t const i, size_t const j) const
+{
+	size_t first = 0, last = n_sorted;
+	while(first < last)
+	{
+		size_t const middle = first + (last-first)/2;
+		if(row_index[middle] < i || (row_index[middle] == i && column_index[middle] < j))
+			first = middle+1;
+		else
+			last = middle;
+	}
+
+	if(first < n_sorted && row_index[first] == i && column_index[first] == j)
+		return first;
+
+	return n_sorted;
+}
+
+
+template<typename Scalar>
+size_t 
+SparseCOO<Scalar>::Data::find(size_t const i, size_t const j) const
+{
+	size_t const k = findSorted(i, j);
+	if(k < n_sorted)
+		return k;
+
+	// linear search on the unsorted tail
+	for(size_t t = n_sorted; t < values.size(); t++)
+	{
+		if(row_index[t] == i && column_index[t] == j)
+			return t;
+	}
+
+	return values.size();
+}
+
+
+template<typename Scalar>
+Scalar & 
+SparseCOO<Scalar>::Data::getKeyReference(size_t const i, size_t const j)
+{
+	// balances the linear search of the tail against the cost of merging it
+	size_t const tail = values.size() - n_sorted;
+	if(repeated || tail > std::max<size_t>(256, (size_t)std::sqrt(2.0*values.size())))
+	{
+		compress();
+	}
+
+	size_t const k = find(i, j);
+	if(k == values.size())
+	{
+		push_back(i, j, (Scalar)0);
+	}
+	return values[k];
+}
+
+
+template<typename Scalar>
+std::vector<size_t>
+SparseCOO<Scalar>::Data::sortTail() const
+{
+	size_t const n = values.size() - n_sorted;
+
+	std::vector<size_t> order(n);
+	for(size_t t = 0; t < n; t++)
+	{
+		order[t] = n_sorted + t;
+	}
+
+	// short tails are cheaper to sort by comparison than to count over all rows and columns
+	if(n*8 < n_rows + n_columns)
+	{
+		std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b)
+			{
+				return row_index[a] < row_index[b] || (row_index[a] == row_index[b] && column_index[a] < column_index[b]);
+			});
+		return order;
+	}
+
+	// two-pass stable counting sort, by column and then by row
+	std::vector<size_t> count(std::max(n_rows, n_columns)+1, 0);
+	std::vector<size_t> by_column(n);
+
+	for(size_t t = 0; t < n; t++)
+	{
+		count[column_index[order[t]]+1]++;
+	}
+	for(size_t j = 0; j < n_columns; j++)
+	{
+		count[j+1] += count[j];
+	}
+	for(size_t t = 0; t < n; t++)
+	{
+		by_column[ count[column_index[order[t]]]++ ] = order[t];
+	}
+
+	std::fill(count.begin(), count.end(), 0);
+	for(size_t t = 0; t < n; t++)
+	{
+		count[row_index[by_column[t]]+1]++;
+	}
+	for(size_t i = 0; i < n_rows; i++)
+	{
+		count[i+1] += count[i];
+	}
+	for(size_t t = 0; t < n; t++)
+	{
+		order[ count[row_index[by_column[t]]]++ ] = by_column[t];
+	}
+
+	return order;
+}
+
+
+template<typename Scalar>
+void 
+SparseCOO<Scalar>::Data::compress()
+{
+	if(n_sorted == values.size())
+	{
+		repeated = false;
+		return;
+	}
+
+	size_t const n = values.size();
+
+	// merge the sorted part with the sorted tail, the sorted part going first on ties
+	std::vector<size_t> order;
+	if(n_sorted == 0)
+	{
+		order = sortTail();
+	}
+	else
+	{
+		std::vector<size_t> const tail = sortTail();
+		order.reserve(n);
+
+		size_t a = 0, b = 0;
+		while(a < n_sorted && b < tail.size())
+		{	
+			size_t const k = tail[b];
+			if(row_index[k] < row_index[a] || (row_index[k] == row_index[a] && column_index[k] < column_index[a]))
+				order.push_back(tail[b++]);
+			else
+				order.push_back(a++);
+		}
+		for(; a < n_sorted; a++)
+			order.push_back(a);
+		for(; b < tail.size(); b++)
+			order.push_back(tail[b]);
+	}
+
+	// gather, summing the repeated coordinates
+	std::vector<size_t> sorted_row, sorted_column;
+	std::vector<Scalar> sorted_values;
+	sorted_row.reserve(n);
+	sorted_column.reserve(n);
+	sorted_values.reserve(n);
+
+	for(size_t t = 0; t < n; t++)
+	{
+		size_t const k = order[t];
+		if(!sorted_values.empty() && sorted_row.back() == row_index[k] && sorted_column.back() == column_index[k])
+		{	
+			sorted_values.back() += values[k];
+		}
+		else
+		{	
+			sorted_row.push_back(row_index[k]);
+			sorted_column.push_back(column_index[k]);
+			sorted_values.push_back(values[k]);
+		}
+	}
+
+	row_index.swap(sorted_row);
+	column_index.swap(sorted_column);
+	values.swap(sorted_values);
+
+	n_sorted = values.size();
+	repeated = false;
+}
+
+
+template<typename Scalar>
+void 
+SparseCOO<Scalar>::Data::clear()
+{
+	row_index.clear();
+	column_index.clear();
+	values.clear();
+
+	n_sorted = 0;
+	repeated = false;
+}
+
+
+
 template<typename Scalar>
 SparseCOO<Scalar>::SparseCOO(size_t rows, size_t columns)
 {
@@ -152,11 +412,10 @@ SparseCOO<Scalar>::SparseCOO(size_t rows, size_t columns)
 
 
 template<typename Scalar>
-void
+void 
 SparseCOO<Scalar>::setZero()
 {
-	using namespace std;
-	data.coordinate_list.clear();
+	data.clear();
 }
 
 
@@ -164,8 +423,6 @@ template<typename Scalar>
 Scalar
 SparseCOO<Scalar>::getValue(size_t row, size_t column) const
 {
-	using namespace std;
-
 	if(row >= rows() )
 	{
 		throw LAException("row >= rows()");
@@ -175,25 +432,29 @@ SparseCOO<Scalar>::getValue(size_t row, size_t column) const
 		throw LAException("column >= columns()");
 	}
 
-	auto predicate = [&](typename Data::Coordinate const & c) { return c.i == row && c.j == column; };
-
-	typename std::list<typename Data::Coordinate>::const_iterator it = std::find_if(data.coordinate_list.begin(), data.coordinate_list.end(), predicate);
-
-	Scalar value = (Scalar) 0.0f;
-	if(it != data.coordinate_list.end())
+	if(!data.repeated)
 	{
-		typename Data::Coordinate c = *it;
-
-		value = c.value;
+		size_t const k = data.find(row, column);
+		return k < data.values.size() ? data.values[k] : (Scalar)0;
 	}
 
+	// sum the repeated coordinates that weren't compressed yet
+	size_t const k = data.findSorted(row, column);
+	Scalar value = k < data.n_sorted ? data.values[k] : (Scalar)0;
+	for(size_t t = data.n_sorted; t < data.values.size(); t++)
+	{
+		if(data.row_index[t] == row && data.column_index[t] == column)
+		{	
+			value += data.values[t];
+		}
+	}
 	return value;
 }
 
 
 
 template<typename Scalar>
-void
+void 
 SparseCOO<Scalar>::setValue(size_t row, size_t column, Scalar value)
 {
 	if(row >= rows() )
@@ -210,6 +471,24 @@ SparseCOO<Scalar>::setValue(size_t row, size_t column, Scalar value)
 }
 
 
+template<typename Scalar>
+void 
+SparseCOO<Scalar>::addValue(size_t row, size_t column, Scalar value)
+{
+	if(row >= rows() )
+	{
+		throw LAException("SparseCOO::addValue(): row >= rows()" );
+	}
+	if(column >= columns() )
+	{
+		throw LAException("SparseCOO::addValue(): column >= columns()");
+	}
+
+	data.push_back(row, column, value);
+	data.repeated = true;
+}
+
+
 
 template<typename Scalar>
 Scalar & 
@@ -229,12 +508,10 @@ SparseCOO<Scalar>::operator() (size_t row, size_t column)
 
 
 template<typename Scalar>
-void
+void 
 SparseCOO<Scalar>::resize(size_t rows, size_t columns)
 {
-	using namespace std;
-
-	data.coordinate_list.clear();
+	data.clear();
 
 	data.n_rows = rows;
 	data.n_columns = columns;
@@ -242,17 +519,28 @@ SparseCOO<Scalar>::resize(size_t rows, size_t columns)
 
 
 template<typename Scalar>
-void
+void 
+SparseCOO<Scalar>::reserve(size_t nnz)
+{
+	data.row_index.reserve(nnz);
+	data.column_index.reserve(nnz);
+	data.values.reserve(nnz);
+}
+
+
+template<typename Scalar>
+void 
 SparseCOO<Scalar>::setEye()
 {
-	data.coordinate_list.clear();
+	data.clear();
 	auto n_elements = rows() < columns()? rows(): columns();
 
+	reserve(n_elements);
 	for(size_t k = 0; k < n_elements; k++)
 	{
-		typename Data::Coordinate c{k,k,(Scalar)1};
-		data.coordinate_list.push_back(c);
+		data.push_back(k, k, (Scalar)1);
 	}
+	data.n_sorted = n_elements;
 }
 
 
@@ -260,7 +548,7 @@ template<typename Scalar>
 size_t 
 SparseCOO<Scalar>::nnz() const
 {
-	return this->data.coordinate_list.size();
+	return this->data.values.size();
 }
 
 
@@ -268,17 +556,20 @@ template<typename Scalar>
 void 
 SparseCOO<Scalar>::permuteRows(size_t row1, size_t row2)
 {
-	for(auto it = data.coordinate_list.begin(); it != data.coordinate_list.end(); it++)
+	for(auto &i: data.row_index)
 	{
-		if( it->i == row1)
-		{
-			it->i = row2;
+		if( i == row1)
+		{	
+			i = row2;
 		}
-		else if( it->i == row2)
-		{
-			it->i = row1;
+		else if( i == row2)
+		{	
+			i = row1;
 		}
 	}
+
+	// permutations keep the coordinates unique, but not sorted
+	data.n_sorted = 0;
 }
 
 
@@ -286,17 +577,19 @@ template<typename Scalar>
 void 
 SparseCOO<Scalar>::permuteColumns(size_t column1, size_t column2)
 {
-	for(auto it = data.coordinate_list.begin(); it != data.coordinate_list.end(); it++)
+	for(auto &j: data.column_index)
 	{
-		if( it->j == column1)
-		{
-			it->j = column2;
+		if( j == column1)
+		{	
+			j = column2;
 		}
-		else if( it->j == column2)
-		{
-			it->j = column1;
+		else if( j == column2)
+		{	
+			j = column1;
 		}
 	}
+
+	data.n_sorted = 0;
 }
 
 
@@ -311,14 +604,51 @@ SparseCOO<Scalar>::symmetricReorder(std::vector<size_t> const & indices)
 		throw LAException("indices must match matrix size");
 	}
 
-	for(auto it = data.coordinate_list.begin(); it != data.coordinate_list.end(); it++)
+	for(size_t k = 0; k < data.values.size(); k++)
 	{
-		it->i = indices[it->i];
-		it->j = indices[it->j];
+		data.row_index[k] = indices[data.row_index[k]];
+		data.column_index[k] = indices[data.column_index[k]];
 	}
+
+	data.n_sorted = 0;
 }
 
 
+template<typename Scalar>
+template<typename Predicate, typename Shift>
+void 
+SparseCOO<Scalar>::splitOut(SparseCOO<Scalar> &other, Predicate predicate, Shift shift)
+{
+	size_t kept = 0, kept_sorted = 0, moved_sorted = 0;
+	for(size_t k = 0; k < data.values.size(); k++)
+	{
+		if( predicate(data.row_index[k], data.column_index[k]) )
+		{	
+			size_t i = data.row_index[k], j = data.column_index[k];
+			shift(i, j);
+			other.data.push_back(i, j, data.values[k]);
+			moved_sorted += (k < data.n_sorted);
+		}
+		else
+		{	
+			data.row_index[kept] = data.row_index[k];
+			data.column_index[kept] = data.column_index[k];
+			data.values[kept] = data.values[k];
+			kept++;
+			kept_sorted += (k < data.n_sorted);
+		}
+	}
+
+	data.row_index.resize(kept);
+	data.column_index.resize(kept);
+	data.values.resize(kept);
+
+	// both parts keep the relative order, and shifting all coordinates by a constant keeps it sorted
+	other.data.n_sorted = moved_sorted;
+	other.data.repeated = data.repeated;
+	data.n_sorted = kept_sorted;
+}
+
 
 template<typename Scalar>
 SparseCOO<Scalar> 
@@ -332,19 +662,9 @@ SparseCOO<Scalar>::splitOutBottom(std::size_t row_index)
 
 	SparseCOO<Scalar> bottom_matrix(this->rows()-row_index, this->columns());
 
-	for(typename std::list<typename Data::Coordinate>::iterator it = this->data.coordinate_list.begin(); it != this->data.coordinate_list.end();)
-	{
-		if( it->i >= row_index)
-		{
-			size_t new_row_index = it->i-row_index;
-			bottom_matrix.setValue(new_row_index, it->j, it->value);
-			data.coordinate_list.erase(it++);
-		}
-		else
-		{
-			it++;
-		}
-	}
+	splitOut(bottom_matrix,
+		[row_index](size_t i, size_t) { return i >= row_index; },
+		[row_index](size_t &i, size_t &) { i -= row_index; });
 
 	// fix row size
 	this->data.n_rows = row_index;
@@ -365,19 +685,9 @@ SparseCOO<Scalar>::splitOutRight(std::size_t column_index)
 
 	SparseCOO<Scalar> right_matrix(this->rows(), this->columns()-column_index);
 
-	for(typename std::list<typename Data::Coordinate>::iterator it = this->data.coordinate_list.begin(); it != this->data.coordinate_list.end();)
-	{
-		if( it->j >= column_index)
-		{
-			size_t new_column_index = it->j-column_index;
-			right_matrix.setValue(it->i, new_column_index, it->value);
-			data.coordinate_list.erase(it++);
-		}
-		else
-		{
-			it++;
-		}
-	}
+	splitOut(right_matrix,
+		[column_index](size_t, size_t j) { return j >= column_index; },
+		[column_index](size_t &, size_t &j) { j -= column_index; });
 
 	// fix column size
 	this->data.n_columns = column_index;
@@ -444,7 +444,7 @@ SparseCRS<Scalar>::resize(size_t rows, size_t columns)
 	data.column_index[0] = 0;
 	data.row_pointer[0] = 0;
 
-	for(size_t i = 1; i < rows; i++)
+	for(size_t i = 1; i <= rows; i++)
 	{
 		data.row_pointer[i] = 1;
 	}
@@ -1,9 +1,11 @@
 #ifndef MLA_MATRIX_STORAGE_POLICY_SPARSE_DOK_HPP
 #define MLA_MATRIX_STORAGE_POLICY_SPARSE_DOK_HPP
 
-#include <map>
+#include <utility>
+#include <vector>
 
 #include <mla/matrix/traits.h++>
+#include <mla/matrix/CoordinateMap.h++>
 #include <mla/LAException.h++>
 #include <mla/vector/SparseCS.h++>
 
@@ -16,7 +18,7 @@ namespace matrix
 /**
 SparseDOK: a storage policy class for the Matrix host class.
 This class implements the interface for the sparse Dictionary of Keys (DOK) 
-matrix format
+matrix format, with the elements stored in an open addressing hash map
 **/
 template<typename Scalar>
 class SparseDOK
@@ -32,7 +34,7 @@ public:
 		size_t	n_rows;		// number of rows
 		size_t	n_columns;	// number of columns
 
-		std::map< std::pair<size_t,size_t>, Scalar> 	key_value_map;
+		CoordinateMap<Scalar> 	key_value_map;
 		Scalar & getKeyReference(size_t i, size_t j)	{	return this->key_value_map[std::pair<size_t,size_t>(i,j)];	}
 	} data;
 
@@ -69,6 +71,11 @@ public:
 
 	void resize(size_t row, size_t column);
 
+	/**
+	 * Reserve memory for at least nnz-many elements
+	 **/
+	void reserve(size_t nnz)	{ data.key_value_map.reserve(nnz); }
+
 	/**
 	Sets ones on the main diagonal and zeros elsewhere
 	**/
@@ -128,8 +135,6 @@ template<typename Scalar>
 Scalar
 SparseDOK<Scalar>::getValue(size_t row, size_t column) const
 {
-	using namespace std;
-
 	if(row >= data.n_rows)
 	{
 		throw LAException("row >= rows()");
@@ -139,10 +144,7 @@ SparseDOK<Scalar>::getValue(size_t row, size_t column) const
 		throw LAException("column >= columns()");
 	}
 
-	typename map< std::pair<size_t,size_t>, Scalar>::const_iterator	i;
-
-	std::pair<size_t, size_t> key(row,column);
-	i = data.key_value_map.find(key);
+	auto i = data.key_value_map.find(std::pair<size_t, size_t>(row,column));
 	if(i == data.key_value_map.end())
 		return (Scalar)0;
 
@@ -227,29 +229,17 @@ template<typename Scalar>
 void 
 SparseDOK<Scalar>::permuteRows(size_t row1, size_t row2)
 {
-	typename std::map< std::pair<size_t, size_t>, Scalar> row1_elements, row2_elements;
+	if(row1 == row2)
+		return;
 
-	// Extract both rows 
-	for(auto it = data.key_value_map.begin(); it != data.key_value_map.end(); it++)
-	{
-		auto current_key = it->first;
-		if( current_key.first == row1)
-		{
-			current_key.first = row2;
-			row2_elements[current_key] = it->second;
-			data.key_value_map.erase(it);
-		}
-		else if( current_key.first == row2)
+	data.key_value_map.remap( [row1, row2](std::pair<size_t, size_t> key)
 		{
-			current_key.first = row1;
-			row1_elements[current_key] = it->second;
-			data.key_value_map.erase(it);
-		}
-	}
-
-	data.key_value_map.insert(row1_elements.begin(), row1_elements.end());
-	row1_elements.clear();	// free memory
-	data.key_value_map.insert(row2_elements.begin(), row2_elements.end());
+			if(key.first == row1)
+				key.first = row2;
+			else if(key.first == row2)
+				key.first = row1;
+			return key;
+		});
 }
 
 
@@ -257,29 +247,17 @@ template<typename Scalar>
 void 
 SparseDOK<Scalar>::permuteColumns(size_t column1, size_t column2)
 {
-	typename std::map< std::pair<size_t, size_t>, Scalar> column1_elements, column2_elements;
+	if(column1 == column2)
+		return;
 
-	// Extract both rows 
-	for(auto it = data.key_value_map.begin(); it != data.key_value_map.end(); it++)
-	{
-		auto current_key = it->first;
-		if( current_key.second == column1)
+	data.key_value_map.remap( [column1, column2](std::pair<size_t, size_t> key)
 		{
-			current_key.second = column2;
-			column2_elements[current_key] = it->second;
-			data.key_value_map.erase(it);
-		}
-		else if( current_key.second == column2)
-		{
-			current_key.second = column1;
-			column1_elements[current_key] = it->second;
-			data.key_value_map.erase(it);
-		}
-	}
-
-	data.key_value_map.insert(column1_elements.begin(), column1_elements.end());
-	column1_elements.clear();	// free memory
-	data.key_value_map.insert(column2_elements.begin(), column2_elements.end());
+			if(key.second == column1)
+				key.second = column2;
+			else if(key.second == column2)
+				key.second = column1;
+			return key;
+		});
 }
 
 
@@ -294,24 +272,10 @@ SparseDOK<Scalar>::symmetricReorder(std::vector<size_t> const & indices)
 		throw LAException("indices must match matrix size");
 	}
 
-	typename std::map< std::pair<size_t,size_t>, Scalar> new_kvm;
-	for( typename std::map< std::pair<size_t,size_t>, Scalar>::iterator it = data.key_value_map.begin(); it != data.key_value_map.end();)
-	{
-		std::pair<size_t, size_t> const & old_key = it->first;
-
-		// prepare new key
-		std::pair<size_t, size_t> new_key;
-		new_key.first = indices[old_key.first];
-		new_key.second = indices[old_key.second];
-
-		new_kvm[new_key] = it->second;
-
-		// 
-		data.key_value_map.erase(it++);
-	}
-
-	// updates the key
-	data.key_value_map = new_kvm;
+	data.key_value_map.remap( [&indices](std::pair<size_t, size_t> const &key)
+		{
+			return std::pair<size_t, size_t>(indices[key.first], indices[key.second]);
+		});
 }
 
 
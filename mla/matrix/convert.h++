@@ -3,19 +3,176 @@
 
 
 #include <cmath>        // std::abs
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 #include <mla/LAException.h++>
 
 #include <mla/matrix/all.h++>
+#include <mla/matrix/Assembler.h++>
+#include <mla/matrix/for_each_nonzero.h++>
 
 namespace mla
 {
+
+namespace detail
+{
+
+/**
+ * Compresses the elements of a SparseDOK matrix along the major index, with the minor
+ * indices sorted.  The keys are unique, so it takes a counting pass over the hash map,
+ * a scatter pass, and a sort of each row or column, which are usually short.
+ *@param major	selects the row (0) or the column (1) as the major index
+ */
+template<typename FromScalar, typename ToScalar>
+void
+compress_dok(matrix::SparseDOK<FromScalar> const &from, int major, size_t n_major, double interpret_as_zero_limit, std::vector<size_t> &pointer, std::vector<size_t> &index, std::vector<ToScalar> &values)
+{
+	auto const &map = from.data.key_value_map;
+	auto major_of = [major](std::pair<size_t, size_t> const &key) { return major == 0 ? key.first : key.second; };
+	auto minor_of = [major](std::pair<size_t, size_t> const &key) { return major == 0 ? key.second : key.first; };
+
+	pointer.assign(n_major+1, 0);
+	for(auto const &kv: map)
+	{
+		if( std::abs((ToScalar)kv.second) > interpret_as_zero_limit )
+		{
+			pointer[major_of(kv.first)+1]++;
+		}
+	}
+	for(size_t i = 0; i < n_major; i++)
+	{
+		pointer[i+1] += pointer[i];
+	}
+
+	index.resize(pointer[n_major]);
+	values.resize(pointer[n_major]);
+
+	std::vector<size_t> next(pointer.begin(), pointer.end()-1);
+	for(auto const &kv: map)
+	{
+		ToScalar const value = (ToScalar)kv.second;
+		if( std::abs(value) > interpret_as_zero_limit )
+		{
+			size_t const position = next[major_of(kv.first)]++;
+			index[position] = minor_of(kv.first);
+			values[position] = value;
+		}
+	}
+
+	std::vector< std::pair<size_t, ToScalar> > long_segment;
+	for(size_t i = 0; i < n_major; i++)
+	{
+		size_t const begin = pointer[i], end = pointer[i+1];
+
+		if(end - begin <= 32)
+		{
+			// insertion sort
+			for(size_t k = begin+1; k < end; k++)
+			{
+				size_t const minor = index[k];
+				ToScalar const value = values[k];
+
+				size_t t = k;
+				for(; t > begin && index[t-1] > minor; t--)
+				{
+					index[t] = index[t-1];
+					values[t] = values[t-1];
+				}
+				index[t] = minor;
+				values[t] = value;
+			}
+		}
+		else
+		{
+			long_segment.clear();
+			for(size_t k = begin; k < end; k++)
+			{
+				long_segment.push_back(std::make_pair(index[k], values[k]));
+			}
+			std::sort(long_segment.begin(), long_segment.end(), [](std::pair<size_t, ToScalar> const &a, std::pair<size_t, ToScalar> const &b) { return a.first < b.first; });
+			for(size_t k = begin; k < end; k++)
+			{
+				index[k] = long_segment[k-begin].first;
+				values[k] = long_segment[k-begin].second;
+			}
+		}
+	}
+}
+
+}	// namespace detail
+
+
 namespace matrix
 {
 
 
 /**
- * Generic routine to convert between any Matrix class, using only the generic interface
+ * Helper that sets the elements of the destination matrix of a conversion.
+ * By default each element is set through the matrix' operator().
+ */
+template<typename Scalar, template <typename> class ToMatrix>
+class ConvertWriter
+{
+protected:
+	ToMatrix<Scalar> &m_to;
+
+public:
+	ConvertWriter(ToMatrix<Scalar> &to, size_t , size_t )
+		: m_to(to)
+	{ }
+
+	void set(size_t i, size_t j, Scalar value)	{ m_to(i,j) = value; }
+
+	void finish()	{ }
+};
+
+
+/**
+ * Compressed formats gather the elements as triplets and build the whole matrix at the
+ * end, instead of shifting their arrays on every element insertion.
+ */
+template<typename Scalar>
+class ConvertWriter<Scalar, SparseCRS>
+{
+protected:
+	SparseCRS<Scalar> &m_to;
+	Assembler<Scalar> m_assembler;
+
+public:
+	ConvertWriter(SparseCRS<Scalar> &to, size_t rows, size_t columns)
+		: m_to(to), m_assembler(rows, columns)
+	{ }
+
+	void set(size_t i, size_t j, Scalar value)	{ m_assembler.add(i, j, value); }
+
+	void finish()	{ m_assembler.assemble(m_to); }
+};
+
+
+template<typename Scalar>
+class ConvertWriter<Scalar, SparseCCS>
+{
+protected:
+	SparseCCS<Scalar> &m_to;
+	Assembler<Scalar> m_assembler;
+
+public:
+	ConvertWriter(SparseCCS<Scalar> &to, size_t rows, size_t columns)
+		: m_to(to), m_assembler(rows, columns)
+	{ }
+
+	void set(size_t i, size_t j, Scalar value)	{ m_assembler.add(i, j, value); }
+
+	void finish()	{ m_assembler.assemble(m_to); }
+};
+
+
+
+/**
+ * Generic routine to convert between any Matrix class, reading the elements of from
+ * with for_each_nonzero and writing them through the generic interface
  *@param from	the origin matrix, which is to be converted to another format
  *@param to	the destination matrix, which is to be converted to another format
  *@param interpret_as_zero_limit	all elements that are below this number will be interpreted as null entries
@@ -24,38 +181,24 @@ template<typename FromScalar, template <typename> class FromMatrix, typename ToS
 void
 convert(FromMatrix<FromScalar> &from, ToMatrix<ToScalar> &to, double interpret_as_zero_limit = 0.0f)
 {
-	auto from_cursor = from.cursor();
-
 	interpret_as_zero_limit = std::abs(interpret_as_zero_limit);
 
 	// set the matrix size
 	to.resize( from.rows(), from.columns() );
 
-	// iterate over each row
-	size_t i;
-	size_t j;
-	while( !from_cursor.at_end_of_rows() )
-	{
-		i = from_cursor.current_row();
-		
-		// iterate over each element in the row
-		while( !from_cursor.at_end_of_current_row() )
-		{
-			ToScalar value = (ToScalar)from_cursor.element();
-
-			if( value > interpret_as_zero_limit)
-			{
-				j = from_cursor.current_column();
+	ConvertWriter<ToScalar, ToMatrix> writer(to, from.rows(), from.columns());
 
-				to(i,j) = (ToScalar)from_cursor.element();
-			}
+	for_each_nonzero(from, [interpret_as_zero_limit, &writer](size_t i, size_t j, FromScalar from_value)
+	{
+		ToScalar value = (ToScalar)from_value;
 
-			from_cursor.increment_column();
+		if( std::abs(value) > interpret_as_zero_limit)
+		{
+			writer.set(i, j, value);
 		}
+	});
 
-		// move to next non-null element in the next row
-		from_cursor.start_next_row_nn();
-	}
+	writer.finish();
 }
 
 
@@ -71,17 +214,48 @@ convert(SparseDOK<FromScalar> &from, ToMatrix<ToScalar> &to, double interpret_as
 {
 	interpret_as_zero_limit = std::abs(interpret_as_zero_limit);
 	
-	size_t row, column;
-	for(typename std::map< size_t, FromScalar>::const_iterator iter = from.data.key_value_map.begin(); iter != from.data.key_value_map.end(); iter++)
+	ConvertWriter<ToScalar, ToMatrix> writer(to, from.rows(), from.columns());
+
+	for(auto iter = from.data.key_value_map.begin(); iter != from.data.key_value_map.end(); iter++)
 	{
-		const ToScalar &value =  iter->second;
+		ToScalar const value = (ToScalar)iter->second;
 		if( std::abs(value) > interpret_as_zero_limit )
 		{
-			row = iter->first % from.columns();
-			column = iter->first - row*from.columns();
-			to(row, column) = (ToScalar)value;
+			writer.set(iter->first.first, iter->first.second, value);
 		}
 	}
+
+	writer.finish();
+}
+
+
+/**
+ * Conversion from a SparseDOK matrix to a SparseCRS matrix
+ *@param from	the origin matrix, which is a SparseDOK data structure
+ *@param to	the destination matrix
+ *@param interpret_as_zero_limit	all elements that are below this number will be interpreted as null entries
+ */
+template<typename FromScalar, typename ToScalar>
+void
+convert(SparseDOK<FromScalar> &from, SparseCRS<ToScalar> &to, double interpret_as_zero_limit = 0.0f)
+{
+	to.data.n_columns = from.columns();
+	detail::compress_dok(from, 0, from.rows(), std::abs(interpret_as_zero_limit), to.data.row_pointer, to.data.column_index, to.data.values);
+}
+
+
+/**
+ * Conversion from a SparseDOK matrix to a SparseCCS matrix
+ *@param from	the origin matrix, which is a SparseDOK data structure
+ *@param to	the destination matrix
+ *@param interpret_as_zero_limit	all elements that are below this number will be interpreted as null entries
+ */
+template<typename FromScalar, typename ToScalar>
+void
+convert(SparseDOK<FromScalar> &from, SparseCCS<ToScalar> &to, double interpret_as_zero_limit = 0.0f)
+{
+	to.data.n_rows = from.rows();
+	detail::compress_dok(from, 1, from.columns(), std::abs(interpret_as_zero_limit), to.data.column_pointer, to.data.row_index, to.data.values);
 }
 
 
@@ -97,15 +271,109 @@ convert(SparseCOO<FromScalar> &from, ToMatrix<ToScalar> &to, double interpret_as
 {
 	interpret_as_zero_limit = std::abs(interpret_as_zero_limit);
 	
-	size_t row, column;
-	for(typename std::list< typename SparseCOO<FromScalar>::Data::Coordinate>::const_iterator iter = from.data.coordinate_list.begin(); iter != from.data.coordinate_list.end(); iter++)
+	ConvertWriter<ToScalar, ToMatrix> writer(to, from.rows(), from.columns());
+
+	// repeated coordinates must be summed before they are set
+	from.compress();
+
+	for(size_t k = 0; k < from.data.values.size(); k++)
+	{
+		ToScalar const value = (ToScalar)from.data.values[k];
+		if( std::abs(value) > interpret_as_zero_limit )
+		{
+			writer.set(from.data.row_index[k], from.data.column_index[k], value);
+		}
+	}
+
+	writer.finish();
+}
+
+
+/**
+ * Conversion from a SparseCOO matrix to a SparseCRS matrix.  Once compressed the elements
+ * are already in row-major order, so the arrays are copied in a single pass.
+ *@param from	the origin matrix, which is a SparseCOO data structure
+ *@param to	the destination matrix
+ *@param interpret_as_zero_limit	all elements that are below this number will be interpreted as null entries
+ */
+template<typename FromScalar, typename ToScalar>
+void
+convert(SparseCOO<FromScalar> &from, SparseCRS<ToScalar> &to, double interpret_as_zero_limit = 0.0f)
+{
+	interpret_as_zero_limit = std::abs(interpret_as_zero_limit);
+
+	from.compress();
+
+	size_t const n = from.data.values.size();
+
+	to.data.n_columns = from.columns();
+	to.data.row_pointer.assign(from.rows()+1, 0);
+	to.data.column_index.clear();
+	to.data.values.clear();
+	to.data.column_index.reserve(n);
+	to.data.values.reserve(n);
+
+	for(size_t k = 0; k < n; k++)
+	{
+		ToScalar const value = (ToScalar)from.data.values[k];
+		if( std::abs(value) > interpret_as_zero_limit )
+		{
+			to.data.row_pointer[from.data.row_index[k]+1]++;
+			to.data.column_index.push_back(from.data.column_index[k]);
+			to.data.values.push_back(value);
+		}
+	}
+
+	for(size_t i = 0; i < from.rows(); i++)
+	{
+		to.data.row_pointer[i+1] += to.data.row_pointer[i];
+	}
+}
+
+
+/**
+ * Conversion from a SparseCOO matrix to a SparseCCS matrix, scattering the compressed
+ * elements by column, which keeps the row indices of each column sorted
+ *@param from	the origin matrix, which is a SparseCOO data structure
+ *@param to	the destination matrix
+ *@param interpret_as_zero_limit	all elements that are below this number will be interpreted as null entries
+ */
+template<typename FromScalar, typename ToScalar>
+void
+convert(SparseCOO<FromScalar> &from, SparseCCS<ToScalar> &to, double interpret_as_zero_limit = 0.0f)
+{
+	interpret_as_zero_limit = std::abs(interpret_as_zero_limit);
+
+	from.compress();
+
+	size_t const n = from.data.values.size();
+
+	to.data.n_rows = from.rows();
+	to.data.column_pointer.assign(from.columns()+1, 0);
+	for(size_t k = 0; k < n; k++)
+	{
+		if( std::abs((ToScalar)from.data.values[k]) > interpret_as_zero_limit )
+		{
+			to.data.column_pointer[from.data.column_index[k]+1]++;
+		}
+	}
+	for(size_t j = 0; j < from.columns(); j++)
+	{
+		to.data.column_pointer[j+1] += to.data.column_pointer[j];
+	}
+
+	to.data.row_index.resize(to.data.column_pointer.back());
+	to.data.values.resize(to.data.column_pointer.back());
+
+	std::vector<size_t> next(to.data.column_pointer.begin(), to.data.column_pointer.end()-1);
+	for(size_t k = 0; k < n; k++)
 	{
-		ToScalar const value =  iter->value;
+		ToScalar const value = (ToScalar)from.data.values[k];
 		if( std::abs(value) > interpret_as_zero_limit )
 		{
-			row = iter->i;
-			column = iter->j;
-			to(row, column) = (ToScalar)value;
+			size_t const position = next[from.data.column_index[k]]++;
+			to.data.row_index[position] = from.data.row_index[k];
+			to.data.values[position] = value;
 		}
 	}
 }
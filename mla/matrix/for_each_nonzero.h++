@@ -0,0 +1,181 @@
+#ifndef MLA_MATRIX_FOR_EACH_NONZERO_HPP
+#define MLA_MATRIX_FOR_EACH_NONZERO_HPP
+
+#include <algorithm>
+
+#include <mla/matrix/all.h++>
+
+
+namespace mla
+{
+namespace matrix
+{
+
+/**
+for_each_nonzero: compile-time dispatched traversal of the stored elements of a matrix.
+
+Calls f(i, j, value) for each element stored in the rows [row_begin, row_end) of A.
+Every storage policy has its own overload, which walks the storage arrays directly,
+so f is inlined in the loop instead of being reached through the virtual calls of a
+MatrixCursor.  row_end is clamped to A.rows().
+
+Elements are visited in storage order: row by row for SparseCRS and
+StaticDenseRowMajor, column by column for SparseCCS and DenseRowMajor (which is
+stored column-major), and in no particular order for SparseDOK and SparseCOO.  Dense
+storages visit every element, zeros included.  A SparseCOO that wasn't compressed may
+visit the same coordinates more than once, with values that add up to the element.
+**/
+template<typename Scalar, typename Function>
+void
+for_each_nonzero(SparseCRS<Scalar> const &A, size_t row_begin, size_t row_end, Function f)
+{
+	size_t const *row_pointer = A.data.row_pointer.data();
+	size_t const *column_index = A.data.column_index.data();
+	Scalar const *values = A.data.values.data();
+
+	row_end = std::min(row_end, A.rows());
+	for(size_t i = row_begin; i < row_end; i++)
+	{
+		for(size_t k = row_pointer[i]; k < row_pointer[i+1]; k++)
+		{
+			f(i, column_index[k], values[k]);
+		}
+	}
+}
+
+
+template<typename Scalar, typename Function>
+void
+for_each_nonzero(SparseCCS<Scalar> const &A, size_t row_begin, size_t row_end, Function f)
+{
+	size_t const *column_pointer = A.data.column_pointer.data();
+	size_t const *row_index = A.data.row_index.data();
+	Scalar const *values = A.data.values.data();
+
+	row_end = std::min(row_end, A.rows());
+	if(row_begin == 0 && row_end == A.rows())
+	{
+		for(size_t j = 0; j < A.columns(); j++)
+		{
+			for(size_t k = column_pointer[j]; k < column_pointer[j+1]; k++)
+			{
+				f(row_index[k], j, values[k]);
+			}
+		}
+		return;
+	}
+
+	for(size_t j = 0; j < A.columns(); j++)
+	{
+		for(size_t k = column_pointer[j]; k < column_pointer[j+1]; k++)
+		{
+			size_t const i = row_index[k];
+			if(i >= row_begin && i < row_end)
+			{
+				f(i, j, values[k]);
+			}
+		}
+	}
+}
+
+
+template<typename Scalar, typename Function>
+void
+for_each_nonzero(Diagonal<Scalar> const &A, size_t row_begin, size_t row_end, Function f)
+{
+	Scalar const *diagonal = A.data.data.data();
+
+	row_end = std::min(row_end, A.data.data.size());
+	for(size_t i = row_begin; i < row_end; i++)
+	{
+		f(i, i, diagonal[i]);
+	}
+}
+
+
+template<typename Scalar, typename Function>
+void
+for_each_nonzero(DenseRowMajor<Scalar> const &A, size_t row_begin, size_t row_end, Function f)
+{
+	size_t const n_rows = A.data.n_rows;
+	Scalar const *elements = A.data.element_vector.data();
+
+	row_end = std::min(row_end, A.rows());
+	for(size_t j = 0; j < A.columns(); j++)
+	{
+		Scalar const *column = elements + n_rows*j;
+		for(size_t i = row_begin; i < row_end; i++)
+		{
+			f(i, j, column[i]);
+		}
+	}
+}
+
+
+template<typename Scalar, size_t static_rows, size_t static_columns, typename Function>
+void
+for_each_nonzero(StaticDenseRowMajor<Scalar, static_rows, static_columns> const &A, size_t row_begin, size_t row_end, Function f)
+{
+	Scalar const *elements = A.data.data();
+
+	row_end = std::min(row_end, static_rows);
+	for(size_t i = row_begin; i < row_end; i++)
+	{
+		Scalar const *row = elements + static_columns*i;
+		for(size_t j = 0; j < static_columns; j++)
+		{
+			f(i, j, row[j]);
+		}
+	}
+}
+
+
+template<typename Scalar, typename Function>
+void
+for_each_nonzero(SparseDOK<Scalar> const &A, size_t row_begin, size_t row_end, Function f)
+{
+	for(auto const &entry: A.data.key_value_map)
+	{
+		size_t const i = entry.first.first;
+		if(i >= row_begin && i < row_end)
+		{
+			f(i, entry.first.second, entry.second);
+		}
+	}
+}
+
+
+template<typename Scalar, typename Function>
+void
+for_each_nonzero(SparseCOO<Scalar> const &A, size_t row_begin, size_t row_end, Function f)
+{
+	size_t const *row_index = A.data.row_index.data();
+	size_t const *column_index = A.data.column_index.data();
+	Scalar const *values = A.data.values.data();
+
+	for(size_t k = 0; k < A.data.values.size(); k++)
+	{
+		size_t const i = row_index[k];
+		if(i >= row_begin && i < row_end)
+		{
+			f(i, column_index[k], values[k]);
+		}
+	}
+}
+
+
+/**
+ * Calls f(i, j, value) for each element stored in A
+ **/
+template<typename Matrix, typename Function>
+void
+for_each_nonzero(Matrix const &A, Function f)
+{
+	for_each_nonzero(A, 0, A.rows(), f);
+}
+
+
+}	// namespace matrix
+}	// namespace mla
+
+#endif
@@ -105,7 +105,7 @@ StaticDenseRowMajor<Scalar, static_rows, static_columns>::getValue(size_t row, s
 		throw LAException("StaticDenseRowMajor::getValue: column < this->columns()");
 	}
 
-	return this->data[row*this->rows() + column];
+	return this->data[row*this->columns() + column];
 }
 
 
@@ -123,7 +123,7 @@ StaticDenseRowMajor<Scalar, static_rows, static_columns>::setValue(size_t row, s
 		throw LAException("StaticDenseRowMajor::setValue() column >= this->columns()");
 	}
 
-	this->data[row*this->rows() + column] = value;
+	this->data[row*this->columns() + column] = value;
 }
 
 
@@ -141,7 +141,7 @@ Scalar
 		throw LAException("StaticDenseRowMajor::operator() column < this->columns()");
 	}
 
-	return this->data[row*this->rows() + column];
+	return this->data[row*this->columns() + column];
 }
 
 
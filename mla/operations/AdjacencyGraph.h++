@@ -0,0 +1,219 @@
+#ifndef MLA_OPERATIONS_ADJACENCY_GRAPH_HPP
+#define MLA_OPERATIONS_ADJACENCY_GRAPH_HPP
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <mla/LAException.h++>
+
+#include <mla/matrix/SparseDOK.h++>
+#include <mla/matrix/SparseCRS.h++>
+#include <mla/matrix/SparseCCS.h++>
+
+
+namespace mla {
+
+namespace detail
+{
+
+/**
+ * Calls edge(row, column) for each entry stored in a pattern.  The edge functor is a
+ * template parameter, so that it is inlined in the O(nnz) loops of
+ * AdjacencyGraph::build().
+ **/
+template<typename Scalar, typename Edge>
+void
+for_each_pattern_entry(matrix::SparseCRS<Scalar> const &A, Edge edge)
+{
+	auto const &pattern = A.data;
+	for(size_t i = 0; i+1 < pattern.row_pointer.size(); i++)
+	{
+		for(size_t k = pattern.row_pointer[i]; k < pattern.row_pointer[i+1]; k++)
+		{
+			edge(i, pattern.column_index[k]);
+		}
+	}
+}
+
+
+template<typename Scalar, typename Edge>
+void
+for_each_pattern_entry(matrix::SparseCCS<Scalar> const &A, Edge edge)
+{
+	auto const &pattern = A.data;
+	for(size_t j = 0; j+1 < pattern.column_pointer.size(); j++)
+	{
+		for(size_t k = pattern.column_pointer[j]; k < pattern.column_pointer[j+1]; k++)
+		{
+			edge(pattern.row_index[k], j);
+		}
+	}
+}
+
+
+/**
+ * Visits a list of (row, column) coordinates in order
+ **/
+template<typename Edge>
+void
+for_each_pattern_entry(std::vector< std::pair<size_t, size_t> > const &keys, Edge edge)
+{
+	for(auto const &key: keys)
+	{
+		edge(key.first, key.second);
+	}
+}
+
+}	// namespace detail
+
+
+/**
+ * Undirected graph of the sparsity pattern of a square matrix, where vertices i and j
+ * are adjacent if A(i,j) or A(j,i) is stored.  Self loops are dropped.  The graph is
+ * stored in compressed form: the neighbours of vertex i are
+ * data.index[data.pointer[i]] ... data.index[data.pointer[i+1]-1].
+ **/
+class AdjacencyGraph
+{
+public:
+	struct Data
+	{
+		std::vector<size_t> pointer;
+		std::vector<size_t> index;
+	} data;
+
+public:
+	AdjacencyGraph()	{ data.pointer.assign(1, 0); }
+
+	template<typename Scalar>
+	explicit AdjacencyGraph(matrix::SparseCRS<Scalar> const &A);
+
+	template<typename Scalar>
+	explicit AdjacencyGraph(matrix::SparseCCS<Scalar> const &A);
+
+	template<typename Scalar>
+	explicit AdjacencyGraph(matrix::SparseDOK<Scalar> const &A);
+
+	size_t size() const	{ return data.pointer.size()-1; }
+
+	/**
+	 * Returns the number of edges, counting each one once per endpoint
+	 **/
+	size_t edges() const	{ return data.index.size(); }
+
+	size_t degree(size_t vertex) const	{ return data.pointer[vertex+1] - data.pointer[vertex]; }
+
+protected:
+	/**
+	 * Builds the graph from the coordinates of a n-by-n pattern, in O(n + nnz)
+	 *@param pattern	visited with detail::for_each_pattern_entry()
+	 */
+	template<typename Pattern>
+	void build(size_t n, Pattern const &pattern);
+};
+
+
+
+template<typename Scalar>
+AdjacencyGraph::AdjacencyGraph(matrix::SparseCRS<Scalar> const &A)
+{
+	if( !A.isSquare() )
+	{
+		throw LAException("AdjacencyGraph: A must be a square matrix");
+	}
+
+	build(A.rows(), A);
+}
+
+
+template<typename Scalar>
+AdjacencyGraph::AdjacencyGraph(matrix::SparseCCS<Scalar> const &A)
+{
+	if( !A.isSquare() )
+	{
+		throw LAException("AdjacencyGraph: A must be a square matrix");
+	}
+
+	build(A.columns(), A);
+}
+
+
+template<typename Scalar>
+AdjacencyGraph::AdjacencyGraph(matrix::SparseDOK<Scalar> const &A)
+{
+	if( !A.isSquare() )
+	{
+		throw LAException("AdjacencyGraph: A must be a square matrix");
+	}
+
+	// the hash map has no order, so the keys are sorted to keep the graph deterministic
+	std::vector< std::pair<size_t, size_t> > keys;
+	keys.reserve(A.data.key_value_map.size());
+	for(auto const &kv: A.data.key_value_map)
+	{
+		keys.push_back(kv.first);
+	}
+	std::sort(keys.begin(), keys.end());
+
+	build(A.rows(), keys);
+}
+
+
+template<typename Pattern>
+void
+AdjacencyGraph::build(size_t n, Pattern const &pattern)
+{
+	// count the edges of each vertex, both directions
+	data.pointer.assign(n+1, 0);
+	detail::for_each_pattern_entry(pattern, [this](size_t i, size_t j)
+		{
+			if(i != j)
+			{
+				data.pointer[i+1]++;
+				data.pointer[j+1]++;
+			}
+		});
+
+	for(size_t i = 0; i < n; i++)
+	{
+		data.pointer[i+1] += data.pointer[i];
+	}
+
+	std::vector<size_t> next(data.pointer.begin(), data.pointer.end()-1);
+	data.index.resize(data.pointer[n]);
+	detail::for_each_pattern_entry(pattern, [this, &next](size_t i, size_t j)
+		{
+			if(i != j)
+			{
+				data.index[ next[i]++ ] = j;
+				data.index[ next[j]++ ] = i;
+			}
+		});
+
+	// drop duplicate edges, such as the ones from symmetric entries
+	std::vector<size_t> mark(n, n);
+	size_t position = 0;
+	for(size_t i = 0; i < n; i++)
+	{
+		size_t const begin = data.pointer[i];
+		data.pointer[i] = position;
+
+		for(size_t k = begin; k < data.pointer[i+1]; k++)
+		{
+			size_t const j = data.index[k];
+			if(mark[j] != i)
+			{
+				mark[j] = i;
+				data.index[position++] = j;
+			}
+		}
+	}
+	data.pointer[n] = position;
+	data.index.resize(position);
+}
+
+
+}	// namespace mla
+
+#endif
@@ -1,14 +1,13 @@
 #ifndef MLA_OPERATIONS_CUTHILL_MCKEE_HPP
 #define MLA_OPERATIONS_CUTHILL_MCKEE_HPP
 
-#include <type_traits>
-#include <list>
 #include <vector>
 #include <algorithm>
 
 #include <mla/LAException.h++>
 
 #include <mla/matrix/all.h++>
+#include <mla/operations/AdjacencyGraph.h++>
 
 
 namespace mla {
@@ -16,97 +15,229 @@ namespace mla {
 /**
  * Implementation of Cuthill-McKee algorithms
  *
+ * The orderings are returned as a permutation vector, where index[k] is the row/column
+ * of A placed in position k.  Each connected component of the graph of A is traversed
+ * breadth-first from a pseudo-peripheral vertex, visiting the neighbours of each vertex
+ * by increasing degree.  The whole ordering costs O(n + nnz).
  **/
 
-template<typename Scalar>
-std::vector<size_t>
-cuthill_mckee(mla::matrix::SparseDOK<Scalar> const &A)
+
+namespace detail {
+
+/**
+ * Returns the neighbours of every vertex sorted by increasing degree, with the layout
+ * of graph.data.index.  Two passes of a counting sort keep it linear in the graph size.
+ **/
+inline std::vector<size_t>
+neighbours_by_degree(AdjacencyGraph const &graph)
 {
-	// matrix A must be a square matrix
-	if( !A.isSquare() )
+	size_t const n = graph.size();
+	auto const &pointer = graph.data.pointer;
+	auto const &index = graph.data.index;
+
+	// sort every edge (i,j) by the degree of j
+	std::vector<size_t> count(n+1, 0);
+	for(size_t j: index)
+	{
+		count[graph.degree(j)]++;
+	}
+	size_t sum = 0;
+	for(auto &c: count)
 	{
-		throw LAException("A must be a square matrix");
+		size_t const c_old = c;
+		c = sum;
+		sum += c_old;
 	}
-	
-	size_t A_size = A.rows();
-
-	//calculate the degree of each vertex
-	class Element {
-		size_t m_index;
-		size_t m_degree;
-
-	public:
-		Element(size_t index, size_t degree = 0) 
-			: m_index(index), m_degree(degree)
-		{ };
-
-		/**
-		 * order operator that imposes the Cuthill-McKee order
-		 */
-		bool operator<(Element const &rhs) const
+
+	std::vector<size_t> source(index.size()), target(index.size());
+	for(size_t i = 0; i < n; i++)
+	{
+		for(size_t k = pointer[i]; k < pointer[i+1]; k++)
 		{
-			return this->m_degree > rhs.getDegree();
+			size_t const position = count[graph.degree(index[k])]++;
+			source[position] = i;
+			target[position] = index[k];
 		}
+	}
+
+	// stable scatter back to each vertex
+	std::vector<size_t> next(pointer.begin(), pointer.end()-1);
+	std::vector<size_t> sorted(index.size());
+	for(size_t k = 0; k < source.size(); k++)
+	{
+		sorted[ next[source[k]]++ ] = target[k];
+	}
+
+	return sorted;
+}
+
+
+/**
+ * Breadth-first traversal of the component of root, restricted to the vertices whose
+ * mark differs from stamp.  Visited vertices get the stamp and are appended to queue.
+ *@return	the position in queue where the last level starts
+ **/
+inline size_t
+breadth_first_levels(AdjacencyGraph const &graph, std::vector<size_t> const &neighbours, size_t root, std::vector<size_t> &mark, size_t stamp, std::vector<size_t> &queue, size_t &levels)
+{
+	auto const &pointer = graph.data.pointer;
 
-		bool operator==(Element const &rhs) const
+	queue.clear();
+	queue.push_back(root);
+	mark[root] = stamp;
+
+	size_t level_begin = 0;
+	levels = 0;
+	while(level_begin < queue.size())
+	{
+		size_t const level_end = queue.size();
+		for(size_t q = level_begin; q < level_end; q++)
 		{
-			if (this->m_index != rhs.getIndex()) 
-				return false;
-			if (this->m_degree != rhs.getDegree())
-				return false;
-			return true;
+			size_t const i = queue[q];
+			for(size_t k = pointer[i]; k < pointer[i+1]; k++)
+			{
+				size_t const j = neighbours[k];
+				if(mark[j] != stamp)
+				{
+					mark[j] = stamp;
+					queue.push_back(j);
+				}
+			}
 		}
+		levels++;
 
-		/**
-		 * helper function that increments the degree
-		 **/
-		void incrementDegree() {this->m_degree++;};
+		if(queue.size() == level_end)
+			break;
+		level_begin = level_end;
+	}
+
+	return level_begin;
+}
+
+}	// namespace detail
 
-		size_t getIndex() const {return this->m_index;};
-		size_t getDegree() const {return this->m_degree;};
-	};
 
+/**
+ * Cuthill-McKee ordering of the graph of a symmetric sparsity pattern
+ **/
+inline std::vector<size_t>
+cuthill_mckee(AdjacencyGraph const &graph)
+{
+	size_t const n = graph.size();
+	auto const &pointer = graph.data.pointer;
 
-	std::list<Element> adjacency;
+	std::vector<size_t> const neighbours = detail::neighbours_by_degree(graph);
 
-	// init adjacency data structure
-	for(size_t i = 0; i < A_size; i++)
+	// vertices by increasing degree, to pick a low degree vertex of each component
+	std::vector<size_t> count(n+1, 0);
+	for(size_t i = 0; i < n; i++)
 	{
-		adjacency.push_back( Element(i) );
+		count[graph.degree(i)+1]++;
 	}
-
-	// calculate the degree of each vertex
-	for(auto &kv: A.data.key_value_map)
+	for(size_t d = 0; d < n; d++)
+	{
+		count[d+1] += count[d];
+	}
+	std::vector<size_t> by_degree(n);
+	for(size_t i = 0; i < n; i++)
 	{
-		size_t key = kv.first.first;	// kv.first is object of type pair<size_t,size_t>(i,j)
+		by_degree[ count[graph.degree(i)]++ ] = i;
+	}
 
-		auto compare_predicate = [&](Element const &e) {return e.getIndex() == key;};
-		typename std::list<Element>::iterator it = std::find_if(adjacency.begin(), adjacency.end(), compare_predicate);
+	// mark[i] == 0 flags vertices already placed in the ordering
+	std::vector<size_t> mark(n, 1);
+	size_t stamp = 1;
+	std::vector<size_t> queue, candidate_queue;
+	queue.reserve(n);
+	candidate_queue.reserve(n);
+
+	std::vector<size_t> index;
+	index.reserve(n);
+
+	for(size_t root: by_degree)
+	{
+		if(mark[root] == 0)
+			continue;
 
-		if(it == adjacency.end())
+		// find a pseudo-peripheral vertex by repeated traversals (George and Liu)
+		size_t levels;
+		size_t last_level = detail::breadth_first_levels(graph, neighbours, root, mark, ++stamp, queue, levels);
+		for(;;)
 		{
-			throw LAException("Key doesn''t exist");
+			size_t candidate = queue[last_level];
+			for(size_t q = last_level+1; q < queue.size(); q++)
+			{
+				if(graph.degree(queue[q]) < graph.degree(candidate))
+					candidate = queue[q];
+			}
+
+			size_t candidate_levels;
+			size_t candidate_last_level = detail::breadth_first_levels(graph, neighbours, candidate, mark, ++stamp, candidate_queue, candidate_levels);
+			if(candidate_levels <= levels)
+				break;
+
+			root = candidate;
+			levels = candidate_levels;
+			last_level = candidate_last_level;
+			queue.swap(candidate_queue);
 		}
 
-		it->incrementDegree();
+		// Cuthill-McKee traversal from root
+		size_t head = index.size();
+		index.push_back(root);
+		mark[root] = 0;
+		while(head < index.size())
+		{
+			size_t const i = index[head++];
+			for(size_t k = pointer[i]; k < pointer[i+1]; k++)
+			{
+				size_t const j = neighbours[k];
+				if(mark[j] != 0)
+				{
+					mark[j] = 0;
+					index.push_back(j);
+				}
+			}
+		}
 	}
-	
-	// reorder adjacency list based on degree
-	adjacency.sort();
 
-	// assign index to vector to output
-	std::vector<size_t> index;
-	index.reserve(adjacency.size());
-	for(auto &e: adjacency)
-	{
-		index.push_back( e.getIndex() );
-	}
+	return index;
+}
 
 
+/**
+ * Reverse Cuthill-McKee ordering, which usually has a smaller profile than the
+ * Cuthill-McKee ordering and therefore less fill-in
+ **/
+inline std::vector<size_t>
+reverse_cuthill_mckee(AdjacencyGraph const &graph)
+{
+	std::vector<size_t> index = cuthill_mckee(graph);
+	std::reverse(index.begin(), index.end());
 	return index;
 }
 
 
+/**
+ * Cuthill-McKee ordering of the sparsity pattern of A, symmetrized if needed.
+ * Supports SparseDOK, SparseCRS and SparseCCS matrices.
+ **/
+template<typename Scalar, template<typename> class MatrixStoragePolicy>
+std::vector<size_t>
+cuthill_mckee(MatrixStoragePolicy<Scalar> const &A)
+{
+	return cuthill_mckee( AdjacencyGraph(A) );
+}
+
+
+template<typename Scalar, template<typename> class MatrixStoragePolicy>
+std::vector<size_t>
+reverse_cuthill_mckee(MatrixStoragePolicy<Scalar> const &A)
+{
+	return reverse_cuthill_mckee( AdjacencyGraph(A) );
+}
+
+
 }	// mla
 
 #endif
@@ -5,6 +5,7 @@
 #include <cmath>
 
 #include <mla/vector/all.h++>
+#include <mla/vector/for_each_nonzero.h++>
 
 
 namespace mla {
@@ -19,16 +20,11 @@ template<typename Scalar, template<typename> class VectorStoragePolicyX>
 Scalar 
 asum(VectorStoragePolicyX<Scalar> &x)
 {
-	typename VectorStoragePolicyX<Scalar>::Cursor cursor = x.cursor();
-	cursor.reset();
-
 	Scalar absolute_sum = 0.0f;	// implicit value
-	while(!cursor.at_end())
+	vector::for_each_nonzero(x, [&absolute_sum](size_t, Scalar value)
 	{
-		Scalar value = cursor.element();
-		absolute_sum += abs(value);
-		cursor.next();
-	}
+		absolute_sum += std::abs(value);
+	});
 
 	return absolute_sum;
 }
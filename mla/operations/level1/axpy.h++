@@ -3,7 +3,10 @@
 
 #include <type_traits>
 
+#include <mla/LAException.h++>
+
 #include <mla/vector/all.h++>
+#include <mla/vector/for_each_nonzero.h++>
 
 namespace mla {
 
@@ -19,30 +22,35 @@ template<typename Scalar, template<typename> class VectorStoragePolicyX, templat
 void 
 axpy(Scalar const a, VectorStoragePolicyX<Scalar> &x, VectorStoragePolicyY<Scalar> &y)
 {
-	typename VectorStoragePolicyX<Scalar>::Cursor cursor = x.cursor();
-	cursor.reset();
-
-	while(!cursor.at_end())
+	if( x.size() != y.size() )
 	{
-		size_t i = cursor.current();
-		Scalar temp = y.getValue(i);
-		y.setValue(i, temp + cursor.element()*a);
-		cursor.next();
+		throw LAException("level1::axpy: incompatible vector size");
 	}
-}
-
 
+	vector::for_each_nonzero(x, [a, &y](size_t i, Scalar value)
+	{
+		y.setValue(i, y.getValue(i) + value*a);
+	});
+}
 
-// explicit instantiation
 
-template<typename Scalar>
+/**
+ * axpy with a dense y, which is updated in place
+ **/
+template<typename Scalar, template<typename> class VectorStoragePolicyX>
 void 
-axpy(Scalar const a, mla::vector::Dense<Scalar> &x, mla::vector::Dense<Scalar> &y)
+axpy(Scalar const a, VectorStoragePolicyX<Scalar> &x, mla::vector::Dense<Scalar> &y)
 {
-	for(size_t i = 0; i < y.size(); i++)
+	if( x.size() != y.size() )
 	{
-		y[i] += a*x[i];
+		throw LAException("level1::axpy: incompatible vector size");
 	}
+
+	Scalar *y_values = y.data.data();
+	vector::for_each_nonzero(x, [a, y_values](size_t i, Scalar value)
+	{
+		y_values[i] += a*value;
+	});
 }
 
 
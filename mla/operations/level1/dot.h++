@@ -6,6 +6,7 @@
 #include <mla/LAException.h++>
 
 #include <mla/vector/all.h++>
+#include <mla/vector/for_each_nonzero.h++>
 
 namespace mla {
 
@@ -23,36 +24,11 @@ dot(VectorStoragePolicyX<Scalar> &x, VectorStoragePolicyY<Scalar> &y)
 		throw LAException("level1::dot: incompatible vector size");
 	}
 
-	typename VectorStoragePolicyX<Scalar>::Cursor cursorx = x.cursor();
-	typename VectorStoragePolicyY<Scalar>::Cursor cursory = y.cursor();
-
-	cursorx.reset();
-	cursory.reset();
-
 	Scalar accumulator = 0.0f;
-
-	size_t x_i = cursorx.current();
-	size_t y_i = cursory.current();
-
-	while( ! (cursorx.at_end() || cursory.at_end() ) )
+	vector::for_each_nonzero(x, [&accumulator, &y](size_t i, Scalar value)
 	{
-		if(x_i == y_i)
-		{
-			accumulator += cursorx.element()*cursory.element();
-			cursorx.next();
-			cursory.next();
-		}
-		else if (x_i > y_i)
-		{
-			cursory.next();
-			y_i = cursory.current();
-		}
-		else
-		{
-			cursorx.next();
-			x_i = cursorx.current();
-		}
-	}
+		accumulator += value*y.getValue(i);
+	});
 
 	return accumulator;
 }
@@ -67,18 +43,63 @@ dot(VectorStoragePolicyX<Scalar> &x, vector::Dense<Scalar> &y)
 		throw LAException("level1::dot: incompatible vector size");
 	}
 
-	typename VectorStoragePolicyX<Scalar>::Cursor cursorx = x.cursor();
-
-	cursorx.reset();
+	Scalar const *y_values = y.data.data();
 
 	Scalar accumulator = 0.0f;
+	vector::for_each_nonzero(x, [&accumulator, y_values](size_t i, Scalar value)
+	{
+		accumulator += value*y_values[i];
+	});
+
+	return accumulator;
+}
+
 
+template<typename Scalar>
+Scalar 
+dot(vector::Dense<Scalar> &x, vector::SparseCS<Scalar> &y)
+{
+	return dot(y, x);
+}
 
-	while( !cursorx.at_end() )
+
+/**
+ * Merges the index arrays of both vectors, which are sorted
+ **/
+template<typename Scalar>
+Scalar 
+dot(vector::SparseCS<Scalar> &x, vector::SparseCS<Scalar> &y)
+{
+	if( x.size() != y.size() )
+	{
+		throw LAException("level1::dot: incompatible vector size");
+	}
+
+	size_t const *x_index = x.data.column_index.data();
+	size_t const *y_index = y.data.column_index.data();
+	size_t const x_nnz = x.data.values.size();
+	size_t const y_nnz = y.data.values.size();
+
+	Scalar accumulator = 0.0f;
+
+	size_t kx = 0;
+	size_t ky = 0;
+	while( kx < x_nnz && ky < y_nnz )
 	{
-		size_t x_i = cursorx.current();
-		accumulator += cursorx.element()*y.getValue(x_i);
-		cursorx.next();
+		if(x_index[kx] == y_index[ky])
+		{
+			accumulator += x.data.values[kx]*y.data.values[ky];
+			kx++;
+			ky++;
+		}
+		else if (x_index[kx] > y_index[ky])
+		{
+			ky++;
+		}
+		else
+		{
+			kx++;
+		}
 	}
 
 	return accumulator;
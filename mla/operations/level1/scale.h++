@@ -4,6 +4,7 @@
 #include <type_traits>
 
 #include <mla/vector/all.h++>
+#include <mla/vector/for_each_nonzero.h++>
 
 
 namespace mla {
@@ -18,15 +19,10 @@ template<typename Scalar, template<typename> class VectorStoragePolicyX>
 void 
 scale(Scalar a, VectorStoragePolicyX<Scalar> &x)
 {
-	typename VectorStoragePolicyX<Scalar>::Cursor cursor = x.cursor();
-	cursor.reset();
-
-	while(!cursor.at_end())
+	vector::for_each_nonzero(x, [a](size_t, Scalar &value)
 	{
-		size_t i = cursor.current();
-		x.setValue(i, cursor.element()*a);
-		cursor.next();
-	}
+		value *= a;
+	});
 }
 
 
@@ -2,86 +2,206 @@
 #define MLA_OPERATIONS_LEVEL2_GEMV_HPP
 
 #include <type_traits>
+#include <algorithm>
+#include <vector>
 
 #include <mla/LAException.h++>
+#include <mla/ThreadPool.h++>
 
 #include <mla/matrix/all.h++>
+#include <mla/matrix/for_each_nonzero.h++>
 #include <mla/vector/all.h++>
-
-#include <mla/MatrixCursor.h++>
+#include <mla/vector/for_each_nonzero.h++>
 
 namespace mla {
 
+namespace detail
+{
+
 /**
- * Implements the level 1 BLAS functions
- * {y} := a[A]{x} + b{y}
- *
- * http://www.netlib.org/blas/#_reference_blas_version_3_5_0
+ * Returns the elements of x scaled by a as a dense array, which is either the storage
+ * of x itself or buffer
  **/
+template<typename Scalar, template<typename> class VectorPolicy>
+Scalar const *
+scaled_dense_values(Scalar const a, VectorPolicy<Scalar> &x, std::vector<Scalar> &buffer)
+{
+	buffer.assign(x.size(), (Scalar)0);
+	Scalar *values = buffer.data();
+	vector::for_each_nonzero(x, [a, values](size_t i, Scalar value)
+	{
+		values[i] = a*value;
+	});
+	return values;
+}
 
-template<typename Scalar, template<typename> class MatrixPolicy, template<typename> class VectorPolicyX, template<typename> class VectorPolicyY>
-void 
-gemv(Scalar const a, MatrixPolicy<Scalar> &A, VectorPolicyX<Scalar> &x, Scalar const b, VectorPolicyY<Scalar> &y)
+
+template<typename Scalar>
+Scalar const *
+scaled_dense_values(Scalar const a, vector::Dense<Scalar> &x, std::vector<Scalar> &buffer)
 {
-	if( A.columns() != x.size() )
+	if(a == (Scalar)1)
 	{
-		throw LAException("level2::gemv: incompatible sizes between A and x");
+		return x.data.data();
 	}
-	if( A.rows() != y.size() )
+
+	buffer.resize(x.size());
+	for(size_t i = 0; i < x.size(); i++)
 	{
-		throw LAException("level2::gemv: incompatible sizes between A and y");
+		buffer[i] = a*x.data[i];
+	}
+	return buffer.data();
+}
+
+
+/**
+ * Computes y := A x + b y on dense arrays, visiting the elements of A with
+ * matrix::for_each_nonzero
+ **/
+template<typename Scalar, typename MatrixPolicy>
+void
+gemv_traverse(MatrixPolicy const &A, Scalar const *x, Scalar const b, Scalar *y)
+{
+	// as in the reference BLAS, y isn't read when b is zero
+	if(b == (Scalar)0)
+	{
+		std::fill(y, y + A.rows(), (Scalar)0);
+	}
+	else if(b != (Scalar)1)
+	{
+		for(size_t i = 0; i < A.rows(); i++)
+		{
+			y[i] *= b;
+		}
+	}
+
+	matrix::for_each_nonzero(A, 0, A.rows(), [x, y](size_t i, size_t j, Scalar value)
+	{
+		y[i] += value*x[j];
+	});
+}
+
+
+/**
+ * y := A x + b y on a dense y, which is updated in place
+ **/
+template<typename Scalar, typename MatrixPolicy>
+void
+gemv_traverse(MatrixPolicy const &A, Scalar const *x, Scalar const b, vector::Dense<Scalar> &y)
+{
+	gemv_traverse(A, x, b, y.data.data());
+}
+
+
+/**
+ * y := A x + b y on any other y, through a dense copy
+ **/
+template<typename Scalar, typename MatrixPolicy, template<typename> class VectorPolicyY>
+void
+gemv_traverse(MatrixPolicy const &A, Scalar const *x, Scalar const b, VectorPolicyY<Scalar> &y)
+{
+	std::vector<Scalar> y_values(y.size(), (Scalar)0);
+	if(b != (Scalar)0)
+	{
+		Scalar *values = y_values.data();
+		vector::for_each_nonzero(y, [values](size_t i, Scalar value)
+		{
+			values[i] = value;
+		});
 	}
 
-	typename MatrixPolicy<Scalar>::Cursor A_cursor = A.cursor();
-	typename VectorPolicyX<Scalar>::Cursor x_cursor = x.cursor();
+	gemv_traverse(A, x, b, y_values.data());
+
+	for(size_t i = 0; i < y.size(); i++)
+	{
+		y.setValue(i, y_values[i]);
+	}
+}
 
-	A_cursor.reset();
 
-	while( !A_cursor.at_end_of_rows() )
+/**
+ * y := A x + b y on a sparse y, which is rebuilt from the non-zero results
+ **/
+template<typename Scalar, typename MatrixPolicy>
+void
+gemv_traverse(MatrixPolicy const &A, Scalar const *x, Scalar const b, vector::SparseCS<Scalar> &y)
+{
+	std::vector<Scalar> y_values(y.size(), (Scalar)0);
+	if(b != (Scalar)0)
 	{
-		x_cursor.reset();
+		Scalar *values = y_values.data();
+		vector::for_each_nonzero(y, [values](size_t i, Scalar value)
+		{
+			values[i] = value;
+		});
+	}
 
-		Scalar Yval = y.getValue(A_cursor.current_row());
+	gemv_traverse(A, x, b, y_values.data());
 
-		while( !A_cursor.at_end_of_rows() )
+	y.resize(y_values.size());
+	for(size_t i = 0; i < y_values.size(); i++)
+	{
+		if(y_values[i] != (Scalar)0)
 		{
-			if(A_cursor.current_column()  == x_cursor.current())
-			{
-				Yval = a*A_cursor.element()*x_cursor.element() + b*Yval;
-
-				x_cursor.next();
-				A_cursor.increment_column();
-
-				if( x_cursor.at_end() ||  A_cursor.at_end_of_current_row() )
-				{
-					y.setValue( A_cursor.current_row(), Yval );
-					A_cursor.start_next_row_nn();
-					break;
-				}
-			}
-			else if(A_cursor.current_column() > x_cursor.current())
-			{
-				x_cursor.next();
-				if( x_cursor.at_end() )
-				{
-					y.setValue( A_cursor.current_row(), Yval );
-					A_cursor.start_next_column_nn();
-					break;
-				}
-			}
-			else
-			{
-				A_cursor.increment_column();
-				if(A_cursor.at_end_of_current_row() )
-				{
-					y.setValue( A_cursor.current_row(), Yval );
-					A_cursor.start_next_row_nn();
-					break;
-				}
-			}
+			y.push_back(i, y_values[i]);
 		}
+	}
+}
+
 
+/**
+ * Computes {y} := a[A]{x} + b{y} for any matrix storage with a matrix::for_each_nonzero
+ * overload: x is made dense, and each stored element of A is accumulated on the
+ * element of y of its row.
+ **/
+template<typename Scalar, typename MatrixPolicy, template<typename> class VectorPolicyX, template<typename> class VectorPolicyY>
+void
+gemv_generic(Scalar const a, MatrixPolicy const &A, VectorPolicyX<Scalar> &x, Scalar const b, VectorPolicyY<Scalar> &y)
+{
+	if( A.columns() != x.size() )
+	{
+		throw LAException("level2::gemv: incompatible sizes between A and x");
+	}
+	if( A.rows() != y.size() )
+	{
+		throw LAException("level2::gemv: incompatible sizes between A and y");
 	}
+
+	std::vector<Scalar> buffer;
+	Scalar const *x_values = scaled_dense_values(a, x, buffer);
+
+	gemv_traverse(A, x_values, b, y);
+}
+
+}	// namespace detail
+
+
+/**
+ * Implements the level 2 BLAS functions
+ * {y} := a[A]{x} + b{y}
+ *
+ * Works with any matrix storage for which there is a matrix::for_each_nonzero overload,
+ * which is resolved at compile time.
+ *
+ * http://www.netlib.org/blas/#_reference_blas_version_3_5_0
+ **/
+template<typename Scalar, template<typename> class MatrixPolicy, template<typename> class VectorPolicyX, template<typename> class VectorPolicyY>
+void 
+gemv(Scalar const a, MatrixPolicy<Scalar> const &A, VectorPolicyX<Scalar> &x, Scalar const b, VectorPolicyY<Scalar> &y)
+{
+	detail::gemv_generic(a, A, x, b, y);
+}
+
+
+/**
+ * The generic gemv for matrix storages that aren't templates on the scalar type alone,
+ * such as StaticDenseRowMajor<Scalar, rows, columns>
+ **/
+template<typename Scalar, typename MatrixPolicy, template<typename> class VectorPolicyX, template<typename> class VectorPolicyY>
+void
+gemv(Scalar const a, MatrixPolicy const &A, VectorPolicyX<Scalar> &x, Scalar const b, VectorPolicyY<Scalar> &y)
+{
+	detail::gemv_generic(a, A, x, b, y);
 }
 
 
@@ -89,7 +209,7 @@ gemv(Scalar const a, MatrixPolicy<Scalar> &A, VectorPolicyX<Scalar> &x, Scalar c
 The default matrix-vector operator
 @param	A	a matrix, instance of class mla::matrix::DenseRowMajor<Scalar>
 @param	x	a vector, instance of class VectorStoragePolicy<Scalar>
-@param	y	a vector, instance of class VectorStoragePolicy<Scalar>
+@param	y	a vector, instance of class VectorStoragePolicy<Scalar>, resized to the rows of A if needed
 **/
 template<typename Scalar, template<typename> class VectorPolicyX, template<typename> class VectorPolicyY > 
 void
@@ -104,27 +224,184 @@ gemv(Scalar const a, matrix::DenseRowMajor<Scalar> &A, VectorPolicyX<Scalar> &x,
 		y.resize( A.rows() );
 	}
 
-	auto x_cursor = x.cursor();
+	std::vector<Scalar> buffer;
+	Scalar const *x_values = detail::scaled_dense_values(a, x, buffer);
+
+	detail::gemv_traverse(A, x_values, b, y);
+}
+
+namespace matrix
+{
+template<typename Scalar, typename Index>
+class SparseCRSView;
+}
 
 
-	for(size_t i = 0; i < A.rows(); i++)
+/**
+ * Splits the rows of a CRS matrix into at most n_parts contiguous ranges holding
+ * roughly the same number of non-zero elements.
+ *@param row_pointer	the rows+1 row pointers of the matrix
+ *@return	the row boundaries, where part p covers rows [boundaries[p], boundaries[p+1])
+ **/
+template<typename Index>
+std::vector<size_t>
+partition_rows_by_nnz(Index const *row_pointer, size_t rows, size_t n_parts)
+{
+	size_t const nnz = row_pointer[rows] > row_pointer[0] ? row_pointer[rows] - row_pointer[0] : 0;
+
+	std::vector<size_t> boundaries(n_parts+1, rows);
+	boundaries[0] = 0;
+
+	for(size_t p = 1; p < n_parts; p++)
 	{
-		x_cursor.reset();
+		size_t const target = row_pointer[0] + (nnz*p)/n_parts;
+		size_t row = std::lower_bound(row_pointer, row_pointer + rows, target) - row_pointer;
+		boundaries[p] = std::max(boundaries[p-1], std::min(row, rows));
+	}
+
+	return boundaries;
+}
+
+
+template<typename Scalar>
+std::vector<size_t>
+partition_rows_by_nnz(matrix::SparseCRS<Scalar> const &A, size_t n_parts)
+{
+	return partition_rows_by_nnz(A.data.row_pointer.data(), A.rows(), n_parts);
+}
 
-		Scalar Yval = y.getValue(i);
 
-		while( !x_cursor.at_end() )
+/**
+ * Computes {y} := a[A]{x} + b{y} over the rows [row_begin, row_end) of the CRS arrays
+ * of a matrix
+ **/
+template<typename Scalar, typename Index>
+void
+gemv_rows(Scalar const a, Index const *row_pointer, Index const *column_index, Scalar const *values, Scalar const *x, Scalar const b, Scalar *y, size_t row_begin, size_t row_end)
+{
+	for(size_t i = row_begin; i < row_end; i++)
+	{
+		// independent partial sums break the dependency chain on the accumulator
+		Scalar sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+
+		size_t k = row_pointer[i];
+		size_t const k_end = row_pointer[i+1];
+		for(; k + 4 <= k_end; k += 4)
 		{
-			Yval = a*A.getValue(i, x_cursor.current())*x_cursor.element() + b*Yval;
-			x_cursor.next();
+			sum0 += values[k]*x[column_index[k]];
+			sum1 += values[k+1]*x[column_index[k+1]];
+			sum2 += values[k+2]*x[column_index[k+2]];
+			sum3 += values[k+3]*x[column_index[k+3]];
 		}
+		for(; k < k_end; k++)
+		{
+			sum0 += values[k]*x[column_index[k]];
+		}
+
+		Scalar const Ax = (sum0 + sum1) + (sum2 + sum3);
+
+		// as in the reference BLAS, y isn't read when b is zero
+		y[i] = (b == (Scalar)0) ? a*Ax : a*Ax + b*y[i];
+	}
+}
+
+
+/**
+ * Computes {y} := a[A]{x} + b{y} over the rows [row_begin, row_end) of a CRS matrix
+ **/
+template<typename Scalar>
+void
+gemv_rows(Scalar const a, matrix::SparseCRS<Scalar> const &A, Scalar const *x, Scalar const b, Scalar *y, size_t row_begin, size_t row_end)
+{
+	gemv_rows(a, A.data.row_pointer.data(), A.data.column_index.data(), A.data.values.data(), x, b, y, row_begin, row_end);
+}
+
+
+/**
+ * Computes {y} := a[A]{x} + b{y} from the CRS arrays of a matrix, splitting the rows
+ * among the threads of pool in ranges with a similar number of non-zero elements.
+ **/
+template<typename Scalar, typename Index>
+void
+gemv_crs(Scalar const a, size_t rows, Index const *row_pointer, Index const *column_index, Scalar const *values, Scalar const *x, Scalar const b, Scalar *y, ThreadPool &pool)
+{
+	// below this number of non-zero elements per thread, spreading the work isn't worth it
+	size_t const min_nnz_per_thread = 32768;
 
-		y.setValue( i, Yval);
+	size_t n_parts = std::min<size_t>(pool.size(), (row_pointer[rows] - row_pointer[0])/min_nnz_per_thread);
+
+	if(n_parts <= 1)
+	{
+		gemv_rows(a, row_pointer, column_index, values, x, b, y, 0, rows);
+		return;
 	}
 
+	std::vector<size_t> const boundaries = partition_rows_by_nnz(row_pointer, rows, n_parts);
+
+	pool.run(n_parts, [&](size_t p)
+	{
+		gemv_rows(a, row_pointer, column_index, values, x, b, y, boundaries[p], boundaries[p+1]);
+	});
 }
 
 
+/**
+ * Computes {y} := a[A]{x} + b{y} from the CRS arrays of a matrix, on the threads of
+ * ThreadPool::global()
+ **/
+template<typename Scalar, typename Index>
+void
+gemv_crs(Scalar const a, size_t rows, Index const *row_pointer, Index const *column_index, Scalar const *values, Scalar const *x, Scalar const b, Scalar *y)
+{
+	gemv_crs(a, rows, row_pointer, column_index, values, x, b, y, ThreadPool::global());
+}
+
+
+/**
+ * Matrix-vector product for CRS matrices and dense vectors, which works directly on
+ * the CRS arrays.  Rows are split among the threads of ThreadPool::global() in
+ * ranges with a similar number of non-zero elements.
+ *@param	A	a matrix, instance of class mla::matrix::SparseCRS<Scalar>
+ *@param	x	a vector, instance of class mla::vector::Dense<Scalar>
+ *@param	y	a vector, instance of class mla::vector::Dense<Scalar>
+ **/
+template<typename Scalar>
+void
+gemv(Scalar const a, matrix::SparseCRS<Scalar> &A, vector::Dense<Scalar> &x, Scalar const b, vector::Dense<Scalar> &y)
+{
+	if( A.columns() != x.size() )
+	{
+		throw LAException("level2::gemv: incompatible sizes between A and x");
+	}
+	if( A.rows() != y.size() )
+	{
+		throw LAException("level2::gemv: incompatible sizes between A and y");
+	}
+
+	gemv_crs(a, A.rows(), A.data.row_pointer.data(), A.data.column_index.data(), A.data.values.data(), x.data.data(), b, y.data.data());
+}
+
+
+/**
+ * Matrix-vector product for memory-mapped CRS matrices and dense vectors
+ *@param	A	a matrix, instance of class mla::matrix::SparseCRSView<Scalar, Index>
+ **/
+template<typename Scalar, typename Index>
+void
+gemv(Scalar const a, matrix::SparseCRSView<Scalar, Index> const &A, vector::Dense<Scalar> &x, Scalar const b, vector::Dense<Scalar> &y)
+{
+	if( A.columns() != x.size() )
+	{
+		throw LAException("level2::gemv: incompatible sizes between A and x");
+	}
+	if( A.rows() != y.size() )
+	{
+		throw LAException("level2::gemv: incompatible sizes between A and y");
+	}
+
+	gemv_crs(a, A.rows(), A.data.row_pointer, A.data.column_index, A.data.values, x.data.data(), b, y.data.data());
+}
+
 
 }	// mla
 
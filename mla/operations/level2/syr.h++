@@ -2,13 +2,13 @@
 #define MLA_OPERATIONS_LEVEL2_SYR_HPP
 
 #include <type_traits>
+#include <vector>
 
 #include <mla/LAException.h++>
 
 #include <mla/matrix/all.h++>
 #include <mla/vector/all.h++>
-
-#include <mla/MatrixCursor.h++>
+#include <mla/vector/for_each_nonzero.h++>
 
 namespace mla {
 
@@ -32,34 +32,33 @@ syr(Scalar alpha, VectorPolicyX<Scalar> &x, MatrixPolicyA<Scalar> &A)
 		throw LAException("level2::syr: incompatible sizes between A and x");
 	}
 
-	Scalar temp_value;
-	auto cursor_xi = x.cursor();
+	// gather the stored elements of x, to pair them up
+	std::vector<size_t> index;
+	std::vector<Scalar> values;
+	vector::for_each_nonzero(x, [&index, &values](size_t i, Scalar value)
+	{
+		index.push_back(i);
+		values.push_back(value);
+	});
 
-	while( !cursor_xi.at_end() )
+	Scalar temp_value;
+	for(size_t ki = 0; ki < index.size(); ki++)
 	{
-		auto cursor_xj = cursor_xi;
-		size_t i = cursor_xi.current();
-		size_t j = cursor_xj.current();
+		size_t const i = index[ki];
 
 		// first, the diagonal elements
-		temp_value = alpha*cursor_xi.element()*cursor_xj.element();
-		A(i,j) += temp_value;
-
-		cursor_xj.next();
+		temp_value = alpha*values[ki]*values[ki];
+		A(i,i) += temp_value;
 
 		// next, the off-diagonal elements
-		while( !cursor_xj.at_end() )
+		for(size_t kj = ki+1; kj < index.size(); kj++)
 		{
-			j = cursor_xj.current();
+			size_t const j = index[kj];
 
-			temp_value = alpha*cursor_xi.element()*cursor_xj.element();
+			temp_value = alpha*values[ki]*values[kj];
 			A(i,j) += temp_value;
 			A(j,i) += temp_value;
-
-			cursor_xj.next();
 		}
-
-		cursor_xi.next();
 	}
 
 }
@@ -1,10 +1,19 @@
 #ifndef MLA_OPERATIONS_LEVEL3_GEMM_HPP
-#define MLA_OPERATIONS_LEVEL3_GEMV_HPP
+#define MLA_OPERATIONS_LEVEL3_GEMM_HPP
 
 #include <type_traits>
+#include <algorithm>
+#include <vector>
+
+#include <mla/LAException.h++>
+#include <mla/ThreadPool.h++>
+
 #include <mla/matrix/all.h++>
 #include <mla/vector/all.h++>
 
+#include <mla/operations/level2/gemv.h++>
+#include <mla/operations/level3/kernels.h++>
+
 namespace mla {
 
 /**
@@ -12,6 +21,8 @@ namespace mla {
  * {C} := a[A][B] + b[C]
  *
  * http://www.netlib.org/blas/#_level_3
+ *
+ * As in the reference BLAS, C isn't read when b is zero.
  **/
 
 
@@ -19,17 +30,49 @@ template<typename Scalar, template<typename> class MatrixAPolicy, template<typen
 void
 gemm(Scalar const alpha, MatrixAPolicy<Scalar> const &A, MatrixBPolicy<Scalar> const &B, Scalar const beta, MatrixCPolicy<Scalar> &C)
 {
-	static_assert(true, "Generic level3::gemm not implemented yet");
+	if(A.columns() != B.rows())
+	{
+		throw LAException("gemm: A.columns() != B.rows()");
+	}
+	if(C.rows() != A.rows())
+	{
+		throw LAException("gemm: C.rows() != A.rows()");
+	}
+	if(C.columns() != B.columns())
+	{
+		throw LAException("gemm: C.columns() != B.columns()");
+	}
+
+	for(size_t i = 0; i < A.rows(); i++)
+	{
+		for(size_t j = 0; j < B.columns(); j++)
+		{
+			Scalar value = 0;
+			for(size_t k = 0; k < A.columns(); k++)
+			{
+				value += A.getValue(i,k)*B.getValue(k,j);
+			}
+
+			if(beta == (Scalar)0)
+				C.setValue(i,j, alpha*value);
+			else
+				C.setValue(i,j, alpha*value + beta*C.getValue(i,j));
+		}
+	}
 }
 
 
+/**
+ * Matrix-matrix product of dense matrices, computed by the packed, cache-blocked and
+ * multithreaded kernels of detail::gemm_blocked.
+ **/
 template<typename Scalar>
 void
 gemm(Scalar const alpha, matrix::DenseRowMajor<Scalar> const &A, matrix::DenseRowMajor<Scalar> const &B, Scalar const beta, matrix::DenseRowMajor<Scalar> &C)
 {
 	if(A.columns() != B.rows())
 	{
-		throw LAException("gemm: A.rows() != B.columns()");
+		throw LAException("gemm: A.columns() != B.rows()");
 	}
 	if(C.rows() != A.rows())
 	{
@@ -40,25 +83,100 @@ gemm(Scalar const alpha, matrix::DenseRowMajor<Scalar> const &A, matrix::DenseRo
 		throw LAException("gemm: C.columns() != B.columns()");
 	}
 
-	// proceed 
-	for(size_t i = 0; i < A.rows(); i++)
+	detail::gemm_dispatch(A.rows(), B.columns(), A.columns(), alpha, detail::column_major_view(A), detail::column_major_view(B), beta, C.data.element_vector.data(), C.rows());
+}
+
+
+/**
+ * Computes [C] := a[A][B] + b[C] over the rows [row_begin, row_end) of a CRS matrix,
+ * where B and C are column-major.  Columns of B are processed in blocks, so that each
+ * row of A is read once per block while the block of B stays in cache.
+ **/
+template<typename Scalar>
+void
+gemm_rows(Scalar const alpha, matrix::SparseCRS<Scalar> const &A, Scalar const *B, size_t ldb, Scalar const beta, Scalar *C, size_t ldc, size_t n, size_t row_begin, size_t row_end)
+{
+	size_t const block_size = 8;
+
+	size_t const *row_pointer = A.data.row_pointer.data();
+	size_t const *column_index = A.data.column_index.data();
+	Scalar const *values = A.data.values.data();
+
+	for(size_t j0 = 0; j0 < n; j0 += block_size)
 	{
-		for(size_t j = 0; j < B.columns(); j++)
+		size_t const columns = std::min(block_size, n - j0);
+
+		for(size_t i = row_begin; i < row_end; i++)
 		{
-			// C.setValue(i,j, (Scalar) 0.0f);
-			C(i,j) *= beta;
+			Scalar sum[block_size] = {};
 
-			Scalar value = 0.0f;
-			for(size_t k = 0; k < A.columns(); k++)
+			for(size_t k = row_pointer[i]; k < row_pointer[i+1]; k++)
 			{
-				value += A.getValue(i,k)*B.getValue(k,j);
+				Scalar const a = values[k];
+				Scalar const *b = B + column_index[k] + j0*ldb;
+				for(size_t j = 0; j < columns; j++)
+				{
+					sum[j] += a*b[j*ldb];
+				}
+			}
+
+			Scalar *c = C + i + j0*ldc;
+			for(size_t j = 0; j < columns; j++)
+			{
+				c[j*ldc] = (beta == (Scalar)0) ? alpha*sum[j] : alpha*sum[j] + beta*c[j*ldc];
 			}
-			C(i,j)  += alpha*value;
 		}
 	}
 }
 
 
+/**
+ * Product of a CRS matrix and a dense matrix.  Rows are split among the threads of
+ * ThreadPool::global() in ranges with a similar number of non-zero elements.
+ **/
+template<typename Scalar>
+void
+gemm(Scalar const alpha, matrix::SparseCRS<Scalar> const &A, matrix::DenseRowMajor<Scalar> const &B, Scalar const beta, matrix::DenseRowMajor<Scalar> &C)
+{
+	if(A.columns() != B.rows())
+	{
+		throw LAException("gemm: A.columns() != B.rows()");
+	}
+	if(C.rows() != A.rows())
+	{
+		throw LAException("gemm: C.rows() != A.rows()");
+	}
+	if(C.columns() != B.columns())
+	{
+		throw LAException("gemm: C.columns() != B.columns()");
+	}
+
+	// below this number of multiplications per thread, spreading the work isn't worth it
+	size_t const min_work_per_thread = 65536;
+
+	ThreadPool &pool = ThreadPool::global();
+
+	size_t const work = A.data.values.size()*B.columns();
+	size_t const n_parts = std::min(pool.size(), work/min_work_per_thread);
+
+	Scalar const *B_data = B.data.element_vector.data();
+	Scalar *C_data = C.data.element_vector.data();
+
+	if(n_parts <= 1)
+	{
+		gemm_rows(alpha, A, B_data, B.rows(), beta, C_data, C.rows(), B.columns(), 0, A.rows());
+		return;
+	}
+
+	std::vector<size_t> const boundaries = partition_rows_by_nnz(A, n_parts);
+
+	pool.run(n_parts, [&](size_t p)
+	{
+		gemm_rows(alpha, A, B_data, B.rows(), beta, C_data, C.rows(), B.columns(), boundaries[p], boundaries[p+1]);
+	});
+}
+
+
 }	// mla
 
 #endif
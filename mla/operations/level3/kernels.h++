@@ -0,0 +1,619 @@
+#ifndef MLA_OPERATIONS_LEVEL3_KERNELS_HPP
+#define MLA_OPERATIONS_LEVEL3_KERNELS_HPP
+
+#include <algorithm>
+#include <vector>
+
+#include <mla/ThreadPool.h++>
+
+#include <mla/matrix/DenseRowMajor.h++>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)) && !defined(MLA_NO_SIMD)
+#define MLA_X86_SIMD_KERNELS
+#include <immintrin.h>
+#endif
+
+
+namespace mla {
+
+/**
+ * Which triangle of a symmetric result is computed
+ **/
+enum Triangle
+{
+	TRIANGLE_LOWER,
+	TRIANGLE_UPPER
+};
+
+
+namespace detail {
+
+/**
+ * Blocked matrix-matrix product C := alpha*A*B + beta*C on strided matrices, following
+ * the scheme of the BLIS framework: blocks of B and A are packed into contiguous panels
+ * sized for the caches, and a register-tiled micro-kernel computes MR-by-NR tiles of C.
+ *
+ * A micro-kernel is a class that provides:
+ *	MR, NR	the size of the tile of C kept in registers
+ *	run(k, a, b, alpha, beta, c, ldc)	c := alpha*a*b + beta*c, where a is a packed
+ *		MR-by-k panel, b is a packed k-by-NR panel and c is column-major.  c isn't read
+ *		if beta is zero.
+ *
+ * SIMD micro-kernels are compiled for their instruction set with function attributes
+ * and picked at run time, so the library doesn't need to be built for a specific CPU.
+ * Define MLA_NO_SIMD to only build the portable micro-kernel.
+ **/
+
+
+/**
+ * Portable micro-kernel, which the compiler may vectorize for the target architecture
+ **/
+template<typename Scalar>
+struct GemmKernelScalar
+{
+	static constexpr size_t MR = 4;
+	static constexpr size_t NR = 4;
+
+	static void run(size_t k, Scalar const *a, Scalar const *b, Scalar alpha, Scalar beta, Scalar *c, size_t ldc)
+	{
+		Scalar ab[MR*NR] = {};
+
+		for(size_t p = 0; p < k; p++)
+		{
+			for(size_t j = 0; j < NR; j++)
+			{
+				for(size_t i = 0; i < MR; i++)
+				{
+					ab[i + j*MR] += a[i]*b[j];
+				}
+			}
+			a += MR;
+			b += NR;
+		}
+
+		for(size_t j = 0; j < NR; j++)
+		{
+			for(size_t i = 0; i < MR; i++)
+			{
+				c[i + j*ldc] = (beta == (Scalar)0) ? alpha*ab[i + j*MR] : alpha*ab[i + j*MR] + beta*c[i + j*ldc];
+			}
+		}
+	}
+};
+
+
+#ifdef MLA_X86_SIMD_KERNELS
+
+/**
+ * AVX2 micro-kernels: 12 accumulator registers of 4 doubles or 8 floats
+ **/
+struct GemmKernelAVX2Double
+{
+	static constexpr size_t MR = 8;
+	static constexpr size_t NR = 6;
+
+	__attribute__((target("avx2,fma")))
+	static void run(size_t k, double const *a, double const *b, double alpha, double beta, double *c, size_t ldc)
+	{
+		__m256d ab[2][NR];
+		for(size_t j = 0; j < NR; j++)
+		{
+			ab[0][j] = _mm256_setzero_pd();
+			ab[1][j] = _mm256_setzero_pd();
+		}
+
+		for(size_t p = 0; p < k; p++)
+		{
+			__m256d const a0 = _mm256_loadu_pd(a);
+			__m256d const a1 = _mm256_loadu_pd(a+4);
+			for(size_t j = 0; j < NR; j++)
+			{
+				__m256d const bj = _mm256_broadcast_sd(b+j);
+				ab[0][j] = _mm256_fmadd_pd(a0, bj, ab[0][j]);
+				ab[1][j] = _mm256_fmadd_pd(a1, bj, ab[1][j]);
+			}
+			a += MR;
+			b += NR;
+		}
+
+		__m256d const alpha_v = _mm256_set1_pd(alpha);
+		__m256d const beta_v = _mm256_set1_pd(beta);
+		for(size_t j = 0; j < NR; j++)
+		{
+			double *column = c + j*ldc;
+			__m256d c0 = _mm256_mul_pd(alpha_v, ab[0][j]);
+			__m256d c1 = _mm256_mul_pd(alpha_v, ab[1][j]);
+			if(beta != 0)
+			{
+				c0 = _mm256_fmadd_pd(beta_v, _mm256_loadu_pd(column), c0);
+				c1 = _mm256_fmadd_pd(beta_v, _mm256_loadu_pd(column+4), c1);
+			}
+			_mm256_storeu_pd(column, c0);
+			_mm256_storeu_pd(column+4, c1);
+		}
+	}
+};
+
+
+struct GemmKernelAVX2Float
+{
+	static constexpr size_t MR = 16;
+	static constexpr size_t NR = 6;
+
+	__attribute__((target("avx2,fma")))
+	static void run(size_t k, float const *a, float const *b, float alpha, float beta, float *c, size_t ldc)
+	{
+		__m256 ab[2][NR];
+		for(size_t j = 0; j < NR; j++)
+		{
+			ab[0][j] = _mm256_setzero_ps();
+			ab[1][j] = _mm256_setzero_ps();
+		}
+
+		for(size_t p = 0; p < k; p++)
+		{
+			__m256 const a0 = _mm256_loadu_ps(a);
+			__m256 const a1 = _mm256_loadu_ps(a+8);
+			for(size_t j = 0; j < NR; j++)
+			{
+				__m256 const bj = _mm256_broadcast_ss(b+j);
+				ab[0][j] = _mm256_fmadd_ps(a0, bj, ab[0][j]);
+				ab[1][j] = _mm256_fmadd_ps(a1, bj, ab[1][j]);
+			}
+			a += MR;
+			b += NR;
+		}
+
+		__m256 const alpha_v = _mm256_set1_ps(alpha);
+		__m256 const beta_v = _mm256_set1_ps(beta);
+		for(size_t j = 0; j < NR; j++)
+		{
+			float *column = c + j*ldc;
+			__m256 c0 = _mm256_mul_ps(alpha_v, ab[0][j]);
+			__m256 c1 = _mm256_mul_ps(alpha_v, ab[1][j]);
+			if(beta != 0)
+			{
+				c0 = _mm256_fmadd_ps(beta_v, _mm256_loadu_ps(column), c0);
+				c1 = _mm256_fmadd_ps(beta_v, _mm256_loadu_ps(column+8), c1);
+			}
+			_mm256_storeu_ps(column, c0);
+			_mm256_storeu_ps(column+8, c1);
+		}
+	}
+};
+
+
+/**
+ * AVX-512 micro-kernels: 16 accumulator registers of 8 doubles or 16 floats
+ **/
+struct GemmKernelAVX512Double
+{
+	static constexpr size_t MR = 16;
+	static constexpr size_t NR = 8;
+
+	__attribute__((target("avx512f")))
+	static void run(size_t k, double const *a, double const *b, double alpha, double beta, double *c, size_t ldc)
+	{
+		__m512d ab[2][NR];
+		for(size_t j = 0; j < NR; j++)
+		{
+			ab[0][j] = _mm512_setzero_pd();
+			ab[1][j] = _mm512_setzero_pd();
+		}
+
+		for(size_t p = 0; p < k; p++)
+		{
+			__m512d const a0 = _mm512_loadu_pd(a);
+			__m512d const a1 = _mm512_loadu_pd(a+8);
+			for(size_t j = 0; j < NR; j++)
+			{
+				__m512d const bj = _mm512_set1_pd(b[j]);
+				ab[0][j] = _mm512_fmadd_pd(a0, bj, ab[0][j]);
+				ab[1][j] = _mm512_fmadd_pd(a1, bj, ab[1][j]);
+			}
+			a += MR;
+			b += NR;
+		}
+
+		__m512d const alpha_v = _mm512_set1_pd(alpha);
+		__m512d const beta_v = _mm512_set1_pd(beta);
+		for(size_t j = 0; j < NR; j++)
+		{
+			double *column = c + j*ldc;
+			__m512d c0 = _mm512_mul_pd(alpha_v, ab[0][j]);
+			__m512d c1 = _mm512_mul_pd(alpha_v, ab[1][j]);
+			if(beta != 0)
+			{
+				c0 = _mm512_fmadd_pd(beta_v, _mm512_loadu_pd(column), c0);
+				c1 = _mm512_fmadd_pd(beta_v, _mm512_loadu_pd(column+8), c1);
+			}
+			_mm512_storeu_pd(column, c0);
+			_mm512_storeu_pd(column+8, c1);
+		}
+	}
+};
+
+
+struct GemmKernelAVX512Float
+{
+	static constexpr size_t MR = 32;
+	static constexpr size_t NR = 8;
+
+	__attribute__((target("avx512f")))
+	static void run(size_t k, float const *a, float const *b, float alpha, float beta, float *c, size_t ldc)
+	{
+		__m512 ab[2][NR];
+		for(size_t j = 0; j < NR; j++)
+		{
+			ab[0][j] = _mm512_setzero_ps();
+			ab[1][j] = _mm512_setzero_ps();
+		}
+
+		for(size_t p = 0; p < k; p++)
+		{
+			__m512 const a0 = _mm512_loadu_ps(a);
+			__m512 const a1 = _mm512_loadu_ps(a+16);
+			for(size_t j = 0; j < NR; j++)
+			{
+				__m512 const bj = _mm512_set1_ps(b[j]);
+				ab[0][j] = _mm512_fmadd_ps(a0, bj, ab[0][j]);
+				ab[1][j] = _mm512_fmadd_ps(a1, bj, ab[1][j]);
+			}
+			a += MR;
+			b += NR;
+		}
+
+		__m512 const alpha_v = _mm512_set1_ps(alpha);
+		__m512 const beta_v = _mm512_set1_ps(beta);
+		for(size_t j = 0; j < NR; j++)
+		{
+			float *column = c + j*ldc;
+			__m512 c0 = _mm512_mul_ps(alpha_v, ab[0][j]);
+			__m512 c1 = _mm512_mul_ps(alpha_v, ab[1][j]);
+			if(beta != 0)
+			{
+				c0 = _mm512_fmadd_ps(beta_v, _mm512_loadu_ps(column), c0);
+				c1 = _mm512_fmadd_ps(beta_v, _mm512_loadu_ps(column+16), c1);
+			}
+			_mm512_storeu_ps(column, c0);
+			_mm512_storeu_ps(column+16, c1);
+		}
+	}
+};
+
+#endif	// MLA_X86_SIMD_KERNELS
+
+
+/**
+ * Strided view of a matrix: element (i,j) is data[i*row_stride + j*column_stride]
+ **/
+template<typename Scalar>
+struct StridedMatrix
+{
+	Scalar *data;
+	size_t row_stride;
+	size_t column_stride;
+
+	Scalar & operator()(size_t i, size_t j) const	{ return data[i*row_stride + j*column_stride]; }
+};
+
+
+/**
+ * Views the elements of a DenseRowMajor, which despite its name stores them column
+ * after column: element (i,j) is element_vector[i + j*rows()]
+ **/
+template<typename Scalar>
+StridedMatrix<Scalar const>
+column_major_view(matrix::DenseRowMajor<Scalar> const &A)
+{
+	StridedMatrix<Scalar const> const view = { A.data.element_vector.data(), 1, A.rows() };
+	return view;
+}
+
+
+/**
+ * Views the transpose of a DenseRowMajor, without copying it
+ **/
+template<typename Scalar>
+StridedMatrix<Scalar const>
+transposed_view(matrix::DenseRowMajor<Scalar> const &A)
+{
+	StridedMatrix<Scalar const> const view = { A.data.element_vector.data(), A.rows(), 1 };
+	return view;
+}
+
+
+/**
+ * Cache block sizes: a KC-by-NR panel of B stays in L1, a MC-by-KC block of A in L2
+ * and a KC-by-NC block of B in L3
+ **/
+struct GemmBlocking
+{
+	static constexpr size_t KC = 256;
+	static constexpr size_t MC = 128;
+	static constexpr size_t NC = 3072;
+
+	// products with fewer operations than this run on a single thread
+	static constexpr double parallel_flops = 4e6;
+};
+
+
+/**
+ * Packs the m-by-k block of A into MR-row panels, padded with zeros
+ **/
+template<size_t MR, typename Scalar>
+void
+pack_a(size_t m, size_t k, StridedMatrix<Scalar const> const &A, Scalar *packed)
+{
+	for(size_t i0 = 0; i0 < m; i0 += MR)
+	{
+		size_t const rows = std::min(MR, m - i0);
+		for(size_t p = 0; p < k; p++)
+		{
+			for(size_t i = 0; i < rows; i++)
+			{
+				packed[i] = A(i0+i, p);
+			}
+			for(size_t i = rows; i < MR; i++)
+			{
+				packed[i] = 0;
+			}
+			packed += MR;
+		}
+	}
+}
+
+
+/**
+ * Packs the k-by-NR panel of B starting at column j0, padded with zeros
+ **/
+template<size_t NR, typename Scalar>
+void
+pack_b_panel(size_t n, size_t k, size_t j0, StridedMatrix<Scalar const> const &B, Scalar *packed)
+{
+	size_t const columns = std::min(NR, n - j0);
+	for(size_t p = 0; p < k; p++)
+	{
+		for(size_t j = 0; j < columns; j++)
+		{
+			packed[j] = B(p, j0+j);
+		}
+		for(size_t j = columns; j < NR; j++)
+		{
+			packed[j] = 0;
+		}
+		packed += NR;
+	}
+}
+
+
+/**
+ * C := alpha*A*B + beta*C, where A is m-by-k, B is k-by-n and C is column-major with
+ * leading dimension ldc.  If triangle_only is set, only the elements of C in the given
+ * triangle are computed, as needed by SYRK.
+ **/
+template<typename Kernel, typename Scalar>
+void
+gemm_blocked(size_t m, size_t n, size_t k, Scalar alpha, StridedMatrix<Scalar const> const &A, StridedMatrix<Scalar const> const &B, Scalar beta, Scalar *C, size_t ldc, bool triangle_only = false, Triangle triangle = TRIANGLE_LOWER)
+{
+	size_t const MR = Kernel::MR;
+	size_t const NR = Kernel::NR;
+	size_t const KC = GemmBlocking::KC;
+	size_t const NC = GemmBlocking::NC - GemmBlocking::NC % NR;
+
+	if(m == 0 || n == 0)
+		return;
+
+	// tile (i0, j0) of C is only partially in the triangle, or not at all
+	auto is_outside = [=](size_t i0, size_t j0, size_t rows, size_t columns)
+		{
+			if(!triangle_only)
+				return false;
+			return triangle == TRIANGLE_LOWER ? i0+rows <= j0 : j0+columns <= i0;
+		};
+	auto is_partial = [=](size_t i0, size_t j0, size_t rows, size_t columns)
+		{
+			if(!triangle_only)
+				return false;
+			return triangle == TRIANGLE_LOWER ? i0 < j0+columns-1 : j0 < i0+rows-1;
+		};
+
+	if(k == 0)
+	{
+		// C := beta*C
+		for(size_t j = 0; j < n; j++)
+		{
+			for(size_t i = 0; i < m; i++)
+			{
+				if(triangle_only && (triangle == TRIANGLE_LOWER ? i < j : i > j))
+					continue;
+				Scalar &c = C[i + j*ldc];
+				c = (beta == (Scalar)0) ? (Scalar)0 : beta*c;
+			}
+		}
+		return;
+	}
+
+	// split the rows of C in blocks that are shared by the threads
+	ThreadPool &pool = ThreadPool::global();
+	double const flops = 2.0*m*n*k;
+	size_t MC = GemmBlocking::MC - GemmBlocking::MC % MR;
+	if(flops > GemmBlocking::parallel_flops && pool.size() > 1)
+	{
+		size_t const rows_per_thread = (m + pool.size()-1)/pool.size();
+		MC = std::max(MR, std::min(MC, (rows_per_thread + MR-1)/MR*MR));
+	}
+	else
+	{
+		MC = std::max(MR, std::min(MC, (m + MR-1)/MR*MR));
+	}
+	size_t const n_row_blocks = (m + MC-1)/MC;
+
+	std::vector<Scalar> packed_b( ((std::min(NC, n) + NR-1)/NR*NR) * KC );
+
+	for(size_t jc = 0; jc < n; jc += NC)
+	{
+		size_t const nc = std::min(NC, n - jc);
+		size_t const n_panels = (nc + NR-1)/NR;
+
+		for(size_t pc = 0; pc < k; pc += KC)
+		{
+			size_t const kc = std::min(KC, k - pc);
+			Scalar const beta_block = (pc == 0) ? beta : (Scalar)1;
+
+			StridedMatrix<Scalar const> const B_block = { &B(pc, jc), B.row_stride, B.column_stride };
+			Scalar *packed_b_data = packed_b.data();
+
+			auto pack_b = [&](size_t panel)
+				{
+					pack_b_panel<NR>(nc, kc, panel*NR, B_block, packed_b_data + panel*NR*kc);
+				};
+			if(flops > GemmBlocking::parallel_flops)
+				pool.run(n_panels, pack_b);
+			else
+				for(size_t panel = 0; panel < n_panels; panel++)
+					pack_b(panel);
+
+			auto row_block = [&](size_t block)
+				{
+					static thread_local std::vector<Scalar> packed_a;
+
+					size_t const ic = block*MC;
+					size_t const mc = std::min(MC, m - ic);
+					packed_a.resize( (mc + MR-1)/MR*MR * kc );
+
+					StridedMatrix<Scalar const> const A_block = { &A(ic, pc), A.row_stride, A.column_stride };
+					pack_a<MR>(mc, kc, A_block, packed_a.data());
+
+					Scalar tile[MR*NR];
+					for(size_t jr = 0; jr < nc; jr += NR)
+					{
+						size_t const columns = std::min(NR, nc - jr);
+						Scalar const *b = packed_b_data + jr*kc;
+
+						for(size_t ir = 0; ir < mc; ir += MR)
+						{
+							size_t const rows = std::min(MR, mc - ir);
+							size_t const i0 = ic + ir, j0 = jc + jr;
+
+							if(is_outside(i0, j0, rows, columns))
+								continue;
+
+							Scalar const *a = packed_a.data() + ir*kc;
+							Scalar *c = C + i0 + j0*ldc;
+
+							if(rows == MR && columns == NR && !is_partial(i0, j0, rows, columns))
+							{
+								Kernel::run(kc, a, b, alpha, beta_block, c, ldc);
+								continue;
+							}
+
+							// edge tiles go through a buffer, and only the requested elements are stored
+							Kernel::run(kc, a, b, (Scalar)1, (Scalar)0, tile, MR);
+							for(size_t j = 0; j < columns; j++)
+							{
+								for(size_t i = 0; i < rows; i++)
+								{
+									if(triangle_only && (triangle == TRIANGLE_LOWER ? i0+i < j0+j : i0+i > j0+j))
+										continue;
+
+									Scalar &c_ij = c[i + j*ldc];
+									c_ij = (beta_block == (Scalar)0) ? alpha*tile[i + j*MR] : alpha*tile[i + j*MR] + beta_block*c_ij;
+								}
+							}
+						}
+					}
+				};
+
+			if(flops > GemmBlocking::parallel_flops)
+				pool.run(n_row_blocks, row_block);
+			else
+				for(size_t block = 0; block < n_row_blocks; block++)
+					row_block(block);
+		}
+	}
+}
+
+
+/**
+ * Runs gemm_blocked with the fastest micro-kernel supported by the CPU
+ **/
+template<typename Scalar>
+void
+gemm_dispatch(size_t m, size_t n, size_t k, Scalar alpha, StridedMatrix<Scalar const> const &A, StridedMatrix<Scalar const> const &B, Scalar beta, Scalar *C, size_t ldc, bool triangle_only = false, Triangle triangle = TRIANGLE_LOWER)
+{
+	gemm_blocked< GemmKernelScalar<Scalar> >(m, n, k, alpha, A, B, beta, C, ldc, triangle_only, triangle);
+}
+
+
+#ifdef MLA_X86_SIMD_KERNELS
+
+enum SimdLevel
+{
+	SIMD_NONE,
+	SIMD_AVX2,
+	SIMD_AVX512
+};
+
+
+inline SimdLevel
+simd_level()
+{
+	static SimdLevel const level = []
+		{
+			__builtin_cpu_init();
+			if(__builtin_cpu_supports("avx512f"))
+				return SIMD_AVX512;
+			if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+				return SIMD_AVX2;
+			return SIMD_NONE;
+		}();
+
+	return level;
+}
+
+
+template<>
+inline void
+gemm_dispatch<double>(size_t m, size_t n, size_t k, double alpha, StridedMatrix<double const> const &A, StridedMatrix<double const> const &B, double beta, double *C, size_t ldc, bool triangle_only, Triangle triangle)
+{
+	switch(simd_level())
+	{
+		case SIMD_AVX512:
+			gemm_blocked<GemmKernelAVX512Double>(m, n, k, alpha, A, B, beta, C, ldc, triangle_only, triangle);
+			break;
+		case SIMD_AVX2:
+			gemm_blocked<GemmKernelAVX2Double>(m, n, k, alpha, A, B, beta, C, ldc, triangle_only, triangle);
+			break;
+		default:
+			gemm_blocked< GemmKernelScalar<double> >(m, n, k, alpha, A, B, beta, C, ldc, triangle_only, triangle);
+			break;
+	}
+}
+
+
+template<>
+inline void
+gemm_dispatch<float>(size_t m, size_t n, size_t k, float alpha, StridedMatrix<float const> const &A, StridedMatrix<float const> const &B, float beta, float *C, size_t ldc, bool triangle_only, Triangle triangle)
+{
+	switch(simd_level())
+	{
+		case SIMD_AVX512:
+			gemm_blocked<GemmKernelAVX512Float>(m, n, k, alpha, A, B, beta, C, ldc, triangle_only, triangle);
+			break;
+		case SIMD_AVX2:
+			gemm_blocked<GemmKernelAVX2Float>(m, n, k, alpha, A, B, beta, C, ldc, triangle_only, triangle);
+			break;
+		default:
+			gemm_blocked< GemmKernelScalar<float> >(m, n, k, alpha, A, B, beta, C, ldc, triangle_only, triangle);
+			break;
+	}
+}
+
+#endif	// MLA_X86_SIMD_KERNELS
+
+
+}	// namespace detail
+}	// namespace mla
+
+#endif
@@ -2,9 +2,14 @@
 #define MLA_OPERATIONS_LEVEL3_SYRK_HPP
 
 #include <type_traits>
+
+#include <mla/LAException.h++>
+
 #include <mla/matrix/all.h++>
 #include <mla/vector/all.h++>
 
+#include <mla/operations/level3/kernels.h++>
+
 namespace mla {
 
 /**
@@ -12,20 +17,86 @@ namespace mla {
  * {C} := alpha*[A]*[A]^T + beta*[C]
  *
  * http://www.netlib.org/blas/#_level_3
+ *
+ * The overloads that take a Triangle only compute and write that triangle of C, as
+ * the reference BLAS does, which halves the number of operations.  The others update
+ * the whole of C, and only mirror the lower triangle when beta is zero, as otherwise C
+ * isn't required to be symmetric.  As in the reference BLAS, C isn't read when beta
+ * is zero.
  **/
 
 
+template<typename Scalar, template<typename> class MatrixAPolicy, template<typename> class MatrixCPolicy>
+void
+syrk(Scalar const alpha, MatrixAPolicy<Scalar> const &A, Scalar const beta, MatrixCPolicy<Scalar> &C, Triangle const triangle)
+{
+	if(C.rows() != C.columns())
+	{
+		throw LAException("syrk: C isn't square");
+	}
+	if(A.rows() != C.rows())
+	{
+		throw LAException("syrk: A.rows() != C.rows()");
+	}
+
+	for(size_t j = 0; j < C.columns(); j++)
+	{
+		size_t const i_begin = (triangle == TRIANGLE_LOWER) ? j : 0;
+		size_t const i_end = (triangle == TRIANGLE_LOWER) ? C.rows() : j+1;
+
+		for(size_t i = i_begin; i < i_end; i++)
+		{
+			Scalar value = 0;
+			for(size_t k = 0; k < A.columns(); k++)
+			{
+				value += A.getValue(i,k)*A.getValue(j,k);
+			}
+
+			if(beta == (Scalar)0)
+				C.setValue(i,j, alpha*value);
+			else
+				C.setValue(i,j, alpha*value + beta*C.getValue(i,j));
+		}
+	}
+}
+
+
 template<typename Scalar, template<typename> class MatrixAPolicy, template<typename> class MatrixCPolicy>
 void
 syrk(Scalar const alpha, MatrixAPolicy<Scalar> const &A, Scalar const beta, MatrixCPolicy<Scalar> &C)
 {
-	static_assert(true, "Generic level3::gemm not implemented yet");
+	syrk(alpha, A, beta, C, TRIANGLE_LOWER);
+
+	for(size_t j = 0; j < C.columns(); j++)
+	{
+		for(size_t i = 0; i < j; i++)
+		{
+			if(beta == (Scalar)0)
+			{
+				C.setValue(i,j, C.getValue(j,i));
+				continue;
+			}
+
+			// C may not be symmetric, so the upper triangle has its own update
+			Scalar value = 0;
+			for(size_t k = 0; k < A.columns(); k++)
+			{
+				value += A.getValue(i,k)*A.getValue(j,k);
+			}
+			C.setValue(i,j, alpha*value + beta*C.getValue(i,j));
+		}
+	}
 }
 
 
+/**
+ * Rank-k update of a dense matrix, computed by the packed, cache-blocked and
+ * multithreaded kernels of detail::gemm_blocked with B = A^T.  Tiles of C outside the
+ * triangle are skipped.
+ **/
 template<typename Scalar>
 void
-syrk(Scalar const alpha, matrix::DenseRowMajor<Scalar> const &A, Scalar const beta, matrix::DenseRowMajor<Scalar> &C)
+syrk(Scalar const alpha, matrix::DenseRowMajor<Scalar> const &A, Scalar const beta, matrix::DenseRowMajor<Scalar> &C, Triangle const triangle)
 {
 	if(C.rows() != C.columns())
 	{
@@ -36,31 +107,40 @@ syrk(Scalar const alpha, matrix::DenseRowMajor<Scalar> const &A, Scalar const be
 		throw LAException("syrk: A.rows() != C.rows()");
 	}
 
-	// proceed 
-	for(size_t i = 0; i < A.rows(); i++)
-	{
-		Scalar value = 0.0f;
+	detail::gemm_dispatch(C.rows(), C.columns(), A.columns(), alpha, detail::column_major_view(A), detail::transposed_view(A), beta, C.data.element_vector.data(), C.rows(), true, triangle);
+}
+
 
-		// update diagonal elements
-		for(size_t k = 0; k < A.columns(); k++)
+template<typename Scalar>
+void
+syrk(Scalar const alpha, matrix::DenseRowMajor<Scalar> const &A, Scalar const beta, matrix::DenseRowMajor<Scalar> &C)
+{
+	if(beta != (Scalar)0)
+	{
+		// C may not be symmetric, so the whole of it goes through the kernels
+		if(C.rows() != C.columns())
 		{
-			value += A.getValue(i,k)*A.getValue(i,k);
+			throw LAException("syrk: C isn't square");
 		}
-		C(i,i)  = alpha*value + beta*C(i,i);
-
-		// update off-diagonal elements
-		for(size_t j = i+1; j < C.columns(); j++)
+		if(A.rows() != C.rows())
 		{
-			// C.setValue(i,j, (Scalar) 0.0f);
+			throw LAException("syrk: A.rows() != C.rows()");
+		}
 
-			value = 0.0f;
-			for(size_t k = 0; k < A.columns(); k++)
-			{
-				value += A.getValue(i,k)*A.getValue(j,k);
-			}
+		detail::gemm_dispatch(C.rows(), C.columns(), A.columns(), alpha, detail::column_major_view(A), detail::transposed_view(A), beta, C.data.element_vector.data(), C.rows());
+		return;
+	}
 
-			C(i,j)  = alpha*value + beta*C(i,j);
-			C(j,i)  = alpha*value + beta*C(j,i);
+	syrk(alpha, A, beta, C, TRIANGLE_LOWER);
+
+	// with beta == 0 the result is symmetric, so the lower triangle is mirrored
+	size_t const n = C.rows();
+	Scalar *c = C.data.element_vector.data();
+	for(size_t j = 0; j < n; j++)
+	{
+		for(size_t i = 0; i < j; i++)
+		{
+			c[i + j*n] = c[j + i*n];
 		}
 	}
 }
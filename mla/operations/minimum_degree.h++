@@ -0,0 +1,211 @@
+#ifndef MLA_OPERATIONS_MINIMUM_DEGREE_HPP
+#define MLA_OPERATIONS_MINIMUM_DEGREE_HPP
+
+#include <vector>
+#include <algorithm>
+
+#include <mla/LAException.h++>
+
+#include <mla/operations/AdjacencyGraph.h++>
+
+
+namespace mla {
+
+/**
+ * Approximate minimum degree ordering (Amestoy, Davis and Duff), which reduces the
+ * fill-in of Cholesky and LU factorizations.
+ *
+ * The elimination is simulated on a quotient graph: each eliminated vertex becomes an
+ * element that stands for the clique it created, so the graph never grows.  Vertex
+ * degrees are upper bounds computed from the sizes of the adjacent elements, which
+ * avoids the set unions needed by exact minimum degree.  Elements that become subsets
+ * of the newest element are absorbed.
+ *
+ * The ordering is returned as a permutation vector, where index[k] is the row/column of
+ * A eliminated in step k.
+ **/
+inline std::vector<size_t>
+approximate_minimum_degree(AdjacencyGraph const &graph)
+{
+	size_t const n = graph.size();
+	size_t const none = n;
+
+	enum Status
+	{
+		VARIABLE,
+		ELEMENT,
+		ABSORBED
+	};
+
+	std::vector<Status> status(n, VARIABLE);
+	std::vector<std::vector<size_t> > variables(n);	// adjacent uneliminated vertices
+	std::vector<std::vector<size_t> > elements(n);	// adjacent elements
+	std::vector<std::vector<size_t> > members(n);	// vertices of each element
+
+	// degree lists: doubly linked lists of the variables with each degree
+	std::vector<size_t> degree(n), head(n, none), next(n, none), previous(n, none);
+
+	auto insert = [&](size_t i)
+		{
+			size_t const d = degree[i];
+			previous[i] = none;
+			next[i] = head[d];
+			if(head[d] != none)
+				previous[head[d]] = i;
+			head[d] = i;
+		};
+
+	auto remove = [&](size_t i)
+		{
+			if(previous[i] != none)
+				next[previous[i]] = next[i];
+			else
+				head[degree[i]] = next[i];
+			if(next[i] != none)
+				previous[next[i]] = previous[i];
+		};
+
+	for(size_t i = 0; i < n; i++)
+	{
+		variables[i].assign(graph.data.index.begin() + graph.data.pointer[i], graph.data.index.begin() + graph.data.pointer[i+1]);
+		degree[i] = variables[i].size();
+		insert(i);
+	}
+
+	std::vector<size_t> mark(n, 0);	// mark[i] == stamp flags the vertices of the newest element
+	std::vector<size_t> w(n, 0);	// w[e] = |members[e] \ members[p]|
+	std::vector<size_t> w_mark(n, 0);
+	size_t stamp = 0;
+
+	std::vector<size_t> index;
+	index.reserve(n);
+
+	size_t min_degree = 0;
+	for(size_t k = 0; k < n; k++)
+	{
+		// pick a variable of minimum degree
+		while(head[min_degree] == none)
+			min_degree++;
+
+		size_t const p = head[min_degree];
+		remove(p);
+		index.push_back(p);
+		stamp++;
+
+		// the new element is the union of the adjacent variables and elements of p,
+		// which absorbs the elements of p
+		std::vector<size_t> Lp;
+		mark[p] = stamp;
+		for(size_t e: elements[p])
+		{
+			if(status[e] != ELEMENT)
+				continue;
+
+			for(size_t i: members[e])
+			{
+				if(status[i] == VARIABLE && mark[i] != stamp)
+				{
+					mark[i] = stamp;
+					Lp.push_back(i);
+				}
+			}
+			status[e] = ABSORBED;
+			std::vector<size_t>().swap(members[e]);
+		}
+		for(size_t i: variables[p])
+		{
+			if(status[i] == VARIABLE && mark[i] != stamp)
+			{
+				mark[i] = stamp;
+				Lp.push_back(i);
+			}
+		}
+
+		status[p] = ELEMENT;
+		std::vector<size_t>().swap(variables[p]);
+		std::vector<size_t>().swap(elements[p]);
+
+		// sizes of the set differences between the elements adjacent to Lp and Lp
+		for(size_t i: Lp)
+		{
+			for(size_t e: elements[i])
+			{
+				if(status[e] != ELEMENT)
+					continue;
+				if(w_mark[e] != stamp)
+				{
+					w_mark[e] = stamp;
+					w[e] = members[e].size();
+				}
+				w[e]--;
+			}
+		}
+
+		// update the quotient graph and the approximate degrees of the vertices of Lp
+		size_t const remaining = n - k - 1;
+		for(size_t i: Lp)
+		{
+			auto &Ei = elements[i];
+			size_t external = 0;
+			size_t last = 0;
+			for(size_t e: Ei)
+			{
+				if(status[e] != ELEMENT)
+					continue;
+				if(w[e] == 0)
+				{
+					// aggressive absorption: e is a subset of the new element
+					status[e] = ABSORBED;
+					std::vector<size_t>().swap(members[e]);
+					continue;
+				}
+				external += w[e];
+				Ei[last++] = e;
+			}
+			Ei.resize(last);
+			Ei.push_back(p);
+
+			// edges to vertices of the new element are implied by it
+			auto &Ai = variables[i];
+			last = 0;
+			for(size_t j: Ai)
+			{
+				if(status[j] == VARIABLE && mark[j] != stamp)
+				{
+					Ai[last++] = j;
+				}
+			}
+			Ai.resize(last);
+
+			size_t d = Ai.size() + (Lp.size()-1) + external;
+			d = std::min(d, degree[i] + Lp.size()-1);
+			d = std::min(d, remaining);
+
+			remove(i);
+			degree[i] = d;
+			insert(i);
+			min_degree = std::min(min_degree, d);
+		}
+
+		members[p].swap(Lp);
+	}
+
+	return index;
+}
+
+
+/**
+ * Approximate minimum degree ordering of the sparsity pattern of A, symmetrized if
+ * needed.  Supports SparseDOK, SparseCRS and SparseCCS matrices.
+ **/
+template<typename Scalar, template<typename> class MatrixStoragePolicy>
+std::vector<size_t>
+approximate_minimum_degree(MatrixStoragePolicy<Scalar> const &A)
+{
+	return approximate_minimum_degree( AdjacencyGraph(A) );
+}
+
+
+}	// namespace mla
+
+#endif
@@ -0,0 +1,698 @@
+#ifndef MLA_PARSER_MATRIX_MARKET_LOADER_HPP
+#define MLA_PARSER_MATRIX_MARKET_LOADER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>	// strtod
+#include <cstring>	// memchr
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <mla/LAException.h++>
+#include <mla/MappedFile.h++>
+#include <mla/ThreadPool.h++>
+
+#include <mla/matrix/SparseCRS.h++>
+#include <mla/matrix/SparseCCS.h++>
+
+
+namespace mla {
+
+namespace detail {
+
+inline bool
+is_blank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+
+inline bool
+is_digit(char c)
+{
+	return static_cast<unsigned>(c - '0') < 10;
+}
+
+
+/**
+ * Parses an unsigned decimal integer, skipping leading blanks
+ *@return	false if there are no digits or the number doesn't fit in a size_t
+ **/
+inline bool
+parse_unsigned(char const *&p, char const *end, size_t &value)
+{
+	while(p < end && is_blank(*p))
+		p++;
+
+	char const *const start = p;
+	size_t v = 0;
+	while(p < end && is_digit(*p))
+	{
+		size_t const d = *p - '0';
+		if(v > (SIZE_MAX - d)/10)
+		{
+			return false;
+		}
+		v = v*10 + d;
+		p++;
+	}
+
+	value = v;
+	return p != start;
+}
+
+
+/**
+ * Parses a real number, skipping leading blanks.
+ *
+ * Numbers with up to 15 significant digits and a decimal exponent within [-22, 22],
+ * which covers most MatrixMarket files, are converted with a single exact product or
+ * quotient of doubles, which is correctly rounded.  Everything else is left to strtod.
+ *@return	false if the text isn't a number
+ **/
+inline bool
+parse_real(char const *&p, char const *end, double &value)
+{
+	static double const powers_of_ten[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	while(p < end && is_blank(*p))
+		p++;
+
+	char const *const start = p;
+
+	bool negative = false;
+	if(p < end && (*p == '-' || *p == '+'))
+	{
+		negative = (*p == '-');
+		p++;
+	}
+
+	uint64_t mantissa = 0;
+	int significant_digits = 0;
+	int exponent = 0;
+	bool has_digits = false;
+
+	for(; p < end && is_digit(*p); p++)
+	{
+		has_digits = true;
+		if(significant_digits < 19)
+		{
+			mantissa = mantissa*10 + (*p - '0');
+			if(mantissa != 0)
+				significant_digits++;
+		}
+		else
+		{
+			significant_digits++;
+			exponent++;
+		}
+	}
+
+	if(p < end && *p == '.')
+	{
+		for(p++; p < end && is_digit(*p); p++)
+		{
+			has_digits = true;
+			if(significant_digits < 19)
+			{
+				mantissa = mantissa*10 + (*p - '0');
+				if(mantissa != 0)
+					significant_digits++;
+				exponent--;
+			}
+			else
+			{
+				significant_digits++;
+			}
+		}
+	}
+
+	bool fast_path = has_digits;
+	if(has_digits && p < end && (*p == 'e' || *p == 'E'))
+	{
+		p++;
+		bool negative_exponent = false;
+		if(p < end && (*p == '-' || *p == '+'))
+		{
+			negative_exponent = (*p == '-');
+			p++;
+		}
+
+		if(p == end || !is_digit(*p))
+		{
+			fast_path = false;
+		}
+
+		int e = 0;
+		for(; p < end && is_digit(*p); p++)
+		{
+			if(e < 100000)
+				e = e*10 + (*p - '0');
+		}
+		exponent += negative_exponent ? -e : e;
+	}
+
+	bool const at_separator = (p == end || is_blank(*p) || *p == '\n');
+
+	if(fast_path && at_separator && significant_digits <= 15 && exponent >= -22 && exponent <= 22)
+	{
+		double v = static_cast<double>(mantissa);
+		v = (exponent < 0) ? v / powers_of_ten[-exponent] : v * powers_of_ten[exponent];
+		value = negative ? -v : v;
+		return true;
+	}
+
+	// slow path: long mantissas, large exponents, inf and nan
+	char const *token_end = start;
+	while(token_end < end && !is_blank(*token_end) && *token_end != '\n')
+		token_end++;
+
+	char buffer[128];
+	size_t const length = token_end - start;
+	if(length == 0 || length >= sizeof(buffer))
+		return false;
+
+	std::memcpy(buffer, start, length);
+	buffer[length] = '\0';
+
+	char *parsed_end;
+	value = std::strtod(buffer, &parsed_end);
+	p = token_end;
+	return parsed_end == buffer + length;
+}
+
+}	// namespace detail
+
+
+
+/**
+ * A loader for MatrixMarket coordinate files that builds SparseCRS and SparseCCS
+ * matrices directly, meant for large files.
+ *
+ * The file is memory-mapped and its entries are split in chunks at line boundaries,
+ * which are parsed by the threads of ThreadPool::global().  The compressed matrix is
+ * then allocated once with the exact number of non-zero elements and filled with a
+ * counting sort.  Symmetric and skew-symmetric files are expanded to both triangles,
+ * and duplicate entries are summed.
+ *
+ * Supports the real, integer and pattern fields.  Use MatrixMarket to parse array and
+ * complex files.
+ */
+class MatrixMarketLoader
+{
+public:
+	enum Field
+	{
+		FIELD_REAL,
+		FIELD_INTEGER,
+		FIELD_PATTERN
+	};
+
+	enum Symmetry
+	{
+		SYMMETRY_GENERAL,
+		SYMMETRY_SYMMETRIC,
+		SYMMETRY_SKEW_SYMMETRIC
+	};
+
+	struct Header
+	{
+		Field	field;
+		Symmetry	symmetry;
+		size_t	rows;
+		size_t	columns;
+		size_t	nnz;	// number of entries stored in the file
+	};
+
+protected:
+	MappedFile	m_file;
+	char const	*m_begin;
+	char const	*m_end;
+	char const	*m_body;	// first line after the size line
+	Header	m_header;
+	size_t	m_chunk_size;
+
+	// entries of a chunk of the file, with 0-based coordinates
+	template<typename Index, typename Scalar>
+	struct Entries
+	{
+		std::vector<Index>	row;
+		std::vector<Index>	column;
+		std::vector<Scalar>	value;
+		std::string	error;
+	};
+
+public:
+	/**
+	 * Maps the file and reads its header
+	 **/
+	explicit MatrixMarketLoader(std::string const &file_name);
+
+	/**
+	 * Reads the file contents from memory, which must outlive the loader
+	 **/
+	MatrixMarketLoader(char const *text, size_t size);
+
+	Header const & header() const	{ return m_header; }
+
+	/**
+	 * Returns the size of the file, in bytes
+	 **/
+	size_t size() const	{ return m_end - m_begin; }
+
+	/**
+	 * Sets the size of the chunks parsed by each task, in bytes
+	 **/
+	void setChunkSize(size_t bytes)	{ m_chunk_size = std::max<size_t>(bytes, 1); }
+
+	template<typename Scalar>
+	void load(matrix::SparseCRS<Scalar> &A) const;
+
+	template<typename Scalar>
+	void load(matrix::SparseCCS<Scalar> &A) const;
+
+protected:
+	void parseHeader();
+
+	/**
+	 * Parses every entry of the file, in the file order
+	 **/
+	template<typename Index, typename Scalar>
+	void parseEntries(std::vector< Entries<Index, Scalar> > &chunks) const;
+
+	template<typename Index, typename Scalar>
+	void parseChunk(char const *p, char const *end, Entries<Index, Scalar> &entries) const;
+
+	/**
+	 * Builds the compressed arrays, with minor indices sorted
+	 *@param by_row	true to compress rows, as in CRS, and false to compress columns
+	 **/
+	template<typename Index, typename Scalar>
+	void compress(bool by_row, std::vector<size_t> &pointer, std::vector<size_t> &index, std::vector<Scalar> &values) const;
+
+	template<typename Scalar>
+	void compress(bool by_row, std::vector<size_t> &pointer, std::vector<size_t> &index, std::vector<Scalar> &values) const;
+};
+
+
+
+inline
+MatrixMarketLoader::MatrixMarketLoader(std::string const &file_name)
+	: m_file(file_name), m_chunk_size(1 << 22)
+{
+	m_begin = m_file.data();
+	m_end = m_begin + m_file.size();
+	parseHeader();
+}
+
+
+inline
+MatrixMarketLoader::MatrixMarketLoader(char const *text, size_t size)
+	: m_begin(text), m_end(text + size), m_chunk_size(1 << 22)
+{
+	parseHeader();
+}
+
+
+inline void
+MatrixMarketLoader::parseHeader()
+{
+	char const *p = m_begin;
+
+	auto line_end = [this](char const *q)
+		{
+			char const *eol = static_cast<char const *>(std::memchr(q, '\n', m_end - q));
+			return eol ? eol : m_end;
+		};
+
+	// banner: %%MatrixMarket matrix <format> <field> <symmetry>
+	char const *eol = line_end(p);
+	std::vector<std::string> tokens;
+	while(p < eol)
+	{
+		while(p < eol && detail::is_blank(*p))
+			p++;
+		char const *const start = p;
+		while(p < eol && !detail::is_blank(*p))
+			p++;
+		if(p > start)
+		{
+			std::string token(start, p);
+			std::transform(token.begin(), token.end(), token.begin(), [](char c){ return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c; });
+			tokens.push_back(token);
+		}
+	}
+
+	if(tokens.size() != 5 || tokens[0] != "%%matrixmarket" || tokens[1] != "matrix")
+	{
+		throw LAException("MatrixMarketLoader: missing %%MatrixMarket matrix banner");
+	}
+	if(tokens[2] != "coordinate")
+	{
+		throw LAException("MatrixMarketLoader: only coordinate files are supported");
+	}
+
+	if(tokens[3] == "real")
+		m_header.field = FIELD_REAL;
+	else if(tokens[3] == "integer")
+		m_header.field = FIELD_INTEGER;
+	else if(tokens[3] == "pattern")
+		m_header.field = FIELD_PATTERN;
+	else
+		throw LAException("MatrixMarketLoader: unsupported field " + tokens[3]);
+
+	if(tokens[4] == "general")
+		m_header.symmetry = SYMMETRY_GENERAL;
+	else if(tokens[4] == "symmetric")
+		m_header.symmetry = SYMMETRY_SYMMETRIC;
+	else if(tokens[4] == "skew-symmetric")
+		m_header.symmetry = SYMMETRY_SKEW_SYMMETRIC;
+	else
+		throw LAException("MatrixMarketLoader: unsupported symmetry " + tokens[4]);
+
+	// skip comments and blank lines up to the size line: <rows> <columns> <nnz>
+	for(p = eol; p < m_end; )
+	{
+		p++;	// past '\n'
+		while(p < m_end && detail::is_blank(*p))
+			p++;
+		if(p < m_end && *p != '%' && *p != '\n')
+			break;
+		p = line_end(p);
+	}
+
+	if( !detail::parse_unsigned(p, m_end, m_header.rows) || !detail::parse_unsigned(p, m_end, m_header.columns) || !detail::parse_unsigned(p, m_end, m_header.nnz) )
+	{
+		throw LAException("MatrixMarketLoader: malformed size line");
+	}
+
+	while(p < m_end && detail::is_blank(*p))
+		p++;
+	if(p < m_end && *p != '\n')
+	{
+		throw LAException("MatrixMarketLoader: malformed size line");
+	}
+
+	if(m_header.symmetry != SYMMETRY_GENERAL && m_header.rows != m_header.columns)
+	{
+		throw LAException("MatrixMarketLoader: symmetric matrices must be square");
+	}
+
+	m_body = std::min(p+1, m_end);
+}
+
+
+template<typename Index, typename Scalar>
+void
+MatrixMarketLoader::parseChunk(char const *p, char const *end, Entries<Index, Scalar> &entries) const
+{
+	size_t const rows = m_header.rows;
+	size_t const columns = m_header.columns;
+	bool const pattern = (m_header.field == FIELD_PATTERN);
+
+	auto fail = [&](char const *where)
+		{
+			entries.error = "MatrixMarketLoader: malformed entry at byte " + std::to_string(where - m_begin);
+		};
+
+	while(p < end)
+	{
+		while(p < end && detail::is_blank(*p))
+			p++;
+		if(p == end)
+			break;
+
+		if(*p == '\n')
+		{
+			p++;
+			continue;
+		}
+		if(*p == '%')
+		{
+			char const *eol = static_cast<char const *>(std::memchr(p, '\n', end - p));
+			p = eol ? eol+1 : end;
+			continue;
+		}
+
+		char const *const line = p;
+		size_t i, j;
+		double value = 1;
+		if( !detail::parse_unsigned(p, end, i) || !detail::parse_unsigned(p, end, j) || (!pattern && !detail::parse_real(p, end, value)) )
+		{
+			return fail(line);
+		}
+
+		while(p < end && detail::is_blank(*p))
+			p++;
+		if(p < end && *p != '\n')
+		{
+			return fail(line);
+		}
+		p++;
+
+		if(i < 1 || i > rows || j < 1 || j > columns)
+		{
+			entries.error = "MatrixMarketLoader: entry out of range at byte " + std::to_string(line - m_begin);
+			return;
+		}
+
+		entries.row.push_back( static_cast<Index>(i-1) );
+		entries.column.push_back( static_cast<Index>(j-1) );
+		entries.value.push_back( static_cast<Scalar>(value) );
+	}
+}
+
+
+template<typename Index, typename Scalar>
+void
+MatrixMarketLoader::parseEntries(std::vector< Entries<Index, Scalar> > &chunks) const
+{
+	size_t const bytes = m_end - m_body;
+	size_t const n_chunks = std::max<size_t>(1, (bytes + m_chunk_size-1)/m_chunk_size);
+
+	// chunk boundaries, moved forward to the start of the next line
+	std::vector<char const *> boundaries(n_chunks+1, m_end);
+	boundaries[0] = m_body;
+	for(size_t c = 1; c < n_chunks; c++)
+	{
+		char const *p = std::max(boundaries[c-1], m_body + c*m_chunk_size);
+		if(p > m_body && p < m_end && p[-1] != '\n')
+		{
+			char const *eol = static_cast<char const *>(std::memchr(p, '\n', m_end - p));
+			p = eol ? eol+1 : m_end;
+		}
+		boundaries[c] = p;
+	}
+
+	chunks.clear();
+	chunks.resize(n_chunks);
+
+	ThreadPool::global().run(n_chunks, [&](size_t c)
+		{
+			// reserve the share of the entries expected in this chunk, though no more than
+			// fit in it, as the shortest entry line ("1 1\n") takes 4 bytes and the header
+			// isn't trusted
+			size_t const chunk_bytes = boundaries[c+1] - boundaries[c];
+			double const share = bytes > 0 ? (double)m_header.nnz*chunk_bytes/bytes*1.05 : 0;
+			size_t const expected = (size_t)std::min(share, (double)(chunk_bytes/4)) + 16;
+			chunks[c].row.reserve(expected);
+			chunks[c].column.reserve(expected);
+			chunks[c].value.reserve(expected);
+
+			parseChunk(boundaries[c], boundaries[c+1], chunks[c]);
+		});
+
+	size_t nnz = 0;
+	for(auto const &chunk: chunks)
+	{
+		if( !chunk.error.empty() )
+		{
+			throw LAException(chunk.error);
+		}
+		nnz += chunk.value.size();
+	}
+
+	if(nnz != m_header.nnz)
+	{
+		throw LAException("MatrixMarketLoader: expected " + std::to_string(m_header.nnz) + " entries, found " + std::to_string(nnz));
+	}
+}
+
+
+template<typename Index, typename Scalar>
+void
+MatrixMarketLoader::compress(bool by_row, std::vector<size_t> &pointer, std::vector<size_t> &index, std::vector<Scalar> &values) const
+{
+	std::vector< Entries<Index, Scalar> > chunks;
+	parseEntries(chunks);
+
+	size_t const n_major = by_row ? m_header.rows : m_header.columns;
+	bool const mirror = (m_header.symmetry != SYMMETRY_GENERAL);
+	Scalar const mirror_sign = (m_header.symmetry == SYMMETRY_SKEW_SYMMETRIC) ? (Scalar)-1 : (Scalar)1;
+
+	// count the elements of each row/column, including the mirrored ones
+	pointer.assign(n_major+1, 0);
+	for(auto const &chunk: chunks)
+	{
+		Index const *major = by_row ? chunk.row.data() : chunk.column.data();
+		Index const *minor = by_row ? chunk.column.data() : chunk.row.data();
+		for(size_t k = 0; k < chunk.value.size(); k++)
+		{
+			pointer[major[k]+1]++;
+			if(mirror && major[k] != minor[k])
+				pointer[minor[k]+1]++;
+		}
+	}
+	for(size_t m = 0; m < n_major; m++)
+	{
+		pointer[m+1] += pointer[m];
+	}
+
+	size_t const nnz = pointer[n_major];
+	index.clear();
+	values.clear();
+	index.resize(nnz);
+	values.resize(nnz);
+
+	// stable scatter, which leaves the minor indices sorted if the file is sorted
+	{
+		std::vector<size_t> next(pointer.begin(), pointer.end()-1);
+		for(auto &chunk: chunks)
+		{
+			Index const *major = by_row ? chunk.row.data() : chunk.column.data();
+			Index const *minor = by_row ? chunk.column.data() : chunk.row.data();
+			for(size_t k = 0; k < chunk.value.size(); k++)
+			{
+				size_t const position = next[major[k]]++;
+				index[position] = minor[k];
+				values[position] = chunk.value[k];
+
+				if(mirror && major[k] != minor[k])
+				{
+					size_t const mirrored = next[minor[k]]++;
+					index[mirrored] = major[k];
+					values[mirrored] = mirror_sign*chunk.value[k];
+				}
+			}
+
+			// release each chunk as soon as it's scattered
+			Entries<Index, Scalar>().row.swap(chunk.row);
+			Entries<Index, Scalar>().column.swap(chunk.column);
+			Entries<Index, Scalar>().value.swap(chunk.value);
+		}
+	}
+
+	// sort the rows/columns that aren't sorted, and sum duplicate entries
+	ThreadPool &pool = ThreadPool::global();
+	size_t const n_parts = std::max<size_t>(1, std::min(n_major, 4*pool.size()));
+	std::vector<size_t> length(n_major);
+	std::atomic<bool> has_duplicates(false);
+
+	pool.run(n_parts, [&](size_t part)
+		{
+			std::vector< std::pair<size_t, Scalar> > entries;
+
+			for(size_t m = n_major*part/n_parts; m < n_major*(part+1)/n_parts; m++)
+			{
+				size_t const begin = pointer[m], end = pointer[m+1];
+
+				bool sorted = true;
+				for(size_t k = begin+1; k < end && sorted; k++)
+				{
+					sorted = index[k-1] < index[k];
+				}
+				if(sorted)
+				{
+					length[m] = end - begin;
+					continue;
+				}
+
+				entries.clear();
+				for(size_t k = begin; k < end; k++)
+				{
+					entries.push_back( std::make_pair(index[k], values[k]) );
+				}
+				std::sort(entries.begin(), entries.end(), [](std::pair<size_t, Scalar> const &a, std::pair<size_t, Scalar> const &b) { return a.first < b.first; });
+
+				size_t last = begin;
+				index[last] = entries[0].first;
+				values[last] = entries[0].second;
+				for(size_t e = 1; e < entries.size(); e++)
+				{
+					if(entries[e].first == index[last])
+					{
+						values[last] += entries[e].second;
+					}
+					else
+					{
+						last++;
+						index[last] = entries[e].first;
+						values[last] = entries[e].second;
+					}
+				}
+
+				length[m] = last+1 - begin;
+				if(length[m] != end - begin)
+					has_duplicates = true;
+			}
+		});
+
+	if(has_duplicates)
+	{
+		size_t position = 0;
+		for(size_t m = 0; m < n_major; m++)
+		{
+			size_t const begin = pointer[m];
+			pointer[m] = position;
+			for(size_t k = begin; k < begin + length[m]; k++, position++)
+			{
+				index[position] = index[k];
+				values[position] = values[k];
+			}
+		}
+		pointer[n_major] = position;
+		index.resize(position);
+		values.resize(position);
+	}
+}
+
+
+template<typename Scalar>
+void
+MatrixMarketLoader::compress(bool by_row, std::vector<size_t> &pointer, std::vector<size_t> &index, std::vector<Scalar> &values) const
+{
+	// 32 bit coordinates halve the memory taken by the parsed entries
+	if(std::max(m_header.rows, m_header.columns) <= std::numeric_limits<uint32_t>::max())
+		compress<uint32_t, Scalar>(by_row, pointer, index, values);
+	else
+		compress<uint64_t, Scalar>(by_row, pointer, index, values);
+}
+
+
+template<typename Scalar>
+void
+MatrixMarketLoader::load(matrix::SparseCRS<Scalar> &A) const
+{
+	compress(true, A.data.row_pointer, A.data.column_index, A.data.values);
+	A.data.n_columns = m_header.columns;
+}
+
+
+template<typename Scalar>
+void
+MatrixMarketLoader::load(matrix::SparseCCS<Scalar> &A) const
+{
+	compress(false, A.data.column_pointer, A.data.row_index, A.data.values);
+	A.data.n_rows = m_header.rows;
+}
+
+
+}	// namespace mla
+
+#endif
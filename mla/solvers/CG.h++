@@ -1,7 +1,9 @@
 #ifndef MLA_SOLVERS_CONJUGATE_GRADIENT_HPP
 #define MLA_SOLVERS_CONJUGATE_GRADIENT_HPP
 
+#include <algorithm>
 #include <string>
+#include <cmath>
 
 #include <boost/lexical_cast.hpp>
 
@@ -14,6 +16,9 @@
 #include <mla/operations/level2/gemv.h++>
 
 #include <mla/solvers/SolverReturnCodes.h++>
+#include <mla/solvers/SolverStatistics.h++>
+#include <mla/solvers/Preconditioners.h++>
+#include <mla/ProgressIndicatorStrategy.h++>
 
 #include <mla/output.h++>
 
@@ -62,7 +67,7 @@ cg(MatrixStoragePolicy<Scalar> &A, VectorStoragePolicyX<Scalar> &x, VectorStorag
 	for (int iter = 0; iter < max_iterations; iter++)
 	{
 		//Ap = A*p;
-		mla::gemv( (Scalar)1.0f, A, p, (Scalar)1.0f, Ap);
+		mla::gemv( (Scalar)1.0f, A, p, (Scalar)0.0f, Ap);
 
 		alpha = dotrr/dot(p,Ap);
 		//x = x + alpha*p;
@@ -89,6 +94,268 @@ cg(MatrixStoragePolicy<Scalar> &A, VectorStoragePolicyX<Scalar> &x, VectorStorag
 }
 
 
+/**
+ * Preconditioned conjugate gradient solver.
+ * The solver keeps its work vectors between solves, so repeated solves of systems of
+ * the same size don't allocate memory.  The preconditioner is set up once by compute()
+ * and reused by every subsequent solve().
+ *
+ *	PCG<double, matrix::SparseCRS, IC0Preconditioner> solver;
+ *	solver.compute(A);
+ *	solver.solve(x, b, 1e-8, 1000);
+ */
+template<typename Scalar, template<typename> class MatrixStoragePolicy, template<typename> class Preconditioner = IdentityPreconditioner>
+class PCG
+{
+protected:
+	MatrixStoragePolicy<Scalar> *m_A;
+	Preconditioner<Scalar>	m_preconditioner;
+
+	// work vectors
+	vector::Dense<Scalar>	m_r, m_z, m_p, m_Ap;
+
+	SolverStatistics	m_statistics;
+
+public:
+	PCG(Preconditioner<Scalar> const &preconditioner = Preconditioner<Scalar>());
+
+	/**
+	 * Sets the system matrix and sets up the preconditioner
+	 *@param A	symmetric positive definite matrix, which must outlive the solver
+	 */
+	void compute(MatrixStoragePolicy<Scalar> &A);
+
+	/**
+	 * Solves [A]{x} = {b}, using the contents of x as the initial guess
+	 *@param x	unknown vector
+	 *@param b	vector
+	 *@param tolerance	relative residual ||b-Ax||/||b|| that stops the iterations
+	 *@param max_iterations	maximum number of iterations allowed
+	 *@param progress	optional progress indicator, updated on each iteration
+	 */
+	ReturnCode solve(vector::Dense<Scalar> &x, vector::Dense<Scalar> const &b, double tolerance, size_t max_iterations, ProgressIndicatorStrategy *progress = nullptr);
+
+	Preconditioner<Scalar> & preconditioner()	{ return m_preconditioner; }
+
+	/**
+	 * Returns the telemetry of the last compute() and solve()
+	 */
+	SolverStatistics const & statistics() const	{ return m_statistics; }
+};
+
+
+
+template<typename Scalar, template<typename> class MatrixStoragePolicy, template<typename> class Preconditioner>
+PCG<Scalar, MatrixStoragePolicy, Preconditioner>::PCG(Preconditioner<Scalar> const &preconditioner)
+	: m_A(nullptr), m_preconditioner(preconditioner)
+{
+}
+
+
+template<typename Scalar, template<typename> class MatrixStoragePolicy, template<typename> class Preconditioner>
+void
+PCG<Scalar, MatrixStoragePolicy, Preconditioner>::compute(MatrixStoragePolicy<Scalar> &A)
+{
+	if( !A.isSquare() )
+	{
+		throw LAException("PCG: A must be a square matrix");
+	}
+
+	Stopwatch stopwatch;
+
+	m_preconditioner.compute(A);
+	m_A = &A;
+
+	m_statistics.clear();
+	m_statistics.setup_time = stopwatch.elapsed();
+}
+
+
+template<typename Scalar, template<typename> class MatrixStoragePolicy, template<typename> class Preconditioner>
+ReturnCode
+PCG<Scalar, MatrixStoragePolicy, Preconditioner>::solve(vector::Dense<Scalar> &x, vector::Dense<Scalar> const &b, double tolerance, size_t max_iterations, ProgressIndicatorStrategy *progress)
+{
+	if(m_A == nullptr)
+	{
+		throw LAException("PCG: compute() wasn't called");
+	}
+
+	MatrixStoragePolicy<Scalar> &A = *m_A;
+	if(A.columns() != b.size())
+	{
+		throw LAException("PCG: A.columns() != b.size()");
+	}
+
+	bool const identity = Preconditioner<Scalar>::is_identity();
+	size_t const n = b.size();
+
+	double const setup_time = m_statistics.setup_time;
+	m_statistics.clear();
+	m_statistics.setup_time = setup_time;
+	// in exact arithmetic CG converges within n iterations, so this usually covers the
+	// history without reserving for an iteration cap that may be far larger
+	m_statistics.residual_history.reserve(std::min<size_t>(max_iterations, n) + 1);
+
+	Stopwatch solve_stopwatch, phase;
+
+	if(x.size() != n)
+	{
+		x.resize(n);
+		x.setZero();
+	}
+	m_r.resize(n);
+	m_p.resize(n);
+	m_Ap.resize(n);
+	if( !identity )
+	{
+		m_z.resize(n);
+	}
+
+	Scalar *x_data = x.data.data();
+	Scalar *r = m_r.data.data();
+	Scalar *p = m_p.data.data();
+	Scalar *Ap = m_Ap.data.data();
+	Scalar *z = identity ? r : m_z.data.data();	// without preconditioning, z = r
+
+	// r = b - A*x
+	phase.restart();
+	m_r.data = b.data;
+	mla::gemv( (Scalar)-1, A, x, (Scalar)1, m_r);
+	m_statistics.matvec_time += phase.lap();
+
+	double b_norm = 0, r_norm = 0;
+	for(size_t i = 0; i < n; i++)
+	{
+		b_norm += (double)b.data[i]*b.data[i];
+		r_norm += (double)r[i]*r[i];
+	}
+	b_norm = std::sqrt(b_norm);
+	m_statistics.vector_time += phase.lap();
+
+	if(b_norm == 0)
+	{
+		// the solution of a homogeneous system is the null vector
+		x.setZero();
+		m_statistics.residual_history.push_back(0);
+		m_statistics.solve_time = solve_stopwatch.elapsed();
+		return OK;
+	}
+
+	double residual = std::sqrt(r_norm)/b_norm;
+	m_statistics.residual_history.push_back(residual);
+
+	if(progress)
+	{
+		progress->markSectionStart("Conjugate gradient");
+		progress->markSectionLimit(max_iterations);
+	}
+
+	ReturnCode code = ERR_EXCESSIVE_ITERATIONS;
+
+	if(residual <= tolerance)
+	{
+		code = OK;
+	}
+	else
+	{
+		// z = M^-1 r, p = z
+		if( !identity )
+		{
+			m_preconditioner.apply(m_r, m_z);
+			m_statistics.preconditioner_time += phase.lap();
+		}
+
+		Scalar rz = 0;
+		for(size_t i = 0; i < n; i++)
+		{
+			p[i] = z[i];
+			rz += r[i]*z[i];
+		}
+		m_statistics.vector_time += phase.lap();
+
+		for(size_t iter = 1; iter <= max_iterations; iter++)
+		{
+			// Ap = A*p
+			mla::gemv( (Scalar)1, A, m_p, (Scalar)0, m_Ap);
+			m_statistics.matvec_time += phase.lap();
+
+			Scalar pAp = 0;
+			for(size_t i = 0; i < n; i++)
+			{
+				pAp += p[i]*Ap[i];
+			}
+
+			if( !(pAp > 0) )
+			{
+				m_statistics.vector_time += phase.lap();
+				code = ERR_NOT_POSITIVE_DEFINITE;
+				break;
+			}
+
+			Scalar const alpha = rz/pAp;
+
+			// x = x + alpha*p, r = r - alpha*Ap, in a single pass
+			Scalar rr = 0;
+			for(size_t i = 0; i < n; i++)
+			{
+				x_data[i] += alpha*p[i];
+				r[i] -= alpha*Ap[i];
+				rr += r[i]*r[i];
+			}
+			m_statistics.vector_time += phase.lap();
+
+			m_statistics.iterations = iter;
+			residual = std::sqrt((double)rr)/b_norm;
+			m_statistics.residual_history.push_back(residual);
+
+			if(progress)
+			{
+				progress->markSectionIterationIncrement();
+			}
+
+			if(residual <= tolerance)
+			{
+				code = OK;
+				break;
+			}
+
+			// z = M^-1 r
+			Scalar rz_new = rr;
+			if( !identity )
+			{
+				m_preconditioner.apply(m_r, m_z);
+				m_statistics.preconditioner_time += phase.lap();
+
+				rz_new = 0;
+				for(size_t i = 0; i < n; i++)
+				{
+					rz_new += r[i]*z[i];
+				}
+			}
+
+			// p = z + beta*p
+			Scalar const beta = rz_new/rz;
+			for(size_t i = 0; i < n; i++)
+			{
+				p[i] = z[i] + beta*p[i];
+			}
+			m_statistics.vector_time += phase.lap();
+
+			rz = rz_new;
+		}
+	}
+
+	if(progress)
+	{
+		progress->markSectionEnd();
+	}
+
+	m_statistics.solve_time = solve_stopwatch.elapsed();
+
+	return code;
+}
+
+
 }
 
 #endif
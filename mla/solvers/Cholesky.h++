@@ -4,57 +4,62 @@
 
 #include <cmath>
 
-#include <solvers/SolverReturnCodes.h++>
-#include <solvers/substitution.h++>
+#include <mla/LAException.h++>
+#include <mla/solvers/SolverReturnCodes.h++>
+#include <mla/solvers/substitution.h++>
+#include <mla/solvers/SparseCholesky.h++>
 
-#include <mla/Matrix.h++>
-#include <mla/output.h++>
+#include <mla/matrix/all.h++>
+#include <mla/vector/all.h++>
 
 namespace mla
 {
 
 /**
-Generic cholesky decomposition for dense matrices, works on all matrix types
+Generic cholesky decomposition for dense matrices, works on all matrix types.
+Stores the factor in the dense matrix L and solves [A]{x} = {b}.
 **/
-template<typename Scalar, template<typename> class MatrixStoragePolicy, template<typename> class LMatrixStoragePolicy, template<typename> class VectorStoragePolicy>
+template<typename Scalar, template<typename> class MatrixStoragePolicy>
 ReturnCode 
-cholesky(Matrix<Scalar, MatrixStoragePolicy> &A, Vector<Scalar, VectorStoragePolicy> &x, Vector<Scalar, VectorStoragePolicy> &b, Matrix<Scalar, LMatrixStoragePolicy> &L)
+cholesky(MatrixStoragePolicy<Scalar> const &A, vector::Dense<Scalar> &x, vector::Dense<Scalar> const &b, matrix::DenseRowMajor<Scalar> &L)
 {
 	if( !A.isSquare() )
 	{
 		throw LAException("A must be a square matrix");
 	}
-	if(A.columns() == b.size())
+	if(A.columns() != b.size())
 	{
 		throw LAException("A.columns() != b.size()");
 	}
 
-	Vector<Scalar> S;
-	S.resize(A.columns());
+	size_t const n = A.rows();
+	L.resize(n, n);
+	L.setZero();
 
-	// A=LL^t, factor L
-	for(size_t j = 0; j < A.columns(); j++)
+	// A=LL^t, factor L, one column at a time
+	for(size_t j = 0; j < n; j++)
 	{
-		for(size_t i = j; i < A.rows(); i++)
+		for(size_t i = j; i < n; i++)
 		{
-			Scalar Si;
-			Si = A.getValue(i,j);
+			Scalar Si = A.getValue(i,j);
 			for(size_t k = 0; k < j; k++)
 			{
 				Si -= L.getValue(i,k)*L.getValue(j,k);
 			}
-			S(i) = Si;
-		}
 
-		
-		Scalar diag = L(j,j) = sqrt(S(j));
+			if(i == j)
+			{
+				if( !(Si > 0) )
+					return ERR_NOT_POSITIVE_DEFINITE;
 
-		for(size_t i = j+1; i < A.rows(); i++)
-		{
-			L(i,j) = S(i)/diag;
+				L.setValue(j, j, std::sqrt(Si));
+			}
+			else
+			{
+				L.setValue(i, j, Si/L.getValue(j,j));
+			}
 		}
 	}
-	// */
 
 
 	ReturnCode code;
@@ -63,7 +68,7 @@ cholesky(Matrix<Scalar, MatrixStoragePolicy> &A, Vector<Scalar, VectorStoragePol
 	if(code != OK)
 		return code;
 
-	//Lx=y
+	//L^tx=y
 	code = back_substitution(L,x,x);
 	if(code != OK)
 		return code;
@@ -74,183 +79,37 @@ cholesky(Matrix<Scalar, MatrixStoragePolicy> &A, Vector<Scalar, VectorStoragePol
 
 
 /**
-Generic cholesky decomposition for dense matrices, works on all matrix types
+Sparse cholesky decomposition, solves [A]{x} = {b} with a supernodal factorization of
+the reordered matrix.  Use SparseCholesky directly to reuse the factorization.
 **/
-template<typename Scalar, template<typename> class MatrixStoragePolicy, template<typename> class VectorStoragePolicy>
+template<typename Scalar>
 ReturnCode 
-cholesky(Matrix<Scalar, MatrixStoragePolicy> &A, Vector<Scalar, VectorStoragePolicy> &x, Vector<Scalar, VectorStoragePolicy> &b, Matrix<Scalar, SparseCRS> &L)
+cholesky(matrix::SparseCCS<Scalar> const &A, vector::Dense<Scalar> &x, vector::Dense<Scalar> const &b)
 {
-	if( !A.isSquare() )
-	{
-		throw LAException("A must be a square matrix");
-	}
-	if(A.columns() == b.size())
-	{
-		throw LAException("A.columns() != b.size()");
-	}
-
-	Vector<Scalar, SparseCS> S;
-	S.reserve(A.columns());
-	S.resize(A.columns());
-
-	size_t *p;
-	Scalar *lp;
-	size_t *q;
-	Scalar *lq;
-
-	// A=LL^t, factor L
-	for(size_t j = 0; j < A.columns(); j++)
-	{
-		S.clear();
-		Scalar Si;	// temp variable to avoid calling S(i)
-		// unrolling the for(i = j;...) part of the for loop
-		Si = A.getValue(j,j);
-		p = &L.data.column_index[L.data.row_pointer[j]] ;
-		lp = &L.data.values[L.data.row_pointer[j]];
-		while(*p < j)
-		{
-			Si -= (*lp)*(*lp);
-	
-			p++;
-			lp++;
-		}
-		//S(j) = Si;
-		S.push_back(j,Si);
-
-		// continuing the remaining for loop
-		for(size_t i = j+1; i < A.rows(); i++)
-		{
-			Si = A.getValue(i,j);
-		
-			p = &L.data.column_index[L.data.row_pointer[i]] ;
-			lp = &L.data.values[L.data.row_pointer[i]];
-			q = &L.data.column_index[L.data.row_pointer[j]] ;
-			lq = &L.data.values[L.data.row_pointer[j]] ;
-
-			while( (*p < j) && (*q < j) )
-			{
-				if(*p == *q)
-				{
-					Si -= (*lp)*(*lq);
-			
-					p++;
-					lp++;
-
-					q++;
-					lq++;
-				}
-				else if(*p < *q)
-				{
-					p++;
-					lp++;
-				}
-				else
-				{
-					q++;
-					lq++;
-				}
-			}
-			// */
-
-			//S(i) = Si;
-			S.push_back(i,Si);
-		}
-
-		Scalar diag;
-		diag = L(j,j) = sqrt(S(j));
-
-		for(size_t i = 1; i < S.data.values.size(); i++)
-		{
-			L(S.data.column_index[i],j) = S.data.values[i]/diag;
-		}
-	}
-
-	// */
-
-
-	ReturnCode code;
-	// Ly = b
-	code = forward_substitution(L,x,b);
-	if(code != OK)
-		return code;
+	SparseCholesky<Scalar> factorization;
 
-	//Lx=y
-	code = back_substitution(L,x,x);
+	ReturnCode code = factorization.factorize(A);
 	if(code != OK)
 		return code;
 
-	return OK;
+	return factorization.solve(x, b);
 }
 
 
-/**
-Generic cholesky decomposition for dense matrices, works on all matrix types
-**/
-template<typename Scalar, template<typename> class MatrixStoragePolicy, template<typename> class VectorStoragePolicy>
+template<typename Scalar>
 ReturnCode 
-cholesky(Matrix<Scalar, MatrixStoragePolicy> &A, Vector<Scalar, VectorStoragePolicy> &x, Vector<Scalar, VectorStoragePolicy> &b, Matrix<Scalar> &L)
+cholesky(matrix::SparseCRS<Scalar> const &A, vector::Dense<Scalar> &x, vector::Dense<Scalar> const &b)
 {
-	if(A.rows() != A.columns())
-	{
-		throw LAException("A.rows() != A.columns()");
-	}
-	if(A.columns() == b.size())
-	{
-		throw LAException("A.columns() != b.size()");
-	}
-
-	Vector<Scalar> S;
-	S.resize(A.columns());
+	SparseCholesky<Scalar> factorization;
 
-	// A=LL^t, factor L
-	for(size_t j = 0; j < A.columns(); j++)
-	{
-		for(size_t i = j; i < A.rows(); i++)
-		{
-			Scalar Si;
-			Scalar *li, *lj;
-
-			Si = A.getValue(i,j);
-			li = &L.data.data[i*L.data.t_rows];
-			lj = &L.data.data[j*L.data.t_rows];
-			for(size_t k = 0; k < j; k++)
-			{
-				//Si -= L.getValue(i,k)*L.getValue(j,k);
-				Si -= (*li)*(*lj);
-				++li;
-				++lj;
-			}
-			S(i) = Si;
-		}
-
-		
-		Scalar diag = L(j,j) = sqrt(S(j));
-
-		for(size_t i = j+1; i < A.rows(); i++)
-		{
-			L(i,j) = S(i)/diag;
-		}
-	}
-	// */
-
-
-	ReturnCode code;
-	// Ly = b
-	code = forward_substitution(L,x,b);
+	ReturnCode code = factorization.factorize(A);
 	if(code != OK)
 		return code;
 
-	//Lx=y
-	code = back_substitution(L,x,x);
-	if(code != OK)
-		return code;
-
-
-	return OK;
+	return factorization.solve(x, b);
 }
 
 
 }	// namespace mla
 
 #endif
-
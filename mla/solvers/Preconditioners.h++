@@ -0,0 +1,426 @@
+#ifndef MLA_SOLVERS_PRECONDITIONERS_HPP
+#define MLA_SOLVERS_PRECONDITIONERS_HPP
+
+#include <cmath>
+#include <vector>
+
+#include <mla/LAException.h++>
+
+#include <mla/matrix/Diagonal.h++>
+#include <mla/matrix/SparseCRS.h++>
+#include <mla/vector/Dense.h++>
+
+
+namespace mla
+{
+
+/**
+ * Preconditioners used by the PCG solver.  Each class provides:
+ *	compute(A)	sets up the preconditioner M for matrix A
+ *	apply(r, z)	solves M{z} = {r}
+ *	is_identity()	true if apply() leaves r unchanged, which lets solvers skip it
+ **/
+
+
+/**
+ * No preconditioning: M = I
+ **/
+template<typename Scalar>
+class IdentityPreconditioner
+{
+public:
+	static constexpr bool is_identity() noexcept { return true; }
+
+	template<template<typename> class MatrixStoragePolicy>
+	void compute(MatrixStoragePolicy<Scalar> const &) { }
+
+	void apply(vector::Dense<Scalar> const &r, vector::Dense<Scalar> &z) const
+	{
+		z.data = r.data;
+	}
+};
+
+
+/**
+ * Jacobi preconditioner: M = diag(A)
+ **/
+template<typename Scalar>
+class JacobiPreconditioner
+{
+protected:
+	matrix::Diagonal<Scalar> m_inverse_diagonal;
+
+public:
+	static constexpr bool is_identity() noexcept { return false; }
+
+	template<template<typename> class MatrixStoragePolicy>
+	void compute(MatrixStoragePolicy<Scalar> const &A);
+
+	void compute(matrix::SparseCRS<Scalar> const &A);
+
+	void apply(vector::Dense<Scalar> const &r, vector::Dense<Scalar> &z) const;
+
+	matrix::Diagonal<Scalar> const & inverseDiagonal() const	{ return m_inverse_diagonal; }
+
+protected:
+	void invert();
+};
+
+
+/**
+ * Symmetric successive over-relaxation preconditioner
+ * M = w/(2-w) (D/w + L) (D/w)^-1 (D/w + U)
+ **/
+template<typename Scalar>
+class SSORPreconditioner
+{
+protected:
+	matrix::SparseCRS<Scalar> const *m_A;
+	std::vector<size_t> m_diagonal_index;	// position of the diagonal element of each row
+	Scalar m_omega;
+
+public:
+	SSORPreconditioner(Scalar omega = 1);
+
+	static constexpr bool is_identity() noexcept { return false; }
+
+	void compute(matrix::SparseCRS<Scalar> const &A);
+
+	void apply(vector::Dense<Scalar> const &r, vector::Dense<Scalar> &z) const;
+};
+
+
+/**
+ * Incomplete Cholesky factorization with no fill-in, M = L L^T, where L has the
+ * sparsity pattern of the lower triangle of A.  IC(0) may break down on SPD matrices
+ * which aren't M-matrices, in which case the factorization of A + shift*diag(A) can be
+ * used instead.
+ **/
+template<typename Scalar>
+class IC0Preconditioner
+{
+protected:
+	matrix::SparseCRS<Scalar> m_L;
+	Scalar m_shift;
+
+public:
+	IC0Preconditioner(Scalar shift = 0);
+
+	static constexpr bool is_identity() noexcept { return false; }
+
+	void compute(matrix::SparseCRS<Scalar> const &A);
+
+	void apply(vector::Dense<Scalar> const &r, vector::Dense<Scalar> &z) const;
+
+	matrix::SparseCRS<Scalar> const & factor() const	{ return m_L; }
+};
+
+
+
+// === Jacobi
+
+template<typename Scalar>
+template<template<typename> class MatrixStoragePolicy>
+void
+JacobiPreconditioner<Scalar>::compute(MatrixStoragePolicy<Scalar> const &A)
+{
+	if( !A.isSquare() )
+	{
+		throw LAException("JacobiPreconditioner: A must be a square matrix");
+	}
+
+	m_inverse_diagonal.resize(A.rows(), A.columns());
+	for(size_t i = 0; i < A.rows(); i++)
+	{
+		m_inverse_diagonal.data.data[i] = A.getValue(i,i);
+	}
+
+	invert();
+}
+
+
+template<typename Scalar>
+void
+JacobiPreconditioner<Scalar>::compute(matrix::SparseCRS<Scalar> const &A)
+{
+	if( !A.isSquare() )
+	{
+		throw LAException("JacobiPreconditioner: A must be a square matrix");
+	}
+
+	m_inverse_diagonal.resize(A.rows(), A.columns());
+	m_inverse_diagonal.setZero();
+
+	auto const &data = A.data;
+	for(size_t i = 0; i < A.rows(); i++)
+	{
+		for(size_t k = data.row_pointer[i]; k < data.row_pointer[i+1]; k++)
+		{
+			if(data.column_index[k] == i)
+			{
+				m_inverse_diagonal.data.data[i] = data.values[k];
+				break;
+			}
+		}
+	}
+
+	invert();
+}
+
+
+template<typename Scalar>
+void
+JacobiPreconditioner<Scalar>::invert()
+{
+	for(auto &d: m_inverse_diagonal.data.data)
+	{
+		if(d == (Scalar)0)
+		{
+			throw LAException("JacobiPreconditioner: zero diagonal element");
+		}
+		d = (Scalar)1/d;
+	}
+}
+
+
+template<typename Scalar>
+void
+JacobiPreconditioner<Scalar>::apply(vector::Dense<Scalar> const &r, vector::Dense<Scalar> &z) const
+{
+	Scalar const *d = m_inverse_diagonal.data.data.data();
+	Scalar const *r_data = r.data.data();
+	Scalar *z_data = z.data.data();
+
+	size_t const n = r.size();
+	for(size_t i = 0; i < n; i++)
+	{
+		z_data[i] = d[i]*r_data[i];
+	}
+}
+
+
+// === SSOR
+
+template<typename Scalar>
+SSORPreconditioner<Scalar>::SSORPreconditioner(Scalar omega)
+	: m_A(nullptr), m_omega(omega)
+{
+	if( !(omega > 0 && omega < 2) )
+	{
+		throw LAException("SSORPreconditioner: omega must be in ]0,2[");
+	}
+}
+
+
+template<typename Scalar>
+void
+SSORPreconditioner<Scalar>::compute(matrix::SparseCRS<Scalar> const &A)
+{
+	if( !A.isSquare() )
+	{
+		throw LAException("SSORPreconditioner: A must be a square matrix");
+	}
+
+	auto const &data = A.data;
+
+	m_diagonal_index.resize(A.rows());
+	for(size_t i = 0; i < A.rows(); i++)
+	{
+		size_t k = data.row_pointer[i];
+		while(k < data.row_pointer[i+1] && data.column_index[k] < i)
+			k++;
+
+		if(k == data.row_pointer[i+1] || data.column_index[k] != i || data.values[k] == (Scalar)0)
+		{
+			throw LAException("SSORPreconditioner: zero diagonal element");
+		}
+
+		m_diagonal_index[i] = k;
+	}
+
+	m_A = &A;
+}
+
+
+template<typename Scalar>
+void
+SSORPreconditioner<Scalar>::apply(vector::Dense<Scalar> const &r, vector::Dense<Scalar> &z) const
+{
+	if(m_A == nullptr)
+	{
+		throw LAException("SSORPreconditioner: compute() wasn't called");
+	}
+
+	size_t const *row_pointer = m_A->data.row_pointer.data();
+	size_t const *column_index = m_A->data.column_index.data();
+	Scalar const *values = m_A->data.values.data();
+	size_t const *diagonal = m_diagonal_index.data();
+
+	Scalar const *r_data = r.data.data();
+	Scalar *z_data = z.data.data();
+	Scalar const omega = m_omega;
+	size_t const n = r.size();
+
+	// forward sweep: (D + wL) t = r, then t := D t
+	for(size_t i = 0; i < n; i++)
+	{
+		Scalar sum = 0;
+		for(size_t k = row_pointer[i]; k < diagonal[i]; k++)
+		{
+			sum += values[k]*z_data[column_index[k]];
+		}
+		z_data[i] = (r_data[i] - omega*sum)/values[diagonal[i]];
+	}
+	for(size_t i = 0; i < n; i++)
+	{
+		z_data[i] *= values[diagonal[i]];
+	}
+
+	// backward sweep: (D + wU) z = t
+	Scalar const scale = omega*(2 - omega);
+	for(size_t i = n; i-- > 0; )
+	{
+		Scalar sum = 0;
+		for(size_t k = diagonal[i]+1; k < row_pointer[i+1]; k++)
+		{
+			sum += values[k]*z_data[column_index[k]];
+		}
+		z_data[i] = (z_data[i] - omega*sum)/values[diagonal[i]];
+	}
+	for(size_t i = 0; i < n; i++)
+	{
+		z_data[i] *= scale;
+	}
+}
+
+
+// === IC(0)
+
+template<typename Scalar>
+IC0Preconditioner<Scalar>::IC0Preconditioner(Scalar shift)
+	: m_shift(shift)
+{
+	if(shift < 0)
+	{
+		throw LAException("IC0Preconditioner: shift must not be negative");
+	}
+}
+
+
+template<typename Scalar>
+void
+IC0Preconditioner<Scalar>::compute(matrix::SparseCRS<Scalar> const &A)
+{
+	if( !A.isSquare() )
+	{
+		throw LAException("IC0Preconditioner: A must be a square matrix");
+	}
+
+	auto const &data = A.data;
+	size_t const n = A.rows();
+
+	// copy the lower triangle of A, diagonal included
+	auto &L = m_L.data;
+	L.n_columns = n;
+	L.row_pointer.assign(n+1, 0);
+	L.column_index.clear();
+	L.values.clear();
+
+	for(size_t i = 0; i < n; i++)
+	{
+		L.row_pointer[i] = L.values.size();
+		for(size_t k = data.row_pointer[i]; k < data.row_pointer[i+1] && data.column_index[k] <= i; k++)
+		{
+			L.column_index.push_back(data.column_index[k]);
+			L.values.push_back(data.values[k]);
+		}
+
+		if(L.values.size() == L.row_pointer[i] || L.column_index.back() != i)
+		{
+			throw LAException("IC0Preconditioner: missing diagonal element");
+		}
+		L.values.back() *= 1 + m_shift;
+	}
+	L.row_pointer[n] = L.values.size();
+
+	// factor row by row: each row only uses rows that are already factored
+	for(size_t i = 0; i < n; i++)
+	{
+		size_t const i_begin = L.row_pointer[i];
+		size_t const i_diagonal = L.row_pointer[i+1]-1;
+
+		for(size_t p = i_begin; p <= i_diagonal; p++)
+		{
+			size_t const k = L.column_index[p];
+
+			// sum of L(i,j)*L(k,j) over j < k
+			size_t q = L.row_pointer[k];
+			size_t const k_diagonal = L.row_pointer[k+1]-1;
+			Scalar sum = 0;
+			for(size_t s = i_begin; s < p; s++)
+			{
+				size_t const j = L.column_index[s];
+				while(q < k_diagonal && L.column_index[q] < j)
+					q++;
+				if(q < k_diagonal && L.column_index[q] == j)
+					sum += L.values[s]*L.values[q];
+			}
+
+			if(k < i)
+			{
+				L.values[p] = (L.values[p] - sum)/L.values[k_diagonal];
+			}
+			else
+			{
+				Scalar const pivot = L.values[p] - sum;
+				if( !(pivot > 0) )
+				{
+					throw LAException("IC0Preconditioner: non-positive pivot");
+				}
+				L.values[p] = std::sqrt(pivot);
+			}
+		}
+	}
+}
+
+
+template<typename Scalar>
+void
+IC0Preconditioner<Scalar>::apply(vector::Dense<Scalar> const &r, vector::Dense<Scalar> &z) const
+{
+	size_t const *row_pointer = m_L.data.row_pointer.data();
+	size_t const *column_index = m_L.data.column_index.data();
+	Scalar const *values = m_L.data.values.data();
+
+	Scalar const *r_data = r.data.data();
+	Scalar *z_data = z.data.data();
+	size_t const n = r.size();
+
+	// L y = r
+	for(size_t i = 0; i < n; i++)
+	{
+		size_t const diagonal = row_pointer[i+1]-1;
+		Scalar sum = r_data[i];
+		for(size_t k = row_pointer[i]; k < diagonal; k++)
+		{
+			sum -= values[k]*z_data[column_index[k]];
+		}
+		z_data[i] = sum/values[diagonal];
+	}
+
+	// L^T z = y, column-oriented over the rows of L
+	for(size_t i = n; i-- > 0; )
+	{
+		size_t const diagonal = row_pointer[i+1]-1;
+		Scalar const z_i = z_data[i] /= values[diagonal];
+		for(size_t k = row_pointer[i]; k < diagonal; k++)
+		{
+			z_data[column_index[k]] -= values[k]*z_i;
+		}
+	}
+}
+
+
+}	// namespace mla
+
+#endif
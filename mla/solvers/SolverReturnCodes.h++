@@ -8,7 +8,8 @@ namespace mla
 		OK = 0,
 		ERR_EXCESSIVE_ITERATIONS,
 		ERR_NOT_SQUARE,
-		ERR_SINGULAR_MATRIX
+		ERR_SINGULAR_MATRIX,
+		ERR_NOT_POSITIVE_DEFINITE
 
 	};
 }
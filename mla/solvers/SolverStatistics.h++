@@ -0,0 +1,79 @@
+#ifndef MLA_SOLVERS_SOLVER_STATISTICS_HPP
+#define MLA_SOLVERS_SOLVER_STATISTICS_HPP
+
+#include <vector>
+#include <chrono>
+
+
+namespace mla
+{
+
+/**
+ * Telemetry gathered by the iterative solvers during a solve
+ **/
+struct SolverStatistics
+{
+	size_t	iterations;	// number of iterations performed
+
+	// relative residual norm ||r||/||b||, starting with the initial residual
+	std::vector<double>	residual_history;
+
+	// wall-clock time spent in each phase, in seconds
+	double	setup_time;		// preconditioner set up
+	double	matvec_time;		// matrix-vector products
+	double	preconditioner_time;	// preconditioner applications
+	double	vector_time;		// vector updates and dot products
+	double	solve_time;		// whole solve, set up excluded
+
+	SolverStatistics()	{ clear(); }
+
+	void clear()
+	{
+		iterations = 0;
+		residual_history.clear();
+		setup_time = 0;
+		matvec_time = 0;
+		preconditioner_time = 0;
+		vector_time = 0;
+		solve_time = 0;
+	}
+};
+
+
+/**
+ * Helper that measures elapsed wall-clock time
+ **/
+class Stopwatch
+{
+protected:
+	std::chrono::steady_clock::time_point m_start;
+
+public:
+	Stopwatch(): m_start(std::chrono::steady_clock::now())	{ }
+
+	void restart()	{ m_start = std::chrono::steady_clock::now(); }
+
+	/**
+	 * Returns the seconds elapsed since the last restart
+	 **/
+	double elapsed() const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+	}
+
+	/**
+	 * Returns the seconds elapsed since the last restart, and restarts
+	 **/
+	double lap()
+	{
+		auto now = std::chrono::steady_clock::now();
+		double seconds = std::chrono::duration<double>(now - m_start).count();
+		m_start = now;
+		return seconds;
+	}
+};
+
+
+}	// namespace mla
+
+#endif
@@ -0,0 +1,928 @@
+#ifndef MLA_SOLVERS_SPARSE_CHOLESKY_HPP
+#define MLA_SOLVERS_SPARSE_CHOLESKY_HPP
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <mla/LAException.h++>
+#include <mla/solvers/SolverReturnCodes.h++>
+
+#include <mla/matrix/SparseCRS.h++>
+#include <mla/matrix/SparseCCS.h++>
+#include <mla/matrix/Assembler.h++>
+#include <mla/vector/Dense.h++>
+
+#include <mla/operations/AdjacencyGraph.h++>
+#include <mla/operations/cuthill_mckee.h++>
+#include <mla/operations/minimum_degree.h++>
+
+
+namespace mla
+{
+
+/**
+ * Supernodal sparse Cholesky factorization P A P^T = L L^T of a symmetric positive
+ * definite matrix, for SparseCCS and SparseCRS matrices.  Only the lower triangle of A
+ * is read, so A may store either its lower triangle or both triangles.
+ *
+ * The factorization is split in two steps:
+ *	analyze(A)	fill-reducing ordering, elimination tree and symbolic factorization,
+ *			which only depend on the sparsity pattern of A
+ *	factorize(A)	left-looking supernodal numeric factorization, which can be repeated
+ *			for matrices with the analyzed sparsity pattern
+ *
+ * Columns of L with the same structure are grouped in supernodes, whose values are
+ * stored as dense column-major blocks.  The updates between supernodes and the
+ * factorization of each supernode are computed with dense kernels.
+ *
+ *	SparseCholesky<double> cholesky;
+ *	cholesky.factorize(A);
+ *	cholesky.solve(x, b);
+ **/
+template<typename Scalar>
+class SparseCholesky
+{
+public:
+	typedef Scalar scalar_type;
+
+	enum Ordering
+	{
+		ORDERING_NATURAL,	// no reordering
+		ORDERING_RCM,		// reverse Cuthill-McKee
+		ORDERING_AMD		// approximate minimum degree
+	};
+
+	struct Data
+	{
+		size_t	n;	// number of rows and columns
+
+		std::vector<size_t>	permutation;	// permutation[k] is the row/column of A in position k
+		std::vector<size_t>	inverse_permutation;
+
+		std::vector<size_t>	parent;		// elimination tree, where parent[j] == n marks a root
+		std::vector<size_t>	column_count;	// number of non-zero elements of each column of L
+
+		// supernode s holds the columns supernode_pointer[s] ... supernode_pointer[s+1]-1
+		std::vector<size_t>	supernode_pointer;
+		std::vector<size_t>	column_supernode;	// supernode of each column
+
+		// rows of supernode s: row_index[row_pointer[s]] ... row_index[row_pointer[s+1]-1]
+		std::vector<size_t>	row_pointer;
+		std::vector<size_t>	row_index;
+
+		// values of supernode s, a column-major block starting at values[value_pointer[s]]
+		std::vector<size_t>	value_pointer;
+		std::vector<Scalar>	values;
+	} data;
+
+protected:
+	Ordering	m_ordering;
+	bool	m_analyzed;
+	bool	m_factorized;
+
+	matrix::Assembler<Scalar>	m_assembler;	// gathers the lower triangle of P A P^T
+	matrix::SparseCCS<Scalar>	m_C;		// lower triangle of P A P^T
+
+	// numeric factorization and solve workspace
+	std::vector<size_t>	m_relative;
+	std::vector<size_t>	m_link_head;
+	std::vector<size_t>	m_link_next;
+	std::vector<size_t>	m_position;
+	std::vector<Scalar>	m_update;
+	std::vector<Scalar>	m_y;
+
+public:
+	SparseCholesky(Ordering ordering = ORDERING_AMD);
+
+	/**
+	 * Computes the ordering and the symbolic factorization of A
+	 **/
+	void analyze(matrix::SparseCCS<Scalar> const &A);
+	void analyze(matrix::SparseCRS<Scalar> const &A);
+
+	/**
+	 * Computes the numeric factorization of A, analyzing A first if no sparsity pattern
+	 * was analyzed.  Throws LAException if A doesn't have the analyzed sparsity pattern.
+	 *@return	ERR_NOT_POSITIVE_DEFINITE if a pivot isn't positive
+	 **/
+	ReturnCode factorize(matrix::SparseCCS<Scalar> const &A);
+	ReturnCode factorize(matrix::SparseCRS<Scalar> const &A);
+
+	/**
+	 * Solves [A]{x} = {b} with the current factorization
+	 **/
+	ReturnCode solve(vector::Dense<Scalar> &x, vector::Dense<Scalar> const &b);
+
+	bool isAnalyzed() const		{ return m_analyzed; }
+	bool isFactorized() const	{ return m_factorized; }
+
+	size_t rows() const	{ return data.n; }
+	size_t columns() const	{ return data.n; }
+
+	/**
+	 * Returns the number of non-zero elements of L, diagonal included
+	 **/
+	size_t nnz() const;
+
+	/**
+	 * Returns the number of floating point operations of the numeric factorization
+	 **/
+	double flops() const;
+
+	size_t supernodes() const	{ return data.supernode_pointer.size()-1; }
+
+	/**
+	 * Copies the factor L of P A P^T = L L^T
+	 **/
+	void getFactor(matrix::SparseCCS<Scalar> &L) const;
+
+protected:
+	/**
+	 * Calls visit(row, column, value) for each element of the lower triangle of A
+	 **/
+	template<typename Visitor>
+	static void forEachLower(matrix::SparseCCS<Scalar> const &A, Visitor visit);
+
+	template<typename Visitor>
+	static void forEachLower(matrix::SparseCRS<Scalar> const &A, Visitor visit);
+
+	template<template<typename> class MatrixStoragePolicy>
+	void analyzeMatrix(MatrixStoragePolicy<Scalar> const &A);
+
+	template<template<typename> class MatrixStoragePolicy>
+	ReturnCode factorizeMatrix(MatrixStoragePolicy<Scalar> const &A);
+
+	/**
+	 * Gathers the lower triangle of P A P^T in m_C, recording the pattern for refills
+	 **/
+	template<template<typename> class MatrixStoragePolicy>
+	void permute(MatrixStoragePolicy<Scalar> const &A);
+
+	/**
+	 * Computes the elimination tree of m_C
+	 **/
+	void eliminationTree(std::vector<size_t> const &row_pointer, std::vector<size_t> const &column_index);
+
+	/**
+	 * Returns a postorder of the elimination tree
+	 **/
+	std::vector<size_t> postorder() const;
+
+	/**
+	 * Computes the column counts, the fundamental supernodes and their row structure
+	 **/
+	void symbolic(std::vector<size_t> const &row_pointer, std::vector<size_t> const &column_index);
+
+	/**
+	 * Row-wise pattern of the strict lower triangle of m_C
+	 **/
+	void lowerRows(std::vector<size_t> &row_pointer, std::vector<size_t> &column_index) const;
+
+	ReturnCode numeric();
+
+	/**
+	 * Dense Cholesky factorization of the m-by-columns panel L, whose leading
+	 * columns-by-columns block is the diagonal block
+	 *@return	false if a pivot isn't positive
+	 **/
+	static bool factorPanel(Scalar *L, size_t m, size_t columns);
+
+	/**
+	 * Lower triangle of W = A B^T, where A is rows-by-k and B is columns-by-k, both
+	 * stored column-major with leading dimension ld, and W has leading dimension rows
+	 **/
+	static void updateBlock(Scalar const *A, Scalar const *B, size_t ld, size_t rows, size_t columns, size_t k, Scalar *W);
+};
+
+
+
+template<typename Scalar>
+SparseCholesky<Scalar>::SparseCholesky(Ordering ordering)
+	: m_ordering(ordering), m_analyzed(false), m_factorized(false)
+{
+	data.n = 0;
+	data.supernode_pointer.assign(1, 0);
+}
+
+
+template<typename Scalar>
+template<typename Visitor>
+void
+SparseCholesky<Scalar>::forEachLower(matrix::SparseCCS<Scalar> const &A, Visitor visit)
+{
+	auto const &A_data = A.data;
+	for(size_t j = 0; j < A.columns(); j++)
+	{
+		for(size_t k = A_data.column_pointer[j]; k < A_data.column_pointer[j+1]; k++)
+		{
+			size_t const i = A_data.row_index[k];
+			if(i >= j)
+				visit(i, j, A_data.values[k]);
+		}
+	}
+}
+
+
+template<typename Scalar>
+template<typename Visitor>
+void
+SparseCholesky<Scalar>::forEachLower(matrix::SparseCRS<Scalar> const &A, Visitor visit)
+{
+	auto const &A_data = A.data;
+	for(size_t i = 0; i < A.rows(); i++)
+	{
+		for(size_t k = A_data.row_pointer[i]; k < A_data.row_pointer[i+1]; k++)
+		{
+			size_t const j = A_data.column_index[k];
+			if(j <= i)
+				visit(i, j, A_data.values[k]);
+		}
+	}
+}
+
+
+template<typename Scalar>
+void
+SparseCholesky<Scalar>::analyze(matrix::SparseCCS<Scalar> const &A)
+{
+	analyzeMatrix(A);
+}
+
+
+template<typename Scalar>
+void
+SparseCholesky<Scalar>::analyze(matrix::SparseCRS<Scalar> const &A)
+{
+	analyzeMatrix(A);
+}
+
+
+template<typename Scalar>
+ReturnCode
+SparseCholesky<Scalar>::factorize(matrix::SparseCCS<Scalar> const &A)
+{
+	return factorizeMatrix(A);
+}
+
+
+template<typename Scalar>
+ReturnCode
+SparseCholesky<Scalar>::factorize(matrix::SparseCRS<Scalar> const &A)
+{
+	return factorizeMatrix(A);
+}
+
+
+template<typename Scalar>
+template<template<typename> class MatrixStoragePolicy>
+void
+SparseCholesky<Scalar>::analyzeMatrix(MatrixStoragePolicy<Scalar> const &A)
+{
+	if( !A.isSquare() )
+	{
+		throw LAException("SparseCholesky: A must be a square matrix");
+	}
+
+	size_t const n = A.rows();
+	data.n = n;
+	m_analyzed = false;
+	m_factorized = false;
+
+	// fill-reducing ordering
+	switch(m_ordering)
+	{
+		case ORDERING_RCM:
+			data.permutation = reverse_cuthill_mckee( AdjacencyGraph(A) );
+			break;
+
+		case ORDERING_AMD:
+			data.permutation = approximate_minimum_degree( AdjacencyGraph(A) );
+			break;
+
+		default:
+			data.permutation.resize(n);
+			for(size_t i = 0; i < n; i++)
+			{
+				data.permutation[i] = i;
+			}
+			break;
+	}
+
+	data.inverse_permutation.resize(n);
+	for(size_t k = 0; k < n; k++)
+	{
+		data.inverse_permutation[data.permutation[k]] = k;
+	}
+
+	std::vector<size_t> row_pointer, column_index;
+
+	// postorder the elimination tree, which keeps the fill-in and makes the columns
+	// of each supernode contiguous
+	permute(A);
+	lowerRows(row_pointer, column_index);
+	eliminationTree(row_pointer, column_index);
+
+	std::vector<size_t> const post = postorder();
+	std::vector<size_t> permutation(n);
+	for(size_t k = 0; k < n; k++)
+	{
+		permutation[k] = data.permutation[post[k]];
+	}
+	data.permutation.swap(permutation);
+	for(size_t k = 0; k < n; k++)
+	{
+		data.inverse_permutation[data.permutation[k]] = k;
+	}
+
+	permute(A);
+	lowerRows(row_pointer, column_index);
+	eliminationTree(row_pointer, column_index);
+	symbolic(row_pointer, column_index);
+
+	m_analyzed = true;
+}
+
+
+template<typename Scalar>
+template<template<typename> class MatrixStoragePolicy>
+ReturnCode
+SparseCholesky<Scalar>::factorizeMatrix(MatrixStoragePolicy<Scalar> const &A)
+{
+	if( !m_analyzed )
+	{
+		analyzeMatrix(A);
+	}
+	else
+	{
+		if(A.rows() != data.n || A.columns() != data.n)
+		{
+			throw LAException("SparseCholesky::factorize(): A doesn't have the analyzed sparsity pattern");
+		}
+
+		// refill the values of the permuted lower triangle
+		std::vector<size_t> const &inverse = data.inverse_permutation;
+		auto &assembler = m_assembler;
+		assembler.restart();
+		forEachLower(A, [&inverse, &assembler](size_t i, size_t j, Scalar value)
+			{
+				size_t const pi = inverse[i], pj = inverse[j];
+				assembler.add( std::max(pi,pj), std::min(pi,pj), value);
+			});
+		m_assembler.assemble(m_C);
+	}
+
+	return numeric();
+}
+
+
+template<typename Scalar>
+template<template<typename> class MatrixStoragePolicy>
+void
+SparseCholesky<Scalar>::permute(MatrixStoragePolicy<Scalar> const &A)
+{
+	std::vector<size_t> const &inverse = data.inverse_permutation;
+
+	auto &assembler = m_assembler;
+	assembler.resize(data.n, data.n);
+	forEachLower(A, [&inverse, &assembler](size_t i, size_t j, Scalar value)
+		{
+			size_t const pi = inverse[i], pj = inverse[j];
+			assembler.add( std::max(pi,pj), std::min(pi,pj), value);
+		});
+
+	assembler.assemble(m_C);
+}
+
+
+template<typename Scalar>
+void
+SparseCholesky<Scalar>::lowerRows(std::vector<size_t> &row_pointer, std::vector<size_t> &column_index) const
+{
+	size_t const n = data.n;
+	auto const &C = m_C.data;
+
+	row_pointer.assign(n+1, 0);
+	for(size_t j = 0; j < n; j++)
+	{
+		for(size_t k = C.column_pointer[j]; k < C.column_pointer[j+1]; k++)
+		{
+			if(C.row_index[k] != j)
+				row_pointer[C.row_index[k]+1]++;
+		}
+	}
+	for(size_t i = 0; i < n; i++)
+	{
+		row_pointer[i+1] += row_pointer[i];
+	}
+
+	column_index.resize(row_pointer[n]);
+	std::vector<size_t> next(row_pointer.begin(), row_pointer.end()-1);
+	for(size_t j = 0; j < n; j++)
+	{
+		for(size_t k = C.column_pointer[j]; k < C.column_pointer[j+1]; k++)
+		{
+			size_t const i = C.row_index[k];
+			if(i != j)
+				column_index[ next[i]++ ] = j;
+		}
+	}
+}
+
+
+template<typename Scalar>
+void
+SparseCholesky<Scalar>::eliminationTree(std::vector<size_t> const &row_pointer, std::vector<size_t> const &column_index)
+{
+	size_t const n = data.n;
+	size_t const none = n;
+
+	// Liu's algorithm with path compression
+	data.parent.assign(n, none);
+	std::vector<size_t> ancestor(n, none);
+	for(size_t k = 0; k < n; k++)
+	{
+		for(size_t p = row_pointer[k]; p < row_pointer[k+1]; p++)
+		{
+			size_t i = column_index[p];
+			while(i != none && i < k)
+			{
+				size_t const next = ancestor[i];
+				ancestor[i] = k;
+				if(next == none)
+					data.parent[i] = k;
+				i = next;
+			}
+		}
+	}
+}
+
+
+template<typename Scalar>
+std::vector<size_t>
+SparseCholesky<Scalar>::postorder() const
+{
+	size_t const n = data.n;
+	size_t const none = n;
+
+	// children lists, in increasing order
+	std::vector<size_t> head(n, none), next(n, none);
+	for(size_t j = n; j-- > 0; )
+	{
+		if(data.parent[j] != none)
+		{
+			next[j] = head[data.parent[j]];
+			head[data.parent[j]] = j;
+		}
+	}
+
+	std::vector<size_t> post, stack;
+	post.reserve(n);
+	for(size_t root = 0; root < n; root++)
+	{
+		if(data.parent[root] != none)
+			continue;
+
+		stack.push_back(root);
+		while( !stack.empty() )
+		{
+			size_t const j = stack.back();
+			size_t const child = head[j];
+			if(child == none)
+			{
+				stack.pop_back();
+				post.push_back(j);
+			}
+			else
+			{
+				head[j] = next[child];
+				stack.push_back(child);
+			}
+		}
+	}
+
+	return post;
+}
+
+
+template<typename Scalar>
+void
+SparseCholesky<Scalar>::symbolic(std::vector<size_t> const &row_pointer, std::vector<size_t> const &column_index)
+{
+	size_t const n = data.n;
+	size_t const none = n;
+	auto const &parent = data.parent;
+
+	// column counts: row k of L is the set of the nodes of the elimination tree that
+	// are reached from the columns of row k of A
+	std::vector<size_t> flag(n, none);
+	data.column_count.assign(n, 1);
+	for(size_t k = 0; k < n; k++)
+	{
+		flag[k] = k;
+		for(size_t p = row_pointer[k]; p < row_pointer[k+1]; p++)
+		{
+			for(size_t j = column_index[p]; flag[j] != k; j = parent[j])
+			{
+				flag[j] = k;
+				data.column_count[j]++;
+			}
+		}
+	}
+
+	// fundamental supernodes: chains of columns whose structure only loses the diagonal
+	std::vector<size_t> children(n, 0);
+	for(size_t j = 0; j < n; j++)
+	{
+		if(parent[j] != none)
+			children[parent[j]]++;
+	}
+
+	data.supernode_pointer.clear();
+	data.column_supernode.resize(n);
+	for(size_t j = 0; j < n; j++)
+	{
+		bool const merge = j > 0 && parent[j-1] == j && children[j] == 1 && data.column_count[j-1] == data.column_count[j]+1;
+		if( !merge )
+		{
+			data.supernode_pointer.push_back(j);
+		}
+		data.column_supernode[j] = data.supernode_pointer.size()-1;
+	}
+	data.supernode_pointer.push_back(n);
+
+	size_t const n_supernodes = data.supernode_pointer.size()-1;
+
+	// the rows of each supernode are the rows of its first column
+	data.row_pointer.resize(n_supernodes+1);
+	data.value_pointer.resize(n_supernodes+1);
+	data.row_pointer[0] = 0;
+	data.value_pointer[0] = 0;
+	for(size_t s = 0; s < n_supernodes; s++)
+	{
+		size_t const first = data.supernode_pointer[s];
+		size_t const columns = data.supernode_pointer[s+1] - first;
+		size_t const m = data.column_count[first];
+
+		data.row_pointer[s+1] = data.row_pointer[s] + m;
+		data.value_pointer[s+1] = data.value_pointer[s] + m*columns;
+	}
+
+	data.row_index.resize(data.row_pointer[n_supernodes]);
+	std::vector<size_t> next(data.row_pointer.begin(), data.row_pointer.end()-1);
+	for(size_t s = 0; s < n_supernodes; s++)
+	{
+		data.row_index[ next[s]++ ] = data.supernode_pointer[s];
+	}
+
+	std::fill(flag.begin(), flag.end(), none);
+	for(size_t k = 0; k < n; k++)
+	{
+		flag[k] = k;
+		for(size_t p = row_pointer[k]; p < row_pointer[k+1]; p++)
+		{
+			for(size_t j = column_index[p]; flag[j] != k; j = parent[j])
+			{
+				flag[j] = k;
+
+				size_t const s = data.column_supernode[j];
+				if(data.supernode_pointer[s] == j)
+					data.row_index[ next[s]++ ] = k;
+			}
+		}
+	}
+
+	data.values.clear();
+}
+
+
+template<typename Scalar>
+ReturnCode
+SparseCholesky<Scalar>::numeric()
+{
+	size_t const n = data.n;
+	size_t const n_supernodes = supernodes();
+	size_t const none = n_supernodes;
+
+	m_factorized = false;
+	data.values.assign(data.value_pointer[n_supernodes], (Scalar)0);
+
+	m_relative.resize(n);
+	m_link_head.assign(n_supernodes, none);
+	m_link_next.assign(n_supernodes, none);
+	m_position.assign(n_supernodes, 0);
+
+	auto const &C = m_C.data;
+
+	for(size_t s = 0; s < n_supernodes; s++)
+	{
+		size_t const first = data.supernode_pointer[s];
+		size_t const last = data.supernode_pointer[s+1];
+		size_t const columns = last - first;
+		size_t const *rows = &data.row_index[data.row_pointer[s]];
+		size_t const m = data.row_pointer[s+1] - data.row_pointer[s];
+		Scalar *L = &data.values[data.value_pointer[s]];
+
+		for(size_t r = 0; r < m; r++)
+		{
+			m_relative[rows[r]] = r;
+		}
+
+		// scatter the columns of A
+		for(size_t j = first; j < last; j++)
+		{
+			Scalar *column = L + (j-first)*m;
+			for(size_t k = C.column_pointer[j]; k < C.column_pointer[j+1]; k++)
+			{
+				column[ m_relative[C.row_index[k]] ] = C.values[k];
+			}
+		}
+
+		// updates from the descendants whose rows include columns of s
+		size_t d = m_link_head[s];
+		m_link_head[s] = none;
+		while(d != none)
+		{
+			size_t const d_next = m_link_next[d];
+
+			size_t const d_columns = data.supernode_pointer[d+1] - data.supernode_pointer[d];
+			size_t const *d_rows = &data.row_index[data.row_pointer[d]];
+			size_t const d_m = data.row_pointer[d+1] - data.row_pointer[d];
+			Scalar const *L_d = &data.values[data.value_pointer[d]];
+
+			size_t const p1 = m_position[d];
+			size_t p2 = p1;
+			while(p2 < d_m && d_rows[p2] < last)
+				p2++;
+
+			size_t const update_rows = d_m - p1;
+			size_t const update_columns = p2 - p1;
+			m_update.resize(update_rows*update_columns);
+			updateBlock(L_d + p1, L_d + p1, d_m, update_rows, update_columns, d_columns, m_update.data());
+
+			// L(rows, columns) -= W
+			for(size_t jj = 0; jj < update_columns; jj++)
+			{
+				Scalar *column = L + (d_rows[p1+jj]-first)*m;
+				Scalar const *w = &m_update[jj*update_rows];
+				for(size_t ii = jj; ii < update_rows; ii++)
+				{
+					column[ m_relative[d_rows[p1+ii]] ] -= w[ii];
+				}
+			}
+
+			// d updates next the supernode of its next row
+			m_position[d] = p2;
+			if(p2 < d_m)
+			{
+				size_t const target = data.column_supernode[d_rows[p2]];
+				m_link_next[d] = m_link_head[target];
+				m_link_head[target] = d;
+			}
+
+			d = d_next;
+		}
+
+		if( !factorPanel(L, m, columns) )
+		{
+			return ERR_NOT_POSITIVE_DEFINITE;
+		}
+
+		m_position[s] = columns;
+		if(columns < m)
+		{
+			size_t const target = data.column_supernode[rows[columns]];
+			m_link_next[s] = m_link_head[target];
+			m_link_head[target] = s;
+		}
+	}
+
+	m_factorized = true;
+	return OK;
+}
+
+
+template<typename Scalar>
+bool
+SparseCholesky<Scalar>::factorPanel(Scalar *L, size_t m, size_t columns)
+{
+	for(size_t j = 0; j < columns; j++)
+	{
+		Scalar *column_j = L + j*m;
+
+		// left-looking update with the previous columns of the panel
+		size_t k = 0;
+		for(; k+4 <= j; k += 4)
+		{
+			Scalar const *c0 = L + k*m, *c1 = c0 + m, *c2 = c1 + m, *c3 = c2 + m;
+			Scalar const t0 = c0[j], t1 = c1[j], t2 = c2[j], t3 = c3[j];
+			for(size_t i = j; i < m; i++)
+			{
+				column_j[i] -= c0[i]*t0 + c1[i]*t1 + c2[i]*t2 + c3[i]*t3;
+			}
+		}
+		for(; k < j; k++)
+		{
+			Scalar const *c0 = L + k*m;
+			Scalar const t0 = c0[j];
+			for(size_t i = j; i < m; i++)
+			{
+				column_j[i] -= c0[i]*t0;
+			}
+		}
+
+		Scalar const pivot = column_j[j];
+		if( !(pivot > 0) )
+			return false;
+
+		Scalar const diagonal = std::sqrt(pivot);
+		column_j[j] = diagonal;
+		Scalar const inverse = (Scalar)1/diagonal;
+		for(size_t i = j+1; i < m; i++)
+		{
+			column_j[i] *= inverse;
+		}
+	}
+
+	return true;
+}
+
+
+template<typename Scalar>
+void
+SparseCholesky<Scalar>::updateBlock(Scalar const *A, Scalar const *B, size_t ld, size_t rows, size_t columns, size_t k, Scalar *W)
+{
+	for(size_t j = 0; j < columns; j++)
+	{
+		Scalar *w = W + j*rows;
+		std::fill(w + j, w + rows, (Scalar)0);
+
+		size_t p = 0;
+		for(; p+4 <= k; p += 4)
+		{
+			Scalar const *a0 = A + p*ld, *a1 = a0 + ld, *a2 = a1 + ld, *a3 = a2 + ld;
+			Scalar const t0 = B[j + p*ld], t1 = B[j + (p+1)*ld], t2 = B[j + (p+2)*ld], t3 = B[j + (p+3)*ld];
+			for(size_t i = j; i < rows; i++)
+			{
+				w[i] += a0[i]*t0 + a1[i]*t1 + a2[i]*t2 + a3[i]*t3;
+			}
+		}
+		for(; p < k; p++)
+		{
+			Scalar const *a0 = A + p*ld;
+			Scalar const t0 = B[j + p*ld];
+			for(size_t i = j; i < rows; i++)
+			{
+				w[i] += a0[i]*t0;
+			}
+		}
+	}
+}
+
+
+template<typename Scalar>
+ReturnCode
+SparseCholesky<Scalar>::solve(vector::Dense<Scalar> &x, vector::Dense<Scalar> const &b)
+{
+	if( !m_factorized )
+	{
+		throw LAException("SparseCholesky::solve(): no numeric factorization available");
+	}
+	if(b.size() != data.n)
+	{
+		throw LAException("SparseCholesky::solve(): A.rows() != b.size()");
+	}
+
+	size_t const n = data.n;
+	size_t const n_supernodes = supernodes();
+
+	m_y.resize(n);
+	Scalar *y = m_y.data();
+	for(size_t k = 0; k < n; k++)
+	{
+		y[k] = b.data[data.permutation[k]];
+	}
+
+	// L y = P b
+	for(size_t s = 0; s < n_supernodes; s++)
+	{
+		size_t const first = data.supernode_pointer[s];
+		size_t const columns = data.supernode_pointer[s+1] - first;
+		size_t const *rows = &data.row_index[data.row_pointer[s]];
+		size_t const m = data.row_pointer[s+1] - data.row_pointer[s];
+		Scalar const *L = &data.values[data.value_pointer[s]];
+
+		for(size_t j = 0; j < columns; j++)
+		{
+			Scalar const *column = L + j*m;
+			Scalar const y_j = y[first+j] /= column[j];
+			for(size_t i = j+1; i < m; i++)
+			{
+				y[rows[i]] -= column[i]*y_j;
+			}
+		}
+	}
+
+	// L^T z = y
+	for(size_t s = n_supernodes; s-- > 0; )
+	{
+		size_t const first = data.supernode_pointer[s];
+		size_t const columns = data.supernode_pointer[s+1] - first;
+		size_t const *rows = &data.row_index[data.row_pointer[s]];
+		size_t const m = data.row_pointer[s+1] - data.row_pointer[s];
+		Scalar const *L = &data.values[data.value_pointer[s]];
+
+		for(size_t j = columns; j-- > 0; )
+		{
+			Scalar const *column = L + j*m;
+			Scalar sum = y[first+j];
+			for(size_t i = j+1; i < m; i++)
+			{
+				sum -= column[i]*y[rows[i]];
+			}
+			y[first+j] = sum/column[j];
+		}
+	}
+
+	if(x.size() != n)
+	{
+		x.resize(n);
+	}
+	for(size_t k = 0; k < n; k++)
+	{
+		x.data[data.permutation[k]] = y[k];
+	}
+
+	return OK;
+}
+
+
+template<typename Scalar>
+size_t
+SparseCholesky<Scalar>::nnz() const
+{
+	size_t count = 0;
+	for(size_t c: data.column_count)
+	{
+		count += c;
+	}
+	return count;
+}
+
+
+template<typename Scalar>
+double
+SparseCholesky<Scalar>::flops() const
+{
+	double count = 0;
+	for(size_t c: data.column_count)
+	{
+		count += (double)c*c;
+	}
+	return count;
+}
+
+
+template<typename Scalar>
+void
+SparseCholesky<Scalar>::getFactor(matrix::SparseCCS<Scalar> &L) const
+{
+	if( !m_factorized )
+	{
+		throw LAException("SparseCholesky::getFactor(): no numeric factorization available");
+	}
+
+	size_t const n = data.n;
+
+	L.data.n_rows = n;
+	L.data.column_pointer.resize(n+1);
+	L.data.row_index.resize(nnz());
+	L.data.values.resize(nnz());
+
+	size_t position = 0;
+	for(size_t s = 0; s < supernodes(); s++)
+	{
+		size_t const first = data.supernode_pointer[s];
+		size_t const columns = data.supernode_pointer[s+1] - first;
+		size_t const *rows = &data.row_index[data.row_pointer[s]];
+		size_t const m = data.row_pointer[s+1] - data.row_pointer[s];
+		Scalar const *values = &data.values[data.value_pointer[s]];
+
+		for(size_t j = 0; j < columns; j++)
+		{
+			L.data.column_pointer[first+j] = position;
+			for(size_t i = j; i < m; i++)
+			{
+				L.data.row_index[position] = rows[i];
+				L.data.values[position] = values[i + j*m];
+				position++;
+			}
+		}
+	}
+	L.data.column_pointer[n] = position;
+}
+
+
+}	// namespace mla
+
+#endif
@@ -4,19 +4,22 @@
 
 #include <mla/solvers/SolverReturnCodes.h++>
 
-#include <mla/Matrix.h++>
+#include <mla/vector/Dense.h++>
 
 namespace mla
 {
 /**
-Generic forward substitution routine for dense matrices and dense vectors
+Generic forward substitution routine, solves [L]{x} = {b} for a lower triangular matrix L
 **/
-template<typename Scalar, template<typename> class MatrixStoragePolicy,  template<typename> class VectorStoragePolicy>
-ReturnCode forward_substitution(Matrix<Scalar, MatrixStoragePolicy> &L, Vector<Scalar, VectorStoragePolicy> &x, Vector<Scalar, VectorStoragePolicy> &b)
+template<typename Scalar, template<typename> class MatrixStoragePolicy>
+ReturnCode forward_substitution(MatrixStoragePolicy<Scalar> const &L, vector::Dense<Scalar> &x, vector::Dense<Scalar> const &b)
 {
 	if(L.rows() != L.columns())
 		return ERR_NOT_SQUARE;
 
+	if(x.size() != L.rows())
+		x.resize(L.rows());
+
 	// Ly = b
 	Scalar s = 0;
 	for(size_t i = 0; i < L.rows(); i++)
@@ -24,9 +27,9 @@ ReturnCode forward_substitution(Matrix<Scalar, MatrixStoragePolicy> &L, Vector<S
 		s = 0;
 		for(size_t j = 0; j < i; j++)
 		{
-			s += L(i,j)*x(j);
+			s += L.getValue(i,j)*x.data[j];
 		}
-		x(i) = (b.getValue(i) - s)/L(i,i);
+		x.data[i] = (b.data[i] - s)/L.getValue(i,i);
 	}
 
 	return OK;
@@ -34,31 +37,28 @@ ReturnCode forward_substitution(Matrix<Scalar, MatrixStoragePolicy> &L, Vector<S
 
 
 /**
-Generic back substitution routine for dense matrices and dense vectors
+Generic back substitution routine, solves [L]^T{x} = {b} for a lower triangular matrix L.
+x and b may be the same vector.
 **/
-template<typename Scalar, template<typename> class MatrixStoragePolicy,  template<typename> class VectorStoragePolicy>
-ReturnCode back_substitution(Matrix<Scalar, MatrixStoragePolicy> &L, Vector<Scalar, VectorStoragePolicy> &x, Vector<Scalar, VectorStoragePolicy> &b)
+template<typename Scalar, template<typename> class MatrixStoragePolicy>
+ReturnCode back_substitution(MatrixStoragePolicy<Scalar> const &L, vector::Dense<Scalar> &x, vector::Dense<Scalar> const &b)
 {
 	if(L.rows() != L.columns())
 		return ERR_NOT_SQUARE;
 
+	if(x.size() != L.rows())
+		x.resize(L.rows());
+
 	Scalar s = 0;
-	for(size_t j = L.columns() - 1; j > 0; j--)
+	for(size_t j = L.columns(); j-- > 0; )
 	{
 		s = 0;
 		for(size_t i = j+1; i < L.rows(); i++)
 		{
-			s += L(i,j)*x(i);
+			s += L.getValue(i,j)*x.data[i];
 		}
-		x(j) = (b(j) - s)/L(j,j);
-	}
-
-	s = 0;
-	for(size_t i = 1; i < L.rows(); i++)
-	{
-		s += L(i,0)*x(i);
+		x.data[j] = (b.data[j] - s)/L.getValue(j,j);
 	}
-	x(0) = (b(0) - s)/L(0,0);
 
 	return OK;
 }
@@ -2,13 +2,16 @@
 #define MLA_SOLVERS_UMFPACK_HPP
 
 
+#include <string>
 #include <vector>
 #include <suitesparse/umfpack.h>
 
+#include <mla/LAException.h++>
 #include <mla/solvers/SolverReturnCodes.h++>
 #include <mla/ProgressIndicatorStrategy.h++>
 
 #include <mla/matrix/SparseCCS.h++>
+#include <mla/matrix/DenseRowMajor.h++>
 #include <mla/vector/Dense.h++>
 
 
@@ -16,48 +19,440 @@ namespace mla
 {
 
 /**
-Umfpack routine
-**/
-ReturnCode 
-umfpack(matrix::SparseCCS<double> &A, vector::Dense<double> &x, vector::Dense<double> &b, ProgressIndicatorStrategy *)
+ * Sparse LU factorization of a SparseCCS matrix through UMFPACK.  The factorization is
+ * split in the steps UMFPACK provides, so that each one can be reused:
+ *	analyze(A)	symbolic analysis, which only depends on the sparsity pattern of A
+ *	factorize(A)	numeric factorization of A
+ *	refactorize(A)	numeric factorization of a matrix with the analyzed sparsity pattern
+ *	solve(x, b)	solves [A]{x} = {b} with the current factorization
+ *
+ * The index arrays are converted to UMFPACK's long integers once per analysis.  The
+ * matrix passed to factorize() must outlive the solves, as UMFPACK's iterative
+ * refinement reads its values.
+ *
+ *	UmfpackFactorization lu;
+ *	lu.factorize(A);
+ *	for(auto &b: loads)
+ *		lu.solve(x, b);
+ **/
+class UmfpackFactorization
+{
+protected:
+	long	m_rows;
+	long	m_columns;
+
+	// index arrays of the analyzed matrix, as expected by umfpack_dl_*
+	std::vector<long>	m_column_pointer;
+	std::vector<long>	m_row_index;
+
+	void	*m_symbolic;
+	void	*m_numeric;
+
+	matrix::SparseCCS<double> const *m_A;	// matrix of the numeric factorization
+
+	double	m_control[UMFPACK_CONTROL];
+	double	m_info[UMFPACK_INFO];
+
+	// workspace used by umfpack_dl_wsolve, so that solves don't allocate memory
+	std::vector<long>	m_solve_index_workspace;
+	std::vector<double>	m_solve_workspace;
+
+	ProgressIndicatorStrategy *m_progress;
+
+public:
+	UmfpackFactorization(ProgressIndicatorStrategy *progress = nullptr);
+	~UmfpackFactorization();
+
+	UmfpackFactorization(UmfpackFactorization const &) = delete;
+	UmfpackFactorization & operator=(UmfpackFactorization const &) = delete;
+
+	/**
+	 * Computes the symbolic analysis of A, dropping any previous factorization
+	 **/
+	ReturnCode analyze(matrix::SparseCCS<double> const &A);
+
+	/**
+	 * Computes the numeric factorization of A, analyzing it first if its sparsity
+	 * pattern wasn't analyzed yet
+	 **/
+	ReturnCode factorize(matrix::SparseCCS<double> const &A);
+
+	/**
+	 * Computes the numeric factorization of a matrix with the sparsity pattern of the
+	 * analyzed matrix, reusing the symbolic analysis
+	 **/
+	ReturnCode refactorize(matrix::SparseCCS<double> const &A);
+
+	/**
+	 * Solves [A]{x} = {b}, or [A]^T{x} = {b} if sys is UMFPACK_At
+	 **/
+	ReturnCode solve(vector::Dense<double> &x, vector::Dense<double> const &b, int sys = UMFPACK_A);
+
+	/**
+	 * Solves [A][X] = [B] for every column of B
+	 **/
+	ReturnCode solve(matrix::DenseRowMajor<double> &X, matrix::DenseRowMajor<double> const &B, int sys = UMFPACK_A);
+
+	/**
+	 * Solves [A]{x_i} = {b_i} for every right-hand side in b
+	 **/
+	ReturnCode solve(std::vector<vector::Dense<double> > &x, std::vector<vector::Dense<double> > const &b, int sys = UMFPACK_A);
+
+	bool isAnalyzed() const		{ return m_symbolic != nullptr; }
+	bool isFactorized() const	{ return m_numeric != nullptr; }
+
+	/**
+	 * Drops the symbolic analysis and the numeric factorization
+	 **/
+	void clear();
+
+	/**
+	 * UMFPACK's control parameters, initialized with umfpack_dl_defaults()
+	 **/
+	double * control()	{ return m_control; }
+
+	/**
+	 * UMFPACK's statistics of the last call, such as UMFPACK_NUMERIC_TIME, UMFPACK_LNZ,
+	 * UMFPACK_UNZ or UMFPACK_RCOND
+	 **/
+	double const * info() const	{ return m_info; }
+	double info(int index) const	{ return m_info[index]; }
+
+	void setProgressIndicator(ProgressIndicatorStrategy *progress)	{ m_progress = progress; }
+
+protected:
+	/**
+	 * Checks if A has the sparsity pattern of the analyzed matrix
+	 **/
+	bool hasAnalyzedPattern(matrix::SparseCCS<double> const &A) const;
+
+	ReturnCode numeric(matrix::SparseCCS<double> const &A);
+
+	ReturnCode solve(double *x, double const *b, int sys);
+
+	/**
+	 * Maps an UMFPACK status to a return code, throwing on errors
+	 **/
+	ReturnCode check(int status, std::string const &step);
+
+	void freeNumeric();
+};
+
+
+
+inline
+UmfpackFactorization::UmfpackFactorization(ProgressIndicatorStrategy *progress)
+	: m_rows(0), m_columns(0), m_symbolic(nullptr), m_numeric(nullptr), m_A(nullptr), m_progress(progress)
+{
+	umfpack_dl_defaults(m_control);
+	for(auto &value: m_info)
+	{
+		value = 0;
+	}
+}
+
+
+inline
+UmfpackFactorization::~UmfpackFactorization()
+{
+	clear();
+}
+
+
+inline void
+UmfpackFactorization::clear()
+{
+	freeNumeric();
+
+	if(m_symbolic != nullptr)
+	{
+		umfpack_dl_free_symbolic(&m_symbolic);
+		m_symbolic = nullptr;
+	}
+}
+
+
+inline void
+UmfpackFactorization::freeNumeric()
+{
+	if(m_numeric != nullptr)
+	{
+		umfpack_dl_free_numeric(&m_numeric);
+		m_numeric = nullptr;
+	}
+	m_A = nullptr;
+}
+
+
+inline ReturnCode
+UmfpackFactorization::analyze(matrix::SparseCCS<double> const &A)
 {
 	if( !A.isSquare() )
 	{
-		throw LAException("A must be a square matrix");
+		throw LAException("UmfpackFactorization: A must be a square matrix");
 	}
-	if(A.columns() != b.size())
+
+	clear();
+
+	m_rows = A.rows();
+	m_columns = A.columns();
+	m_column_pointer.assign(A.data.column_pointer.begin(), A.data.column_pointer.end());
+	m_row_index.assign(A.data.row_index.begin(), A.data.row_index.end());
+
+	m_solve_index_workspace.resize(m_rows);
+	m_solve_workspace.resize(5*m_rows);
+
+	if(m_progress)
 	{
-		throw LAException("A.columns() != b.size()");
+		m_progress->markSectionStart("UMFPACK symbolic analysis");
+	}
+
+	int status = umfpack_dl_symbolic(m_rows, m_columns, m_column_pointer.data(), m_row_index.data(), A.data.values.data(), &m_symbolic, m_control, m_info);
+
+	if(m_progress)
+	{
+		m_progress->markSectionEnd();
+	}
+
+	return check(status, "symbolic analysis");
+}
+
+
+inline ReturnCode
+UmfpackFactorization::factorize(matrix::SparseCCS<double> const &A)
+{
+	if( !isAnalyzed() || !hasAnalyzedPattern(A) )
+	{
+		ReturnCode code = analyze(A);
+		if(code != OK)
+			return code;
+	}
+
+	return numeric(A);
+}
+
+
+inline ReturnCode
+UmfpackFactorization::refactorize(matrix::SparseCCS<double> const &A)
+{
+	if( !isAnalyzed() )
+	{
+		throw LAException("UmfpackFactorization::refactorize(): no sparsity pattern was analyzed");
+	}
+	if( !hasAnalyzedPattern(A) )
+	{
+		throw LAException("UmfpackFactorization::refactorize(): A doesn't have the analyzed sparsity pattern");
+	}
+
+	return numeric(A);
+}
+
+
+inline bool
+UmfpackFactorization::hasAnalyzedPattern(matrix::SparseCCS<double> const &A) const
+{
+	if( (long)A.rows() != m_rows || (long)A.columns() != m_columns )
+		return false;
+
+	auto const &column_pointer = A.data.column_pointer;
+	auto const &row_index = A.data.row_index;
+
+	if(column_pointer.size() != m_column_pointer.size() || row_index.size() != m_row_index.size() )
+		return false;
+
+	for(size_t i = 0; i < column_pointer.size(); i++)
+	{
+		if( (long)column_pointer[i] != m_column_pointer[i])
+			return false;
+	}
+	for(size_t i = 0; i < row_index.size(); i++)
+	{
+		if( (long)row_index[i] != m_row_index[i])
+			return false;
 	}
 
+	return true;
+}
+
+
+inline ReturnCode
+UmfpackFactorization::numeric(matrix::SparseCCS<double> const &A)
+{
+	freeNumeric();
+
+	if(m_progress)
+	{
+		m_progress->markSectionStart("UMFPACK numeric factorization");
+	}
 
-	x.resize(A.rows());
+	int status = umfpack_dl_numeric(m_column_pointer.data(), m_row_index.data(), A.data.values.data(), m_symbolic, &m_numeric, m_control, m_info);
 
+	if(m_progress)
+	{
+		m_progress->markSectionEnd();
+	}
 
-	void *Numeric = NULL;
-	void *Symbolic = NULL;
+	ReturnCode code = check(status, "numeric factorization");
+	if(m_numeric != nullptr)
+	{
+		m_A = &A;
+	}
 
-	double *null = (double *) NULL ;
+	return code;
+}
 
-	long int row = A.rows();
-	long int column = A.columns();
 
-	std::vector<long int> Ap( A.data.column_pointer.begin(), A.data.column_pointer.end());
-	std::vector<long int> Ai( A.data.row_index.begin(), A.data.row_index.end());
+inline ReturnCode
+UmfpackFactorization::solve(vector::Dense<double> &x, vector::Dense<double> const &b, int sys)
+{
+	if(b.size() != (size_t)m_rows)
+	{
+		throw LAException("UmfpackFactorization::solve(): A.rows() != b.size()");
+	}
 
-	(void) umfpack_dl_symbolic (row, column, &Ap[0], &Ai[0], &A.data.values[0], &Symbolic, null, null) ;
-	(void) umfpack_dl_numeric (&Ap[0], &Ai[0], &A.data.values[0], Symbolic, &Numeric, null, null);
-	
-	umfpack_dl_free_symbolic (&Symbolic) ;
+	x.resize(m_columns);
 
-	(void) umfpack_dl_solve (UMFPACK_A, &Ap[0], &Ai[0], &A.data.values[0], &x.data[0], &b.data[0], Numeric, null, null) ;
-	umfpack_dl_free_numeric (&Numeric) ;
+	return solve(x.data.data(), b.data.data(), sys);
+}
+
+
+inline ReturnCode
+UmfpackFactorization::solve(matrix::DenseRowMajor<double> &X, matrix::DenseRowMajor<double> const &B, int sys)
+{
+	if(B.rows() != (size_t)m_rows)
+	{
+		throw LAException("UmfpackFactorization::solve(): A.rows() != B.rows()");
+	}
+
+	X.resize(m_columns, B.columns());
+
+	if(m_progress)
+	{
+		m_progress->markSectionStart("UMFPACK solve");
+		m_progress->markSectionLimit(B.columns());
+	}
+
+	// the elements of each column are stored contiguously
+	ReturnCode code = OK;
+	for(size_t j = 0; j < B.columns() && code == OK; j++)
+	{
+		code = solve(X.data.element_vector.data() + j*X.rows(), B.data.element_vector.data() + j*B.rows(), sys);
+
+		if(m_progress)
+		{
+			m_progress->markSectionIterationIncrement();
+		}
+	}
+
+	if(m_progress)
+	{
+		m_progress->markSectionEnd();
+	}
+
+	return code;
+}
+
+
+inline ReturnCode
+UmfpackFactorization::solve(std::vector<vector::Dense<double> > &x, std::vector<vector::Dense<double> > const &b, int sys)
+{
+	x.resize(b.size());
+
+	if(m_progress)
+	{
+		m_progress->markSectionStart("UMFPACK solve");
+		m_progress->markSectionLimit(b.size());
+	}
+
+	ReturnCode code = OK;
+	for(size_t k = 0; k < b.size() && code == OK; k++)
+	{
+		code = solve(x[k], b[k], sys);
+
+		if(m_progress)
+		{
+			m_progress->markSectionIterationIncrement();
+		}
+	}
+
+	if(m_progress)
+	{
+		m_progress->markSectionEnd();
+	}
+
+	return code;
+}
+
+
+inline ReturnCode
+UmfpackFactorization::solve(double *x, double const *b, int sys)
+{
+	if( !isFactorized() )
+	{
+		throw LAException("UmfpackFactorization::solve(): no numeric factorization available");
+	}
+
+	int status = umfpack_dl_wsolve(sys, m_column_pointer.data(), m_row_index.data(), m_A->data.values.data(), x, b, m_numeric, m_control, m_info, m_solve_index_workspace.data(), m_solve_workspace.data());
+
+	return check(status, "solve");
+}
+
+
+inline ReturnCode
+UmfpackFactorization::check(int status, std::string const &step)
+{
+	switch(status)
+	{
+		case UMFPACK_OK:
+			return OK;
+
+		case UMFPACK_WARNING_singular_matrix:
+			if(m_progress)
+			{
+				m_progress->message("UMFPACK " + step + ": singular matrix");
+			}
+			return ERR_SINGULAR_MATRIX;
+
+		default:
+			if(status > 0)
+			{
+				// remaining warnings don't prevent a solution from being computed
+				return OK;
+			}
+
+			std::string message = "UMFPACK " + step + " failed with status " + std::to_string(status);
+			if(m_progress)
+			{
+				m_progress->error(message);
+			}
+			throw LAException(message);
+	}
+}
+
+
+/**
+Umfpack routine: factorizes A and solves [A]{x} = {b} in a single call.
+Use UmfpackFactorization to reuse the factorization between solves.
+**/
+inline ReturnCode
+umfpack(matrix::SparseCCS<double> &A, vector::Dense<double> &x, vector::Dense<double> &b, ProgressIndicatorStrategy *progress)
+{
+	if( !A.isSquare() )
+	{
+		throw LAException("A must be a square matrix");
+	}
+	if(A.columns() != b.size())
+	{
+		throw LAException("A.columns() != b.size()");
+	}
 
-	#undef Ap
-	#undef Ai
+	UmfpackFactorization factorization(progress);
 
+	ReturnCode code = factorization.factorize(A);
+	if(code != OK)
+		return code;
 
-	return OK;
+	return factorization.solve(x, b);
 }
 
 
@@ -0,0 +1,92 @@
+#ifndef MLA_VECTOR_DENSE_VIEW_HPP
+#define MLA_VECTOR_DENSE_VIEW_HPP
+
+#include <string>
+
+#include <mla/LAException.h++>
+#include <mla/Snapshot.h++>
+
+
+namespace mla
+{
+namespace vector
+{
+
+/**
+DenseView: a read-only Dense vector whose elements are used in place from a
+memory-mapped snapshot.
+**/
+template<typename Scalar>
+class DenseView
+{
+public:
+	typedef Scalar scalar_type;
+
+	size_t	t_size;		// number of elements
+
+	Scalar const	*data;
+
+protected:
+	SnapshotFile	m_file;
+
+public:
+	/**
+	 * Maps a snapshot saved from a Dense<Scalar>
+	 */
+	explicit DenseView(std::string const &file_name);
+
+	/**
+	 * Returns the size of the vector
+	 */
+	size_t size() const		{ return t_size; };
+
+	/**
+	 * Returns the value in [index]
+	 */
+	Scalar getValue(size_t index) const;
+
+	Scalar const & operator[] (size_t index) const;
+};
+
+
+
+template<typename Scalar>
+DenseView<Scalar>::DenseView(std::string const &file_name)
+	: m_file(file_name, SNAPSHOT_VECTOR_DENSE, detail::SnapshotScalar<Scalar>::type)
+{
+	auto const &header = m_file.header();
+	if(header.nnz != header.rows)
+	{
+		throw LAException("DenseView: the number of elements doesn't match the size");
+	}
+
+	t_size = header.rows;
+	data = m_file.array<Scalar>(0);
+}
+
+
+template<typename Scalar>
+Scalar
+DenseView<Scalar>::getValue(size_t index) const
+{
+	return (*this)[index];
+}
+
+
+template<typename Scalar>
+Scalar const &
+DenseView<Scalar>::operator[] (size_t index) const
+{
+	if(index >= t_size)
+	{
+		throw LAException("DenseView::operator[] index >= size()");
+	}
+
+	return data[index];
+}
+
+
+}	// namespace vector
+}	// namespace mla
+
+#endif
@@ -7,6 +7,7 @@
 #include <mla/LAException.h++>
 
 #include <mla/vector/all.h++>
+#include <mla/vector/for_each_nonzero.h++>
 
 namespace mla
 {
@@ -18,27 +19,19 @@ template<typename FromScalar, template <typename> class FromVector, typename ToS
 void
 convert(FromVector<FromScalar> &from, ToVector<ToScalar> &to, double interpret_as_zero_limit = 0.0f)
 {
-	auto from_cursor = from.cursor();
-
 	interpret_as_zero_limit = std::abs(interpret_as_zero_limit);
 
 	// set the vector size
 	to.resize( from.size() );
 
-	// iterate over each row
-	size_t i;
-	while( !from_cursor.at_end() )
+	for_each_nonzero(from, [interpret_as_zero_limit, &to](size_t i, FromScalar from_value)
 	{
-		// iterate over each element in the row
-		ToScalar value = (ToScalar)from_cursor.element();
-		if( value > interpret_as_zero_limit)
+		ToScalar value = (ToScalar)from_value;
+		if( std::abs(value) > interpret_as_zero_limit)
 		{
-			i = from_cursor.current();
 			to.setValue(i, value);
 		}
-			
-		from_cursor.next();
-	}
+	});
 }
 
 
@@ -0,0 +1,76 @@
+#ifndef MLA_VECTOR_FOR_EACH_NONZERO_HPP
+#define MLA_VECTOR_FOR_EACH_NONZERO_HPP
+
+#include <mla/vector/all.h++>
+
+
+namespace mla
+{
+namespace vector
+{
+
+/**
+for_each_nonzero: compile-time dispatched traversal of the stored elements of a vector.
+
+Calls f(i, value) for each element stored in x, in storage order.  Every storage
+policy has its own overload, which walks the storage arrays directly, so f is inlined
+in the loop instead of being reached through the virtual calls of a VectorCursor.
+Dense vectors visit every element, zeros included.
+
+When x isn't const, value is passed as a reference to the stored element, so f may
+update the elements in place.
+**/
+template<typename Scalar, typename Function>
+void
+for_each_nonzero(Dense<Scalar> const &x, Function f)
+{
+	Scalar const *values = x.data.data();
+	for(size_t i = 0; i < x.size(); i++)
+	{
+		f(i, values[i]);
+	}
+}
+
+
+template<typename Scalar, typename Function>
+void
+for_each_nonzero(Dense<Scalar> &x, Function f)
+{
+	Scalar *values = x.data.data();
+	for(size_t i = 0; i < x.size(); i++)
+	{
+		f(i, values[i]);
+	}
+}
+
+
+template<typename Scalar, typename Function>
+void
+for_each_nonzero(SparseCS<Scalar> const &x, Function f)
+{
+	size_t const *index = x.data.column_index.data();
+	Scalar const *values = x.data.values.data();
+	for(size_t k = 0; k < x.data.values.size(); k++)
+	{
+		f(index[k], values[k]);
+	}
+}
+
+
+template<typename Scalar, typename Function>
+void
+for_each_nonzero(SparseCS<Scalar> &x, Function f)
+{
+	size_t const *index = x.data.column_index.data();
+	Scalar *values = x.data.values.data();
+	for(size_t k = 0; k < x.data.values.size(); k++)
+	{
+		f(index[k], values[k]);
+	}
+}
+
+
+}	// namespace vector
+}	// namespace mla
+
+#endif
@@ -0,0 +1,357 @@
+#define BOOST_TEST_MODULE snapshot
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+#include <boost/filesystem.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include <mla/matrix/all.h++>
+#include <mla/matrix/convert.h++>
+#include <mla/vector/all.h++>
+
+#include <mla/Snapshot.h++>
+#include <mla/matrix/SparseCRSView.h++>
+#include <mla/matrix/SparseCCSView.h++>
+#include <mla/matrix/DenseRowMajorView.h++>
+#include <mla/vector/DenseView.h++>
+
+#include <mla/operations/level2/gemv.h++>
+
+
+typedef boost::mpl::list<
+	float,
+	double
+> scalar_list;
+
+
+/**
+ * A file in the temporary directory, removed when the test ends
+ **/
+struct TemporaryFile
+{
+	std::string path;
+
+	TemporaryFile()
+		: path( (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("mla-%%%%-%%%%.snapshot")).string() )
+	{}
+
+	~TemporaryFile()
+	{
+		boost::filesystem::remove(path);
+	}
+};
+
+
+/**
+ * A random 40-by-30 sparse matrix with empty rows and columns
+ **/
+template<typename Scalar>
+mla::matrix::SparseDOK<Scalar>
+random_sparse()
+{
+	std::mt19937 generator(1);
+	std::uniform_real_distribution<double> value(-1.0, 1.0);
+	std::uniform_int_distribution<size_t> row(0, 35), column(0, 27);
+
+	mla::matrix::SparseDOK<Scalar> A(40, 30);
+	for(size_t k = 0; k < 150; k++)
+	{
+		A.setValue(row(generator), column(generator), (Scalar)value(generator));
+	}
+	return A;
+}
+
+
+/**
+ * Rewrites the header of a snapshot after changing it with f
+ **/
+template<typename Function>
+void
+patch_header(std::string const &path, Function f)
+{
+	std::fstream file(path, std::fstream::in | std::fstream::out | std::fstream::binary);
+	mla::detail::SnapshotHeader header;
+	file.read(reinterpret_cast<char *>(&header), sizeof(header));
+	f(header);
+	file.seekp(0);
+	file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+}
+
+
+/**
+ * Overwrites the element at position of array a of a snapshot
+ **/
+template<typename T>
+void
+patch_array(std::string const &path, size_t a, size_t position, T value)
+{
+	std::fstream file(path, std::fstream::in | std::fstream::out | std::fstream::binary);
+	mla::detail::SnapshotHeader header;
+	file.read(reinterpret_cast<char *>(&header), sizeof(header));
+	file.seekp(header.offset[a] + position*sizeof(T));
+	file.write(reinterpret_cast<char const *>(&value), sizeof(T));
+}
+
+
+BOOST_AUTO_TEST_SUITE(snapshot)
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( round_trip_SparseCRS, Scalar, scalar_list )
+{
+	auto dok = random_sparse<Scalar>();
+	mla::matrix::SparseCRS<Scalar> A;
+	mla::matrix::convert(dok, A);
+
+	typedef mla::matrix::SparseCRSView<Scalar, size_t> WideView;
+	typedef mla::matrix::SparseCRSView<Scalar, uint32_t> NarrowView;
+
+	for(mla::SnapshotIndexWidth width: {mla::SNAPSHOT_INDEX_64, mla::SNAPSHOT_INDEX_32})
+	{
+		TemporaryFile file;
+		mla::save_snapshot(A, file.path, width);
+
+		mla::matrix::SparseCRS<Scalar> B;
+		mla::load_snapshot(file.path, B);
+
+		BOOST_CHECK_EQUAL( B.rows(), A.rows() );
+		BOOST_CHECK_EQUAL( B.columns(), A.columns() );
+		BOOST_CHECK( B.data.row_pointer == A.data.row_pointer );
+		BOOST_CHECK( std::equal(A.data.column_index.begin(), A.data.column_index.begin() + A.data.row_pointer.back(), B.data.column_index.begin()) );
+		BOOST_CHECK( std::equal(A.data.values.begin(), A.data.values.begin() + A.data.row_pointer.back(), B.data.values.begin()) );
+
+		// zero-copy view, with indices of the stored width
+		if(width == mla::SNAPSHOT_INDEX_64)
+		{
+			WideView view(file.path);
+			BOOST_CHECK_EQUAL( view.nnz(), dok.data.key_value_map.size() );
+			for(size_t i = 0; i < A.rows(); i++)
+				for(size_t j = 0; j < A.columns(); j++)
+					BOOST_REQUIRE_EQUAL( view.getValue(i,j), dok.getValue(i,j) );
+
+			BOOST_CHECK_THROW( NarrowView narrow(file.path), LAException );
+		}
+		else
+		{
+			NarrowView view(file.path);
+			for(size_t i = 0; i < A.rows(); i++)
+				for(size_t j = 0; j < A.columns(); j++)
+					BOOST_REQUIRE_EQUAL( view.getValue(i,j), dok.getValue(i,j) );
+
+			BOOST_CHECK_THROW( WideView wide(file.path), LAException );
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( round_trip_SparseCCS, Scalar, scalar_list )
+{
+	auto dok = random_sparse<Scalar>();
+	mla::matrix::SparseCCS<Scalar> A;
+	mla::matrix::convert(dok, A);
+
+	TemporaryFile file;
+	mla::save_snapshot(A, file.path, mla::SNAPSHOT_INDEX_32);
+
+	mla::matrix::SparseCCS<Scalar> B;
+	mla::load_snapshot(file.path, B);
+
+	BOOST_CHECK_EQUAL( B.rows(), A.rows() );
+	BOOST_CHECK_EQUAL( B.columns(), A.columns() );
+	BOOST_CHECK( B.data.column_pointer == A.data.column_pointer );
+
+	mla::matrix::SparseCCSView<Scalar, uint32_t> view(file.path);
+	BOOST_CHECK_EQUAL( view.rows(), A.rows() );
+	BOOST_CHECK_EQUAL( view.columns(), A.columns() );
+	for(size_t i = 0; i < A.rows(); i++)
+	{
+		for(size_t j = 0; j < A.columns(); j++)
+		{
+			BOOST_REQUIRE_EQUAL( B.getValue(i,j), dok.getValue(i,j) );
+			BOOST_REQUIRE_EQUAL( view.getValue(i,j), dok.getValue(i,j) );
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( round_trip_DenseRowMajor, Scalar, scalar_list )
+{
+	mla::matrix::DenseRowMajor<Scalar> A(7, 5);
+	for(size_t i = 0; i < A.rows(); i++)
+		for(size_t j = 0; j < A.columns(); j++)
+			A(i,j) = (Scalar)(10*i + j);
+
+	TemporaryFile file;
+	mla::save_snapshot(A, file.path);
+
+	mla::matrix::DenseRowMajor<Scalar> B;
+	mla::load_snapshot(file.path, B);
+
+	mla::matrix::DenseRowMajorView<Scalar> view(file.path);
+
+	BOOST_CHECK_EQUAL( B.rows(), 7 );
+	BOOST_CHECK_EQUAL( B.columns(), 5 );
+	BOOST_CHECK_EQUAL( view.rows(), 7 );
+	BOOST_CHECK_EQUAL( view.columns(), 5 );
+	for(size_t i = 0; i < A.rows(); i++)
+	{
+		for(size_t j = 0; j < A.columns(); j++)
+		{
+			BOOST_CHECK_EQUAL( B.getValue(i,j), A.getValue(i,j) );
+			BOOST_CHECK_EQUAL( view.getValue(i,j), A.getValue(i,j) );
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( round_trip_vector_Dense, Scalar, scalar_list )
+{
+	mla::vector::Dense<Scalar> v(11);
+	for(size_t i = 0; i < v.size(); i++)
+		v[i] = (Scalar)i/3;
+
+	TemporaryFile file;
+	mla::save_snapshot(v, file.path);
+
+	mla::vector::Dense<Scalar> w;
+	mla::load_snapshot(file.path, w);
+
+	mla::vector::DenseView<Scalar> view(file.path);
+
+	BOOST_REQUIRE_EQUAL( w.size(), v.size() );
+	BOOST_REQUIRE_EQUAL( view.size(), v.size() );
+	for(size_t i = 0; i < v.size(); i++)
+	{
+		BOOST_CHECK_EQUAL( w.getValue(i), v.getValue(i) );
+		BOOST_CHECK_EQUAL( view[i], v.getValue(i) );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( gemv_SparseCRSView, Scalar, scalar_list )
+{
+	auto dok = random_sparse<Scalar>();
+	mla::matrix::SparseCRS<Scalar> A;
+	mla::matrix::convert(dok, A);
+
+	TemporaryFile file;
+	mla::save_snapshot(A, file.path);
+	mla::matrix::SparseCRSView<Scalar> view(file.path);
+
+	mla::vector::Dense<Scalar> x(A.columns()), y(A.rows()), y_view(A.rows());
+	for(size_t j = 0; j < x.size(); j++)
+		x[j] = (Scalar)j;
+
+	mla::gemv((Scalar)1, A, x, (Scalar)0, y);
+	mla::gemv((Scalar)1, view, x, (Scalar)0, y_view);
+
+	for(size_t i = 0; i < y.size(); i++)
+		BOOST_CHECK_EQUAL( y_view.getValue(i), y.getValue(i) );
+}
+
+
+BOOST_AUTO_TEST_CASE( invalid_snapshots )
+{
+	mla::matrix::DenseRowMajor<double> A(3, 3);
+	TemporaryFile file;
+	mla::save_snapshot(A, file.path);
+
+	// wrong kind and scalar type
+	mla::matrix::SparseCRS<double> B;
+	BOOST_CHECK_THROW( mla::load_snapshot(file.path, B), LAException );
+	mla::matrix::DenseRowMajor<float> C;
+	BOOST_CHECK_THROW( mla::load_snapshot(file.path, C), LAException );
+
+	// truncated file
+	{
+		std::ofstream truncated(file.path, std::ofstream::binary | std::ofstream::trunc);
+		mla::detail::SnapshotHeader header = {};
+		truncated.write(reinterpret_cast<char const *>(&header), 64);
+	}
+	mla::matrix::DenseRowMajor<double> D;
+	BOOST_CHECK_THROW( mla::load_snapshot(file.path, D), LAException );
+
+	// missing file
+	BOOST_CHECK_THROW( mla::load_snapshot(file.path + ".missing", D), LAException );
+
+	// indices that don't fit in 32 bits
+	mla::matrix::SparseCRS<double> E(1, (size_t)1 << 33);
+	TemporaryFile sparse_file;
+	BOOST_CHECK_THROW( mla::save_snapshot(E, sparse_file.path, mla::SNAPSHOT_INDEX_32), LAException );
+}
+
+
+BOOST_AUTO_TEST_CASE( overflowing_headers )
+{
+	TemporaryFile file;
+	mla::matrix::SparseCRS<double> A;
+	mla::matrix::DenseRowMajor<double> B;
+
+	// (rows+1)*8 wraps around to an empty row pointer array
+	mla::save_snapshot(mla::matrix::SparseCRS<double>(3, 3), file.path);
+	patch_header(file.path, [](mla::detail::SnapshotHeader &header)
+		{
+			header.rows = ((uint64_t)1 << 61) - 1;
+			header.size[0] = 0;
+		});
+	BOOST_CHECK_THROW( mla::load_snapshot(file.path, A), LAException );
+	BOOST_CHECK_THROW( mla::matrix::SparseCRSView<double> view(file.path), LAException );
+
+	// nnz*8 wraps around to empty index and value arrays
+	mla::save_snapshot(mla::matrix::SparseCRS<double>(3, 3), file.path);
+	patch_header(file.path, [](mla::detail::SnapshotHeader &header)
+		{
+			header.nnz = (uint64_t)1 << 61;
+			header.size[1] = 0;
+			header.size[2] = 0;
+		});
+	BOOST_CHECK_THROW( mla::load_snapshot(file.path, A), LAException );
+	BOOST_CHECK_THROW( mla::matrix::SparseCRSView<double> view(file.path), LAException );
+
+	// rows*columns wraps around to no elements at all
+	mla::save_snapshot(mla::matrix::DenseRowMajor<double>(0, 0), file.path);
+	patch_header(file.path, [](mla::detail::SnapshotHeader &header)
+		{
+			header.rows = (uint64_t)1 << 32;
+			header.columns = (uint64_t)1 << 32;
+			header.nnz = 0;
+		});
+	BOOST_CHECK_THROW( mla::load_snapshot(file.path, B), LAException );
+	BOOST_CHECK_THROW( mla::matrix::DenseRowMajorView<double> view(file.path), LAException );
+}
+
+
+BOOST_AUTO_TEST_CASE( verify_views )
+{
+	auto dok = random_sparse<double>();
+	mla::matrix::SparseCRS<double> A;
+	mla::matrix::SparseCCS<double> B;
+	mla::matrix::convert(dok, A);
+	mla::matrix::convert(dok, B);
+
+	TemporaryFile crs_file, ccs_file;
+	mla::save_snapshot(A, crs_file.path);
+	mla::save_snapshot(B, ccs_file.path);
+
+	mla::matrix::SparseCRSView<double>(crs_file.path).verify();
+	mla::matrix::SparseCCSView<double>(ccs_file.path).verify();
+
+	// a decreasing row pointer is only caught by verify()
+	patch_array<uint64_t>(crs_file.path, 0, 5, A.data.row_pointer.back() + 1);
+	BOOST_CHECK_THROW( mla::load_snapshot(crs_file.path, A), LAException );
+	mla::matrix::SparseCRSView<double> crs_view(crs_file.path);
+	BOOST_CHECK_THROW( crs_view.verify(), LAException );
+
+	// as is a row index out of range
+	patch_array<uint64_t>(ccs_file.path, 1, 0, B.rows());
+	BOOST_CHECK_THROW( mla::load_snapshot(ccs_file.path, B), LAException );
+	mla::matrix::SparseCCSView<double> ccs_view(ccs_file.path);
+	BOOST_CHECK_THROW( ccs_view.verify(), LAException );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
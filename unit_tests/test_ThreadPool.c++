@@ -0,0 +1,103 @@
+#define BOOST_TEST_MODULE ThreadPool
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include <mla/ThreadPool.h++>
+
+
+BOOST_AUTO_TEST_SUITE(test_ThreadPool)
+
+
+BOOST_AUTO_TEST_CASE( run_all_tasks )
+{
+	mla::ThreadPool pool(4);
+
+	BOOST_CHECK_EQUAL( pool.size(), 4 );
+
+	size_t const n_tasks = 1000;
+	std::vector<int> visited(n_tasks, 0);
+
+	pool.run(n_tasks, [&](size_t t) { visited[t]++; });
+
+	for(size_t t = 0; t < n_tasks; t++)
+	{
+		BOOST_CHECK_EQUAL( visited[t], 1 );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE( run_repeatedly )
+{
+	mla::ThreadPool pool(3);
+
+	std::atomic<size_t> counter(0);
+	for(size_t k = 0; k < 100; k++)
+	{
+		pool.run(7, [&](size_t) { counter++; });
+	}
+
+	BOOST_CHECK_EQUAL( counter.load(), 700 );
+}
+
+
+BOOST_AUTO_TEST_CASE( run_nested )
+{
+	mla::ThreadPool pool(2);
+
+	std::atomic<size_t> counter(0);
+	pool.run(4, [&](size_t) 
+	{
+		pool.run(4, [&](size_t) { counter++; });
+	});
+
+	BOOST_CHECK_EQUAL( counter.load(), 16 );
+}
+
+
+/**
+ * Exposes whether the calling thread is marked as running tasks
+ **/
+class InspectedThreadPool
+	: public mla::ThreadPool
+{
+public:
+	using mla::ThreadPool::ThreadPool;
+
+	static bool running_tasks()	{ return in_worker(); }
+};
+
+
+BOOST_AUTO_TEST_CASE( run_throwing_tasks )
+{
+	InspectedThreadPool pool(3);
+
+	// every thread that picks up a task throws, workers included
+	BOOST_CHECK_THROW( pool.run(64, [](size_t) { throw std::runtime_error("task"); }), std::runtime_error );
+	BOOST_CHECK( !InspectedThreadPool::running_tasks() );
+
+	// a single throwing task stops the run and its exception reaches the caller
+	std::atomic<size_t> counter(0);
+	BOOST_CHECK_THROW( pool.run(1000, [&](size_t t)
+	{
+		counter++;
+		if(t == 10)
+			throw std::logic_error("task 10");
+	}), std::logic_error );
+	BOOST_CHECK_LE( counter.load(), 1000 );
+	BOOST_CHECK( !InspectedThreadPool::running_tasks() );
+
+	// the pool is still usable afterwards
+	std::vector<int> visited(100, 0);
+	pool.run(visited.size(), [&](size_t t) { visited[t]++; });
+	for(size_t t = 0; t < visited.size(); t++)
+	{
+		BOOST_CHECK_EQUAL( visited[t], 1 );
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
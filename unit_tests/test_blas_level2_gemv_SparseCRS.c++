@@ -71,5 +71,133 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( blas_level2_test_gemv_zero, VectorType, vector_ty
 
 
 
+BOOST_AUTO_TEST_CASE( blas_level2_test_gemv_SparseCRS_Dense )
+{
+	using namespace mla;
+
+	// [ 1 0 2 ]
+	// [ 0 0 0 ]
+	// [ 3 4 5 ]
+	// [ 0 6 0 ]
+	MatrixType A(4, 3);
+	A.data.values = { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f };
+	A.data.column_index = { 0, 2, 0, 1, 2, 1 };
+	A.data.row_pointer = { 0, 2, 2, 5, 6 };
+
+	vector::Dense<Scalar> x(3);
+	x.setValue(0, 1.0f);
+	x.setValue(1, 2.0f);
+	x.setValue(2, 3.0f);
+
+	vector::Dense<Scalar> y(4);
+	for(size_t i = 0; i < y.size(); i++)
+	{
+		y.setValue(i, 1.0f);
+	}
+
+	Scalar const alpha = 2.0f;
+	Scalar const beta = 3.0f;
+	gemv(alpha, A, x, beta, y);
+
+	BOOST_CHECK_CLOSE( y.getValue(0), 2.0f*7.0f  + 3.0f, 1.0e-5 );
+	BOOST_CHECK_CLOSE( y.getValue(1), 3.0f, 1.0e-5 );
+	BOOST_CHECK_CLOSE( y.getValue(2), 2.0f*26.0f + 3.0f, 1.0e-5 );
+	BOOST_CHECK_CLOSE( y.getValue(3), 2.0f*12.0f + 3.0f, 1.0e-5 );
+}
+
+
+BOOST_AUTO_TEST_CASE( blas_level2_test_gemv_SparseCRS_partition )
+{
+	using namespace mla;
+
+	size_t const length = 100;
+
+	// lower triangular matrix, so later rows hold more non-zero elements
+	MatrixType A(length, length);
+	A.data.values.clear();
+	A.data.column_index.clear();
+	for(size_t i = 0; i < length; i++)
+	{
+		A.data.row_pointer[i] = A.data.values.size();
+		for(size_t j = 0; j <= i; j++)
+		{
+			A.data.column_index.push_back(j);
+			A.data.values.push_back(1.0f);
+		}
+	}
+	A.data.row_pointer[length] = A.data.values.size();
+
+	size_t const n_parts = 4;
+	std::vector<size_t> boundaries = partition_rows_by_nnz(A, n_parts);
+
+	BOOST_REQUIRE_EQUAL( boundaries.size(), n_parts + 1 );
+	BOOST_CHECK_EQUAL( boundaries.front(), 0 );
+	BOOST_CHECK_EQUAL( boundaries.back(), length );
+
+	size_t const nnz = A.data.values.size();
+	for(size_t p = 0; p < n_parts; p++)
+	{
+		BOOST_CHECK_LE( boundaries[p], boundaries[p+1] );
+
+		size_t part_nnz = A.data.row_pointer[boundaries[p+1]] - A.data.row_pointer[boundaries[p]];
+		BOOST_CHECK_LE( part_nnz, nnz/n_parts + length );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE( blas_level2_test_gemv_SparseCRS_threaded )
+{
+	using namespace mla;
+
+	size_t const rows = 3000, columns = 500;
+
+	// uneven rows, with a few long ones, for well over 64k non-zero elements
+	MatrixType A(rows, columns);
+	A.data.values.clear();
+	A.data.column_index.clear();
+	for(size_t i = 0; i < rows; i++)
+	{
+		A.data.row_pointer[i] = A.data.values.size();
+		size_t const row_nnz = (i*37)%97 + (i%50 == 0 ? columns : 1);
+		for(size_t k = 0; k < std::min(row_nnz, columns); k++)
+		{
+			size_t const j = (i + 7*k)%columns;
+			A.data.column_index.push_back(j);
+			A.data.values.push_back((Scalar)((i + j)%13) - 6.0f);
+		}
+	}
+	A.data.row_pointer[rows] = A.data.values.size();
+	BOOST_REQUIRE_GT( A.data.values.size(), 65536u );
+
+	mla::vector::Dense<Scalar> x(columns), y(rows);
+	for(size_t j = 0; j < columns; j++)
+	{
+		x[j] = (Scalar)(j%11) - 5.0f;
+	}
+	for(size_t i = 0; i < rows; i++)
+	{
+		y[i] = (Scalar)(i%5);
+	}
+
+	Scalar const alpha = 0.5f, beta = -2.0f;
+
+	std::vector<Scalar> expected(y.data);
+	gemv_rows(alpha, A, x.data.data(), beta, expected.data(), 0, rows);
+
+	// each row is computed by a single thread, so the results match exactly
+	ThreadPool pool(4);
+	std::vector<Scalar> threaded(y.data);
+	gemv_crs(alpha, rows, A.data.row_pointer.data(), A.data.column_index.data(), A.data.values.data(), x.data.data(), beta, threaded.data(), pool);
+
+	gemv(alpha, A, x, beta, y);
+
+	for(size_t i = 0; i < rows; i++)
+	{
+		BOOST_REQUIRE_EQUAL( threaded[i], expected[i] );
+		BOOST_REQUIRE_EQUAL( y.getValue(i), expected[i] );
+	}
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
 
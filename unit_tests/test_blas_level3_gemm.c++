@@ -4,6 +4,9 @@
 #include <boost/test/test_case_template.hpp>
 #include <boost/mpl/list.hpp>
 
+#include <cmath>
+#include <limits>
+#include <random>
 
 #include <mla/matrix/all.h++>
 #include <mla/vector/all.h++>
@@ -12,6 +15,61 @@
 #include <mla/operations/level3/gemm.h++>
 
 
+template<typename Scalar>
+void
+fill_random(mla::matrix::DenseRowMajor<Scalar> &A, unsigned seed)
+{
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+	for(size_t j = 0; j < A.columns(); j++)
+	{
+		for(size_t i = 0; i < A.rows(); i++)
+		{
+			A(i,j) = (Scalar)distribution(generator);
+		}
+	}
+}
+
+
+/**
+ * Naive reference product, accumulated in double precision
+ **/
+template<typename Scalar>
+void
+reference_gemm(Scalar alpha, mla::matrix::DenseRowMajor<Scalar> const &A, mla::matrix::DenseRowMajor<Scalar> const &B, Scalar beta, mla::matrix::DenseRowMajor<Scalar> &C)
+{
+	for(size_t i = 0; i < C.rows(); i++)
+	{
+		for(size_t j = 0; j < C.columns(); j++)
+		{
+			double value = 0;
+			for(size_t k = 0; k < A.columns(); k++)
+			{
+				value += (double)A.getValue(i,k)*B.getValue(k,j);
+			}
+			C(i,j) = (Scalar)(alpha*value + (beta == 0 ? 0.0 : (double)beta*C.getValue(i,j)));
+		}
+	}
+}
+
+
+template<typename Scalar>
+void
+check_equal(mla::matrix::DenseRowMajor<Scalar> const &C, mla::matrix::DenseRowMajor<Scalar> const &expected, size_t k)
+{
+	Scalar const tolerance = std::numeric_limits<Scalar>::epsilon()*8*(k+1);
+
+	for(size_t i = 0; i < C.rows(); i++)
+	{
+		for(size_t j = 0; j < C.columns(); j++)
+		{
+			BOOST_REQUIRE_SMALL( C.getValue(i,j) - expected.getValue(i,j), tolerance );
+		}
+	}
+}
+
+
 typedef boost::mpl::list<
 	mla::matrix::DenseRowMajor<float>,
 	mla::matrix::DenseRowMajor<double>
@@ -56,5 +114,134 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( matrix_matrix_multiply_identity, MatrixType, matr
 }
 
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( matrix_matrix_multiply_random, MatrixType, matrix_type_list )
+{
+	typedef typename MatrixType::scalar_type Scalar;
+
+	// sizes that aren't multiples of the register tiles nor of the cache blocks
+	size_t const sizes[][3] = { {1, 1, 1}, {7, 5, 3}, {17, 13, 29}, {33, 70, 9}, {130, 67, 300}, {61, 3100, 5} };
+
+	for(auto const &size: sizes)
+	{
+		size_t const m = size[0], n = size[1], k = size[2];
+
+		MatrixType A(m, k), B(k, n), C(m, n);
+		fill_random(A, 1);
+		fill_random(B, 2);
+		fill_random(C, 3);
+
+		MatrixType expected = C;
+		reference_gemm((Scalar)1.5, A, B, (Scalar)-0.5, expected);
+		mla::gemm((Scalar)1.5, A, B, (Scalar)-0.5, C);
+
+		check_equal(C, expected, k);
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( matrix_matrix_multiply_beta_zero, MatrixType, matrix_type_list )
+{
+	typedef typename MatrixType::scalar_type Scalar;
+
+	size_t const m = 23, n = 19, k = 11;
+
+	MatrixType A(m, k), B(k, n), C(m, n);
+	fill_random(A, 4);
+	fill_random(B, 5);
+
+	// C isn't read when beta is zero
+	for(size_t i = 0; i < m; i++)
+		for(size_t j = 0; j < n; j++)
+			C(i,j) = std::numeric_limits<Scalar>::quiet_NaN();
+
+	MatrixType expected(m, n);
+	reference_gemm((Scalar)1, A, B, (Scalar)0, expected);
+	mla::gemm((Scalar)1, A, B, (Scalar)0, C);
+
+	check_equal(C, expected, k);
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( matrix_matrix_multiply_threaded, MatrixType, matrix_type_list )
+{
+	typedef typename MatrixType::scalar_type Scalar;
+
+	// large enough to be split among threads and to span several cache blocks
+	size_t const m = 301, n = 263, k = 517;
+
+	MatrixType A(m, k), B(k, n), C(m, n);
+	fill_random(A, 6);
+	fill_random(B, 7);
+	fill_random(C, 8);
+
+	MatrixType expected = C;
+	reference_gemm((Scalar)-1, A, B, (Scalar)2, expected);
+	mla::gemm((Scalar)-1, A, B, (Scalar)2, C);
+
+	check_equal(C, expected, k);
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( matrix_matrix_multiply_portable_kernel, MatrixType, matrix_type_list )
+{
+	typedef typename MatrixType::scalar_type Scalar;
+
+	size_t const m = 37, n = 41, k = 300;
+
+	MatrixType A(m, k), B(k, n), C(m, n);
+	fill_random(A, 9);
+	fill_random(B, 10);
+	fill_random(C, 11);
+
+	MatrixType expected = C;
+	reference_gemm((Scalar)1, A, B, (Scalar)1, expected);
+
+	mla::detail::StridedMatrix<Scalar const> const A_view = { A.data.element_vector.data(), 1, m };
+	mla::detail::StridedMatrix<Scalar const> const B_view = { B.data.element_vector.data(), 1, k };
+	mla::detail::gemm_blocked< mla::detail::GemmKernelScalar<Scalar> >(m, n, k, (Scalar)1, A_view, B_view, (Scalar)1, C.data.element_vector.data(), m);
+
+	check_equal(C, expected, k);
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( sparse_dense_multiply, MatrixType, matrix_type_list )
+{
+	typedef typename MatrixType::scalar_type Scalar;
+
+	size_t const m = 200, n = 21, k = 150;
+
+	// a random sparse matrix, and its dense counterpart
+	std::mt19937 generator(12);
+	std::uniform_real_distribution<double> value(-1.0, 1.0);
+	std::uniform_int_distribution<size_t> column(0, k-1);
+
+	mla::matrix::SparseDOK<Scalar> dok(m, k);
+	MatrixType A_dense(m, k);
+	for(size_t i = 0; i < m; i++)
+	{
+		for(size_t e = 0; e < 6; e++)
+		{
+			size_t const j = column(generator);
+			Scalar const a = (Scalar)value(generator);
+			dok.setValue(i, j, a);
+			A_dense(i,j) = a;
+		}
+	}
+
+	mla::matrix::SparseCRS<Scalar> A;
+	mla::matrix::convert(dok, A);
+
+	MatrixType B(k, n), C(m, n);
+	fill_random(B, 13);
+	fill_random(C, 14);
+
+	MatrixType expected = C;
+	reference_gemm((Scalar)2, A_dense, B, (Scalar)0.5, expected);
+	mla::gemm((Scalar)2, A, B, (Scalar)0.5, C);
+
+	check_equal(C, expected, k);
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
 
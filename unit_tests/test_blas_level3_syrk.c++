@@ -4,6 +4,8 @@
 #include <boost/test/test_case_template.hpp>
 #include <boost/mpl/list.hpp>
 
+#include <limits>
+#include <random>
 
 #include <mla/matrix/all.h++>
 #include <mla/vector/all.h++>
@@ -53,5 +55,111 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( matrix_level3_syrk_ones, MatrixType, matrix_type_
 }
 
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( matrix_level3_syrk_triangle, MatrixType, matrix_type_list )
+{
+	typedef typename MatrixType::scalar_type Scalar;
+
+	std::mt19937 generator(1);
+	std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+	// sizes that aren't multiples of the register tiles, up to a threaded one
+	size_t const sizes[][2] = { {1, 1}, {5, 3}, {29, 17}, {70, 33}, {250, 400} };
+
+	for(auto const &size: sizes)
+	{
+		size_t const n = size[0], k = size[1];
+		Scalar const tolerance = std::numeric_limits<Scalar>::epsilon()*8*(k+1);
+
+		MatrixType A(n, k);
+		for(size_t i = 0; i < n; i++)
+			for(size_t p = 0; p < k; p++)
+				A(i,p) = (Scalar)distribution(generator);
+
+		MatrixType C0(n, n);
+		for(size_t i = 0; i < n; i++)
+			for(size_t j = 0; j < n; j++)
+				C0(i,j) = (Scalar)distribution(generator);
+
+		for(mla::Triangle triangle: {mla::TRIANGLE_LOWER, mla::TRIANGLE_UPPER})
+		{
+			MatrixType C = C0;
+			mla::syrk((Scalar)1.5, A, (Scalar)-1, C, triangle);
+
+			for(size_t i = 0; i < n; i++)
+			{
+				for(size_t j = 0; j < n; j++)
+				{
+					bool const inside = (triangle == mla::TRIANGLE_LOWER) ? i >= j : i <= j;
+					if(!inside)
+					{
+						// the other triangle is left untouched
+						BOOST_REQUIRE_EQUAL( C.getValue(i,j), C0.getValue(i,j) );
+						continue;
+					}
+
+					double value = 0;
+					for(size_t p = 0; p < k; p++)
+						value += (double)A.getValue(i,p)*A.getValue(j,p);
+					double const expected = 1.5*value - C0.getValue(i,j);
+
+					BOOST_REQUIRE_SMALL( C.getValue(i,j) - (Scalar)expected, tolerance );
+				}
+			}
+		}
+
+		// the full update is symmetric
+		MatrixType C(n, n);
+		mla::syrk((Scalar)1, A, (Scalar)0, C);
+		for(size_t i = 0; i < n; i++)
+			for(size_t j = 0; j < i; j++)
+				BOOST_REQUIRE_EQUAL( C.getValue(i,j), C.getValue(j,i) );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( matrix_level3_syrk_nonsymmetric_C, MatrixType, matrix_type_list )
+{
+	typedef typename MatrixType::scalar_type Scalar;
+
+	std::mt19937 generator(2);
+	std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+	for(size_t const n: {7, 90})
+	{
+		size_t const k = 13;
+		Scalar const tolerance = std::numeric_limits<Scalar>::epsilon()*8*(k+1);
+
+		MatrixType A(n, k), C0(n, n);
+		for(size_t i = 0; i < n; i++)
+			for(size_t p = 0; p < k; p++)
+				A(i,p) = (Scalar)distribution(generator);
+		for(size_t i = 0; i < n; i++)
+			for(size_t j = 0; j < n; j++)
+				C0(i,j) = (Scalar)distribution(generator);
+
+		// the full update of a C that isn't symmetric, for the dense and generic overloads
+		MatrixType C = C0;
+		mla::matrix::SparseDOK<Scalar> D(n, n);
+		mla::matrix::convert(C0, D);
+		mla::syrk((Scalar)0.5, A, (Scalar)2, C);
+		mla::syrk((Scalar)0.5, A, (Scalar)2, D);
+
+		for(size_t i = 0; i < n; i++)
+		{
+			for(size_t j = 0; j < n; j++)
+			{
+				double value = 0;
+				for(size_t p = 0; p < k; p++)
+					value += (double)A.getValue(i,p)*A.getValue(j,p);
+				double const expected = 0.5*value + 2.0*C0.getValue(i,j);
+
+				BOOST_REQUIRE_SMALL( C.getValue(i,j) - (Scalar)expected, tolerance );
+				BOOST_REQUIRE_SMALL( D.getValue(i,j) - (Scalar)expected, tolerance );
+			}
+		}
+	}
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -8,6 +8,7 @@
 #include <mla/matrix/all.h++>
 #include <mla/matrix/convert.h++>
 #include <mla/operations/cuthill_mckee.h++>
+#include <mla/operations/minimum_degree.h++>
 
 
 typedef boost::mpl::list<
@@ -45,12 +46,175 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( matrix_cuthill_mckee_arrowhead, MatrixType, matri
 	// the indices should be the same size as the matrix
 	BOOST_CHECK_EQUAL( indices.size(), matrix_size );
 
-	// Cuthill-McKee reorders matrices as arrowhead matrices
-	for(size_t i = 0; i < matrix_size; i++)
+	// the traversal starts at a leaf, a pseudo-peripheral vertex, then visits the hub
+	// and the remaining leaves
+	std::vector<size_t> expected = {1, 0, 2, 3, 4, 5};
+	BOOST_CHECK_EQUAL_COLLECTIONS( indices.begin(), indices.end(), expected.begin(), expected.end() );
+
+}
+
+
+/**
+ * Returns the bandwidth of the matrix P A P^T
+ */
+template<typename Scalar>
+size_t
+bandwidth(mla::matrix::SparseCRS<Scalar> const &A, std::vector<size_t> const &index)
+{
+	std::vector<size_t> position(index.size());
+	for(size_t k = 0; k < index.size(); k++)
+	{
+		position[index[k]] = k;
+	}
+
+	size_t band = 0;
+	for(size_t i = 0; i < A.rows(); i++)
+	{
+		for(size_t k = A.data.row_pointer[i]; k < A.data.row_pointer[i+1]; k++)
+		{
+			size_t const pi = position[i], pj = position[A.data.column_index[k]];
+			band = std::max(band, pi > pj ? pi-pj : pj-pi);
+		}
+	}
+	return band;
+}
+
+
+/**
+ * Checks that index is a permutation of 0 ... n-1
+ */
+void
+check_permutation(std::vector<size_t> const &index, size_t n)
+{
+	BOOST_REQUIRE_EQUAL( index.size(), n );
+	std::vector<bool> seen(n, false);
+	for(size_t i: index)
 	{
-		BOOST_CHECK_EQUAL( indices[i], i );
+		BOOST_REQUIRE_LT( i, n );
+		BOOST_CHECK( !seen[i] );
+		seen[i] = true;
 	}
+}
+
+
+/**
+ * Path graph with scrambled vertex numbers
+ */
+mla::matrix::SparseDOK<double>
+scrambled_path(size_t n)
+{
+	std::vector<size_t> label(n);
+	for(size_t i = 0; i < n; i++)
+	{
+		label[i] = (i*7) % n;	// n and 7 are coprime
+	}
+
+	mla::matrix::SparseDOK<double> dok(n, n);
+	for(size_t i = 0; i < n; i++)
+	{
+		dok.setValue(label[i], label[i], 2);
+		if(i+1 < n)
+		{
+			dok.setValue(label[i], label[i+1], -1);
+			dok.setValue(label[i+1], label[i], -1);
+		}
+	}
+
+	return dok;
+}
+
+
+BOOST_AUTO_TEST_CASE( reverse_cuthill_mckee_path )
+{
+	size_t const n = 30;
+	auto dok = scrambled_path(n);
+	mla::matrix::SparseCRS<double> A;
+	mla::matrix::SparseCCS<double> B;
+	mla::matrix::convert(dok, A);
+	mla::matrix::convert(dok, B);
+
+	std::vector<size_t> identity(n);
+	for(size_t i = 0; i < n; i++)
+	{
+		identity[i] = i;
+	}
+	BOOST_CHECK_GT( bandwidth(A, identity), 1u );
+
+	std::vector<size_t> index = mla::reverse_cuthill_mckee(A);
+	check_permutation(index, n);
+	BOOST_CHECK_EQUAL( bandwidth(A, index), 1u );
+
+	std::vector<size_t> index_ccs = mla::reverse_cuthill_mckee(B);
+	BOOST_CHECK_EQUAL_COLLECTIONS( index.begin(), index.end(), index_ccs.begin(), index_ccs.end() );
+}
+
+
+BOOST_AUTO_TEST_CASE( cuthill_mckee_disconnected )
+{
+	// two components and an isolated vertex
+	mla::matrix::SparseDOK<double> A(7, 7);
+	for(size_t i = 0; i < 7; i++)
+	{
+		A.setValue(i, i, 1);
+	}
+	A.setValue(0, 2, 1);
+	A.setValue(2, 4, 1);
+	A.setValue(1, 3, 1);
+	A.setValue(3, 6, 1);
+
+	std::vector<size_t> index = mla::cuthill_mckee(A);
+	check_permutation(index, 7);
+
+	// the isolated vertex has the lowest degree, then each path is traversed from an end
+	std::vector<size_t> expected = {5, 0, 2, 4, 1, 3, 6};
+	BOOST_CHECK_EQUAL_COLLECTIONS( index.begin(), index.end(), expected.begin(), expected.end() );
+}
+
+
+BOOST_AUTO_TEST_CASE( approximate_minimum_degree_arrowhead )
+{
+	size_t const n = 8;
+	mla::matrix::SparseDOK<double> A(n, n);
+	for(size_t i = 0; i < n; i++)
+	{
+		A.setValue(i, i, 4);
+		A.setValue(0, i, 1);
+		A.setValue(i, 0, 1);
+	}
+
+	std::vector<size_t> index = mla::approximate_minimum_degree(A);
+	check_permutation(index, n);
+
+	// eliminating the hub before the last leaf would create fill-in
+	BOOST_CHECK( index[n-1] == 0 || index[n-2] == 0 );
+}
+
+
+BOOST_AUTO_TEST_CASE( approximate_minimum_degree_grid )
+{
+	// 5-point grid: minimum degree eliminates the corners first
+	size_t const n = 6;
+	mla::matrix::SparseDOK<double> A(n*n, n*n);
+	for(size_t i = 0; i < n*n; i++)
+	{
+		A.setValue(i, i, 4);
+		if(i % n+1 < n)
+		{
+			A.setValue(i, i+1, -1);
+			A.setValue(i+1, i, -1);
+		}
+		if(i+n < n*n)
+		{
+			A.setValue(i, i+n, -1);
+			A.setValue(i+n, i, -1);
+		}
+	}
+
+	std::vector<size_t> index = mla::approximate_minimum_degree(A);
+	check_permutation(index, n*n);
 
+	size_t const first = index.front();
+	BOOST_CHECK( first == 0 || first == n-1 || first == n*n-n || first == n*n-1 );
 }
 
 
@@ -0,0 +1,331 @@
+#define BOOST_TEST_MODULE for_each_nonzero
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+
+#include <map>
+#include <random>
+#include <utility>
+
+#include <mla/matrix/all.h++>
+#include <mla/matrix/convert.h++>
+#include <mla/matrix/for_each_nonzero.h++>
+#include <mla/vector/all.h++>
+#include <mla/vector/for_each_nonzero.h++>
+
+#include <mla/operations/level1/dot.h++>
+#include <mla/operations/level1/axpy.h++>
+#include <mla/operations/level2/gemv.h++>
+
+
+typedef boost::mpl::list<
+	mla::matrix::SparseCRS<double>,
+	mla::matrix::SparseCCS<double>,
+	mla::matrix::DenseRowMajor<double>,
+	mla::matrix::SparseDOK<double>,
+	mla::matrix::SparseCOO<double>,
+	mla::matrix::SparseCRS<float>,
+	mla::matrix::SparseCCS<float>,
+	mla::matrix::DenseRowMajor<float>
+> matrix_type_list;
+
+
+typedef std::map<std::pair<size_t, size_t>, double> ElementMap;
+
+
+/**
+ * A random 25-by-20 sparse matrix, with empty rows and columns
+ **/
+template<typename Scalar>
+mla::matrix::SparseDOK<Scalar>
+random_sparse()
+{
+	std::mt19937 generator(3);
+	std::uniform_real_distribution<double> value(-1.0, 1.0);
+	std::uniform_int_distribution<size_t> row(0, 21), column(0, 17);
+
+	mla::matrix::SparseDOK<Scalar> A(25, 20);
+	for(size_t k = 0; k < 90; k++)
+	{
+		A.setValue(row(generator), column(generator), (Scalar)value(generator));
+	}
+	return A;
+}
+
+
+template<typename Scalar>
+void
+copy_matrix(mla::matrix::SparseDOK<Scalar> &from, mla::matrix::SparseDOK<Scalar> &to)
+{
+	to = from;
+}
+
+
+template<typename Scalar>
+void
+copy_matrix(mla::matrix::SparseDOK<Scalar> &from, mla::matrix::SparseCOO<Scalar> &to)
+{
+	to.resize(from.rows(), from.columns());
+	for(auto const &entry: from.data.key_value_map)
+	{
+		to.addValue(entry.first.first, entry.first.second, entry.second);
+	}
+}
+
+
+template<typename Scalar, template<typename> class MatrixType>
+void
+copy_matrix(mla::matrix::SparseDOK<Scalar> &from, MatrixType<Scalar> &to)
+{
+	mla::matrix::convert(from, to);
+}
+
+
+/**
+ * Gathers the elements visited in the rows [row_begin, row_end), failing on repeats
+ **/
+template<typename MatrixType>
+ElementMap
+visit(MatrixType const &A, size_t row_begin, size_t row_end)
+{
+	ElementMap elements;
+	mla::matrix::for_each_nonzero(A, row_begin, row_end, [&elements](size_t i, size_t j, typename MatrixType::scalar_type value)
+	{
+		BOOST_REQUIRE( elements.count(std::make_pair(i, j)) == 0 );
+		elements[std::make_pair(i, j)] = value;
+	});
+	return elements;
+}
+
+
+BOOST_AUTO_TEST_SUITE(for_each_nonzero)
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( visits_stored_elements, MatrixType, matrix_type_list )
+{
+	typedef typename MatrixType::scalar_type Scalar;
+
+	auto dok = random_sparse<Scalar>();
+	MatrixType A(dok.rows(), dok.columns());
+	copy_matrix(dok, A);
+
+	bool const is_dense = !mla::matrix::Traits<MatrixType>::is_sparse();
+
+	for(auto range: { std::make_pair<size_t, size_t>(0, 25), std::make_pair<size_t, size_t>(3, 17), std::make_pair<size_t, size_t>(20, 40) })
+	{
+		ElementMap const elements = visit(A, range.first, range.second);
+
+		for(size_t i = 0; i < A.rows(); i++)
+		{
+			for(size_t j = 0; j < A.columns(); j++)
+			{
+				auto const element = elements.find(std::make_pair(i, j));
+				bool const in_range = i >= range.first && i < range.second;
+
+				if(!in_range || (!is_dense && dok.getValue(i, j) == (Scalar)0))
+				{
+					BOOST_REQUIRE( element == elements.end() );
+				}
+				else
+				{
+					BOOST_REQUIRE( element != elements.end() );
+					BOOST_REQUIRE_EQUAL( element->second, dok.getValue(i, j) );
+				}
+			}
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE( visits_Diagonal )
+{
+	mla::matrix::Diagonal<double> A(6, 4);
+	for(size_t i = 0; i < 4; i++)
+	{
+		A.setValue(i, i, (double)(i+1));
+	}
+
+	ElementMap const elements = visit(A, 1, 6);
+
+	BOOST_REQUIRE_EQUAL( elements.size(), 3 );
+	for(size_t i = 1; i < 4; i++)
+	{
+		BOOST_CHECK_EQUAL( elements.at(std::make_pair(i, i)), (double)(i+1) );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE( visits_StaticDenseRowMajor )
+{
+	mla::matrix::StaticDenseRowMajor<double, 2, 3> A;
+	for(size_t i = 0; i < A.rows(); i++)
+	{
+		for(size_t j = 0; j < A.columns(); j++)
+		{
+			A.setValue(i, j, (double)(10*i + j));
+		}
+	}
+
+	ElementMap const elements = visit(A, 0, 2);
+
+	BOOST_REQUIRE_EQUAL( elements.size(), 6 );
+	for(size_t i = 0; i < A.rows(); i++)
+	{
+		for(size_t j = 0; j < A.columns(); j++)
+		{
+			BOOST_CHECK_EQUAL( elements.at(std::make_pair(i, j)), (double)(10*i + j) );
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE( visits_vectors )
+{
+	mla::vector::Dense<double> dense(4);
+	mla::vector::SparseCS<double> sparse(10);
+	sparse.setValue(2, 1.0);
+	sparse.setValue(7, -3.0);
+
+	std::map<size_t, double> elements;
+	mla::vector::for_each_nonzero(sparse, [&elements](size_t i, double value)
+	{
+		elements[i] = value;
+	});
+	BOOST_REQUIRE_EQUAL( elements.size(), 2 );
+	BOOST_CHECK_EQUAL( elements[2], 1.0 );
+	BOOST_CHECK_EQUAL( elements[7], -3.0 );
+
+	// non-const vectors may be updated in place
+	mla::vector::for_each_nonzero(dense, [](size_t i, double &value)
+	{
+		value = (double)i;
+	});
+	size_t count = 0;
+	mla::vector::Dense<double> const &const_dense = dense;
+	mla::vector::for_each_nonzero(const_dense, [&count](size_t i, double value)
+	{
+		BOOST_CHECK_EQUAL( value, (double)i );
+		count++;
+	});
+	BOOST_CHECK_EQUAL( count, 4 );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( gemv_against_dense, MatrixType, matrix_type_list )
+{
+	typedef typename MatrixType::scalar_type Scalar;
+
+	auto dok = random_sparse<Scalar>();
+	MatrixType A(dok.rows(), dok.columns());
+	copy_matrix(dok, A);
+
+	Scalar const a = (Scalar)1.5;
+	Scalar const b = (Scalar)-0.5;
+
+	mla::vector::Dense<Scalar> x(A.columns()), y(A.rows());
+	mla::vector::SparseCS<Scalar> sparse_x(A.columns()), sparse_y(A.rows());
+	for(size_t j = 0; j < x.size(); j += 3)
+	{
+		x[j] = (Scalar)(j+1);
+		sparse_x.setValue(j, (Scalar)(j+1));
+	}
+	for(size_t i = 0; i < y.size(); i += 2)
+	{
+		y[i] = (Scalar)i;
+		sparse_y.setValue(i, (Scalar)i);
+	}
+
+	std::vector<double> expected(A.rows());
+	for(size_t i = 0; i < A.rows(); i++)
+	{
+		double Ax = 0;
+		for(size_t j = 0; j < A.columns(); j++)
+		{
+			Ax += dok.getValue(i, j)*x.getValue(j);
+		}
+		expected[i] = a*Ax + b*y.getValue(i);
+	}
+
+	mla::gemv(a, A, x, b, y);
+	mla::gemv(a, A, sparse_x, b, sparse_y);
+
+	for(size_t i = 0; i < A.rows(); i++)
+	{
+		BOOST_CHECK_SMALL( y.getValue(i) - (Scalar)expected[i], (Scalar)1.0e-4 );
+		BOOST_CHECK_SMALL( sparse_y.getValue(i) - (Scalar)expected[i], (Scalar)1.0e-4 );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE( gemv_StaticDenseRowMajor_and_Diagonal )
+{
+	mla::matrix::StaticDenseRowMajor<double, 2, 3> A;
+	mla::matrix::Diagonal<double> D(2, 3);
+	for(size_t i = 0; i < A.rows(); i++)
+	{
+		for(size_t j = 0; j < A.columns(); j++)
+		{
+			A.setValue(i, j, (double)(i + j));
+		}
+		D.setValue(i, i, (double)(i+2));
+	}
+
+	mla::vector::Dense<double> x(3), y(2), z(2);
+	x[0] = 1.0;
+	x[1] = 2.0;
+	x[2] = 3.0;
+	y[0] = 1.0;
+	y[1] = 1.0;
+	z[0] = 1.0;
+	z[1] = 1.0;
+
+	mla::gemv(2.0, A, x, 3.0, y);
+	mla::gemv(1.0, D, x, 0.0, z);
+
+	BOOST_CHECK_EQUAL( y.getValue(0), 2.0*8.0 + 3.0 );
+	BOOST_CHECK_EQUAL( y.getValue(1), 2.0*14.0 + 3.0 );
+	BOOST_CHECK_EQUAL( z.getValue(0), 2.0 );
+	BOOST_CHECK_EQUAL( z.getValue(1), 6.0 );
+
+	// explicit template arguments, with the storage given as a template or as a type
+	mla::gemv<double, mla::matrix::Diagonal, mla::vector::Dense, mla::vector::Dense>(1.0, D, x, 1.0, z);
+	mla::gemv<double, mla::matrix::StaticDenseRowMajor<double, 2, 3>, mla::vector::Dense, mla::vector::Dense>(1.0, A, x, 0.0, y);
+
+	BOOST_CHECK_EQUAL( z.getValue(0), 4.0 );
+	BOOST_CHECK_EQUAL( z.getValue(1), 12.0 );
+	BOOST_CHECK_EQUAL( y.getValue(0), 8.0 );
+	BOOST_CHECK_EQUAL( y.getValue(1), 14.0 );
+}
+
+
+BOOST_AUTO_TEST_CASE( level1_sparse_and_dense )
+{
+	mla::vector::Dense<double> dense(6);
+	mla::vector::SparseCS<double> sparse(6), other(6);
+	for(size_t i = 0; i < 6; i++)
+	{
+		dense[i] = (double)(i+1);
+	}
+	sparse.setValue(1, 2.0);
+	sparse.setValue(4, -1.0);
+	other.setValue(0, 5.0);
+	other.setValue(4, 3.0);
+	other.setValue(5, 7.0);
+
+	BOOST_CHECK_EQUAL( mla::dot(sparse, dense), 2.0*2.0 - 5.0 );
+	BOOST_CHECK_EQUAL( mla::dot(dense, sparse), 2.0*2.0 - 5.0 );
+	BOOST_CHECK_EQUAL( mla::dot(sparse, other), -3.0 );
+	BOOST_CHECK_EQUAL( mla::dot(dense, dense), 91.0 );
+
+	mla::axpy(2.0, sparse, dense);
+	BOOST_CHECK_EQUAL( dense.getValue(1), 6.0 );
+	BOOST_CHECK_EQUAL( dense.getValue(4), 3.0 );
+	BOOST_CHECK_EQUAL( dense.getValue(5), 6.0 );
+
+	mla::vector::SparseCS<double> short_vector(3);
+	BOOST_CHECK_THROW( mla::axpy(1.0, short_vector, dense), LAException );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
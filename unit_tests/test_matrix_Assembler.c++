@@ -0,0 +1,146 @@
+#define BOOST_TEST_MODULE matrix
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+
+
+#include <mla/matrix/SparseCRS.h++>
+#include <mla/matrix/SparseCCS.h++>
+#include <mla/matrix/Assembler.h++>
+
+
+typedef boost::mpl::list<
+	float,
+	double
+> scalar_list;
+
+
+template <typename Scalar>
+using AssemblerType = mla::matrix::Assembler<Scalar>;
+
+
+/**
+ * Adds the elements of a 4x3 matrix, out of order and with split entries
+ * [ 1 0 2 ]
+ * [ 0 0 0 ]
+ * [ 3 4 5 ]
+ * [ 0 6 0 ]
+ */
+template <typename Scalar>
+void add_elements(AssemblerType<Scalar> &assembler, Scalar factor = 1)
+{
+	assembler.add(2, 2, factor*5);
+	assembler.add(0, 2, factor*2);
+	assembler.add(3, 1, factor*2);
+	assembler.add(2, 0, factor*3);
+	assembler.add(0, 0, factor*1);
+	assembler.add(3, 1, factor*4);
+	assembler.add(2, 1, factor*4);
+}
+
+
+BOOST_AUTO_TEST_SUITE(test_matrix)
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( Assemble_CRS, Scalar, scalar_list )
+{
+	AssemblerType<Scalar> assembler(4,3);
+	add_elements(assembler);
+
+	BOOST_CHECK_EQUAL(assembler.size(), 7);
+
+	mla::matrix::SparseCRS<Scalar> m;
+	assembler.assemble(m);
+
+	BOOST_CHECK_EQUAL(m.rows(), 4);
+	BOOST_CHECK_EQUAL(m.columns(), 3);
+
+	std::vector<size_t> row_pointer = { 0, 2, 2, 5, 6 };
+	std::vector<size_t> column_index = { 0, 2, 0, 1, 2, 1 };
+	std::vector<Scalar> values = { 1, 2, 3, 4, 5, 6 };
+
+	BOOST_CHECK_EQUAL_COLLECTIONS(m.data.row_pointer.begin(), m.data.row_pointer.end(), row_pointer.begin(), row_pointer.end());
+	BOOST_CHECK_EQUAL_COLLECTIONS(m.data.column_index.begin(), m.data.column_index.end(), column_index.begin(), column_index.end());
+	BOOST_CHECK_EQUAL_COLLECTIONS(m.data.values.begin(), m.data.values.end(), values.begin(), values.end());
+
+	BOOST_CHECK_EQUAL(m.getValue(1, 1), 0.0);
+	BOOST_CHECK_EQUAL(m.getValue(3, 1), 6.0);
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( Assemble_CCS, Scalar, scalar_list )
+{
+	AssemblerType<Scalar> assembler(4,3);
+	add_elements(assembler);
+
+	mla::matrix::SparseCCS<Scalar> m;
+	assembler.assemble(m);
+
+	BOOST_CHECK_EQUAL(m.rows(), 4);
+	BOOST_CHECK_EQUAL(m.columns(), 3);
+
+	std::vector<size_t> column_pointer = { 0, 2, 4, 6 };
+	std::vector<size_t> row_index = { 0, 2, 2, 3, 0, 2 };
+	std::vector<Scalar> values = { 1, 3, 4, 6, 2, 5 };
+
+	BOOST_CHECK_EQUAL_COLLECTIONS(m.data.column_pointer.begin(), m.data.column_pointer.end(), column_pointer.begin(), column_pointer.end());
+	BOOST_CHECK_EQUAL_COLLECTIONS(m.data.row_index.begin(), m.data.row_index.end(), row_index.begin(), row_index.end());
+	BOOST_CHECK_EQUAL_COLLECTIONS(m.data.values.begin(), m.data.values.end(), values.begin(), values.end());
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( Reassemble_fixed_pattern, Scalar, scalar_list )
+{
+	AssemblerType<Scalar> assembler(4,3);
+	add_elements(assembler);
+
+	mla::matrix::SparseCRS<Scalar> m;
+	assembler.assemble(m);
+
+	Scalar const *values = m.data.values.data();
+
+	assembler.restart();
+	BOOST_CHECK(assembler.isFixedPattern());
+
+	add_elements(assembler, (Scalar)2);
+	assembler.assemble(m);
+
+	// values are refilled in place
+	BOOST_CHECK_EQUAL(m.data.values.data(), values);
+	BOOST_CHECK_EQUAL(m.data.values.size(), 6);
+
+	BOOST_CHECK_EQUAL(m.getValue(0, 0), 2.0);
+	BOOST_CHECK_EQUAL(m.getValue(2, 2), 10.0);
+	BOOST_CHECK_EQUAL(m.getValue(3, 1), 12.0);
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( Reassemble_pattern_mismatch, Scalar, scalar_list )
+{
+	AssemblerType<Scalar> assembler(4,3);
+	add_elements(assembler);
+
+	mla::matrix::SparseCRS<Scalar> m;
+	assembler.assemble(m);
+
+	assembler.restart();
+	BOOST_CHECK_THROW(assembler.add(1, 1, (Scalar)1), LAException);
+
+	mla::matrix::SparseCCS<Scalar> n;
+	assembler.restart();
+	add_elements(assembler);
+	BOOST_CHECK_THROW(assembler.assemble(n), LAException);
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( Add_out_of_bounds, Scalar, scalar_list )
+{
+	AssemblerType<Scalar> assembler(4,3);
+
+	BOOST_CHECK_THROW(assembler.add(4, 0, (Scalar)1), LAException);
+	BOOST_CHECK_THROW(assembler.add(0, 3, (Scalar)1), LAException);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
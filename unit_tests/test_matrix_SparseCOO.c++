@@ -5,7 +5,11 @@
 #include <boost/mpl/list.hpp>
 
 
-#include <mla/matrix/SparseCOO.h++>
+#include <map>
+#include <random>
+
+#include <mla/matrix/all.h++>
+#include <mla/matrix/convert.h++>
 
 
 typedef boost::mpl::list<
@@ -218,6 +222,112 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( splitOutRight_diagonal_matrix, Scalar, scalar_lis
 
 
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( addValue_sums_repeated_coordinates, Scalar, scalar_list )
+{
+	MatrixType<Scalar> m(3,4);
+
+	m.addValue(2, 1, 1.0);
+	m.addValue(0, 3, 2.0);
+	m.addValue(2, 1, 3.0);
+	m.addValue(0, 0, 4.0);
+	m.addValue(2, 1, 5.0);
+
+	BOOST_CHECK_EQUAL(m.nnz(), 5);
+	BOOST_CHECK_EQUAL(m.getValue(2, 1), 9.0);
+	BOOST_CHECK_EQUAL(m.getValue(0, 3), 2.0);
+	BOOST_CHECK_EQUAL(m.getValue(1, 1), 0.0);
+
+	m.compress();
+
+	BOOST_CHECK_EQUAL(m.nnz(), 3);
+	BOOST_CHECK_EQUAL(m.getValue(2, 1), 9.0);
+
+	std::vector<size_t> const row_index = {0, 0, 2};
+	std::vector<size_t> const column_index = {0, 3, 1};
+	BOOST_CHECK( m.data.row_index == row_index );
+	BOOST_CHECK( m.data.column_index == column_index );
+
+	// setting a value merges the repeated coordinates first
+	m.addValue(0, 3, 1.0);
+	m(0, 3) += 10.0;
+	BOOST_CHECK_EQUAL(m.getValue(0, 3), 13.0);
+	BOOST_CHECK_EQUAL(m.nnz(), 3);
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( many_elements_against_map, Scalar, scalar_list )
+{
+	size_t const n = 200;
+	std::mt19937 generator(1);
+	std::uniform_int_distribution<size_t> index(0, n-1);
+
+	MatrixType<Scalar> m(n, n);
+	std::map< std::pair<size_t,size_t>, Scalar> expected;
+
+	// enough insertions to merge the unsorted tail many times
+	for(size_t k = 0; k < 20000; k++)
+	{
+		size_t const i = index(generator), j = index(generator);
+		if(k % 3 == 0)
+		{
+			m.setValue(i, j, (Scalar)k);
+			expected[std::make_pair(i,j)] = (Scalar)k;
+		}
+		else
+		{
+			m(i, j) += (Scalar)1;
+			expected[std::make_pair(i,j)] += (Scalar)1;
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL( m.nnz(), expected.size() );
+	for(auto const &kv: expected)
+	{
+		BOOST_REQUIRE_EQUAL( m.getValue(kv.first.first, kv.first.second), kv.second );
+	}
+
+	m.permuteRows(3, 7);
+	BOOST_CHECK_EQUAL( m.getValue(7, 5), expected[std::make_pair(3, 5)] );
+	BOOST_CHECK_EQUAL( m.getValue(3, 5), expected[std::make_pair(7, 5)] );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( convert_to_compressed, Scalar, scalar_list )
+{
+	MatrixType<Scalar> m(4,3);
+
+	m.addValue(3, 2, 1.0);
+	m.addValue(0, 1, 2.0);
+	m.addValue(3, 0, 3.0);
+	m.addValue(0, 1, 4.0);
+	m.addValue(1, 2, 5.0);
+	m.addValue(3, 2, 6.0);
+
+	mla::matrix::SparseCRS<Scalar> A;
+	mla::matrix::convert(m, A);
+
+	std::vector<size_t> const row_pointer = {0, 1, 2, 2, 4};
+	std::vector<size_t> const column_index = {1, 2, 0, 2};
+	std::vector<Scalar> const values = {6, 5, 3, 7};
+	BOOST_CHECK_EQUAL( A.rows(), 4 );
+	BOOST_CHECK_EQUAL( A.columns(), 3 );
+	BOOST_CHECK( A.data.row_pointer == row_pointer );
+	BOOST_CHECK( A.data.column_index == column_index );
+	BOOST_CHECK( A.data.values == values );
+
+	mla::matrix::SparseCCS<Scalar> B;
+	mla::matrix::convert(m, B);
+
+	std::vector<size_t> const column_pointer = {0, 1, 2, 4};
+	std::vector<size_t> const row_index = {3, 0, 1, 3};
+	std::vector<Scalar> const column_values = {3, 6, 5, 7};
+	BOOST_CHECK_EQUAL( B.rows(), 4 );
+	BOOST_CHECK_EQUAL( B.columns(), 3 );
+	BOOST_CHECK( B.data.column_pointer == column_pointer );
+	BOOST_CHECK( B.data.row_index == row_index );
+	BOOST_CHECK( B.data.values == column_values );
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -5,6 +5,9 @@
 #include <boost/mpl/list.hpp>
 
 
+#include <map>
+#include <random>
+
 #include <mla/matrix/SparseDOK.h++>
 
 
@@ -153,5 +156,58 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( symmetric_reorder_identity_matrix_2, Scalar, scal
 
 
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( many_elements_against_map, Scalar, scalar_list )
+{
+	size_t const n = 300;
+	std::mt19937 generator(1);
+	std::uniform_int_distribution<size_t> index(0, n-1);
+
+	MatrixType<Scalar> m(n, n);
+	std::map< std::pair<size_t,size_t>, Scalar> expected;
+
+	// enough insertions to grow the table several times, with repeated coordinates
+	for(size_t k = 0; k < 20000; k++)
+	{
+		size_t const i = index(generator), j = index(generator);
+		m(i,j) += (Scalar)1;
+		expected[std::make_pair(i,j)] += (Scalar)1;
+	}
+
+	BOOST_REQUIRE_EQUAL( m.nnz(), expected.size() );
+
+	size_t visited = 0;
+	for(auto const &kv: m.data.key_value_map)
+	{
+		BOOST_REQUIRE_EQUAL( kv.second, expected[kv.first] );
+		visited++;
+	}
+	BOOST_CHECK_EQUAL( visited, expected.size() );
+
+	// swap rows and columns with many elements, and compare with the swapped reference
+	m.permuteRows(3, 7);
+	m.permuteColumns(7, 11);
+
+	std::vector<size_t> order(n);
+	for(size_t i = 0; i < n; i++)
+	{
+		order[i] = n-1-i;
+	}
+	m.symmetricReorder(order);
+
+	auto swap = [](size_t k, size_t a, size_t b) { return k == a ? b : (k == b ? a : k); };
+	BOOST_REQUIRE_EQUAL( m.nnz(), expected.size() );
+	for(auto const &kv: expected)
+	{
+		size_t const i = order[swap(kv.first.first, 3, 7)];
+		size_t const j = order[swap(kv.first.second, 7, 11)];
+		BOOST_REQUIRE_EQUAL( m.getValue(i, j), kv.second );
+	}
+
+	m.setZero();
+	BOOST_CHECK_EQUAL( m.nnz(), 0 );
+	BOOST_CHECK_EQUAL( m.getValue(1, 1), 0.0 );
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -54,5 +54,36 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( matrix_convert, MatrixTypeTo, matrix_type_list )
 }
 
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( matrix_convert_from_SparseDOK, MatrixTypeTo, matrix_type_list )
+{
+	size_t matrix_size = 6;
+
+	typedef typename MatrixTypeTo::scalar_type Scalar;
+
+	mla::matrix::SparseDOK<Scalar> from(matrix_size, matrix_size);
+
+	from(0,0) = (Scalar)1;
+	from(0,3) = (Scalar)3;
+	from(3,0) = (Scalar)-3;
+	from(2,3) = (Scalar)5;
+	from(5,1) = (Scalar)7;
+
+	MatrixTypeTo to(matrix_size, matrix_size);
+
+	mla::matrix::convert(from, to);
+
+	BOOST_CHECK_EQUAL(from.rows(), to.rows());
+	BOOST_CHECK_EQUAL(from.columns(), to.columns());
+
+	for(size_t i = 0; i < matrix_size; i++)
+	{
+		for(size_t j = 0; j < matrix_size; j++)
+		{
+			BOOST_CHECK_EQUAL( from.getValue(i, j), to.getValue(i,j) );
+		}
+	}
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,311 @@
+#define BOOST_TEST_MODULE parsers
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include <mla/matrix/all.h++>
+#include <mla/parsers/MatrixMarket.h++>
+#include <mla/parsers/MatrixMarketLoader.h++>
+
+#include "config_paths.h"
+
+
+typedef boost::mpl::list<
+	float,
+	double
+> scalar_list;
+
+
+/**
+ * Loads a MatrixMarket file held in a string
+ **/
+template<typename MatrixType>
+MatrixType
+load(std::string const &text, size_t chunk_size = 1 << 22)
+{
+	mla::MatrixMarketLoader loader(text.data(), text.size());
+	loader.setChunkSize(chunk_size);
+
+	MatrixType A;
+	loader.load(A);
+	return A;
+}
+
+
+BOOST_AUTO_TEST_SUITE(parser_MatrixMarketLoader)
+
+
+BOOST_AUTO_TEST_CASE( parse_real_numbers )
+{
+	char const *numbers[] = {
+		"0", "-0.0", "1", "+2.5", "-3.25e2", "1.9316064083150e+06", "1e-22", "123456789012345",
+		"0.000001234", "1E5", "7.", ".5", "3.14159265358979323846", "1e-300", "2.2250738585072014e-308",
+		"9007199254740993", "1e23", "-inf", "nan"
+	};
+
+	for(char const *number: numbers)
+	{
+		std::string const text = std::string("  ") + number + "\n";
+		char const *p = text.data();
+
+		double value;
+		BOOST_REQUIRE( mla::detail::parse_real(p, text.data() + text.size(), value) );
+		BOOST_CHECK_EQUAL( *p, '\n' );
+
+		double const expected = std::strtod(number, nullptr);
+		if(expected != expected)
+			BOOST_CHECK( value != value );
+		else
+			BOOST_CHECK_EQUAL( value, expected );
+	}
+
+	char const *invalid[] = { "x", "-", "1.0x", "e5", "1e" };
+	for(char const *number: invalid)
+	{
+		std::string const text(number);
+		char const *p = text.data();
+		double value;
+		BOOST_CHECK( !mla::detail::parse_real(p, text.data() + text.size(), value) );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE( parse_random_real_numbers )
+{
+	std::mt19937 generator(1);
+	std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+	std::uniform_int_distribution<int> exponent(-40, 40);
+	std::uniform_int_distribution<int> precision(1, 17);
+
+	for(size_t n = 0; n < 10000; n++)
+	{
+		std::ostringstream stream;
+		stream.precision(precision(generator));
+		stream << mantissa(generator)*std::pow(10.0, exponent(generator));
+
+		std::string const text = stream.str();
+		char const *p = text.data();
+		double value;
+		BOOST_REQUIRE( mla::detail::parse_real(p, text.data() + text.size(), value) );
+		BOOST_REQUIRE_EQUAL( value, std::strtod(text.c_str(), nullptr) );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( coordinate_real_general, Scalar, scalar_list )
+{
+	std::string const text =
+		"%%MatrixMarket matrix coordinate real general\n"
+		"% comment\n"
+		"\n"
+		"3 4 5\n"
+		"1 1 1.0\n"
+		"3 1 -2.5e1\n"
+		"2 4 3\n"
+		"1 3 4.0\n"
+		"3 2 5.0\n";
+
+	auto A = load< mla::matrix::SparseCRS<Scalar> >(text);
+
+	BOOST_CHECK_EQUAL( A.rows(), 3 );
+	BOOST_CHECK_EQUAL( A.columns(), 4 );
+	BOOST_CHECK_EQUAL( A.data.values.size(), 5 );
+
+	std::vector<size_t> const row_pointer = {0, 2, 3, 5};
+	std::vector<size_t> const column_index = {0, 2, 3, 0, 1};
+	std::vector<Scalar> const values = {1, 4, 3, -25, 5};
+	BOOST_CHECK( A.data.row_pointer == row_pointer );
+	BOOST_CHECK( A.data.column_index == column_index );
+	BOOST_CHECK( A.data.values == values );
+
+	auto B = load< mla::matrix::SparseCCS<Scalar> >(text);
+
+	BOOST_CHECK_EQUAL( B.rows(), 3 );
+	BOOST_CHECK_EQUAL( B.columns(), 4 );
+	for(size_t i = 0; i < 3; i++)
+	{
+		for(size_t j = 0; j < 4; j++)
+		{
+			BOOST_CHECK_EQUAL( B.getValue(i,j), A.getValue(i,j) );
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( coordinate_symmetric, Scalar, scalar_list )
+{
+	std::string const text =
+		"%%MatrixMarket matrix coordinate real symmetric\n"
+		"3 3 4\n"
+		"1 1 2.0\n"
+		"3 1 -1.0\n"
+		"2 2 3.0\n"
+		"3 3 4.0\n";
+
+	auto A = load< mla::matrix::SparseCRS<Scalar> >(text);
+
+	BOOST_CHECK_EQUAL( A.data.values.size(), 5 );
+	BOOST_CHECK_EQUAL( A.getValue(0,0), 2 );
+	BOOST_CHECK_EQUAL( A.getValue(2,0), -1 );
+	BOOST_CHECK_EQUAL( A.getValue(0,2), -1 );
+	BOOST_CHECK_EQUAL( A.getValue(1,1), 3 );
+	BOOST_CHECK_EQUAL( A.getValue(2,2), 4 );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( coordinate_skew_symmetric, Scalar, scalar_list )
+{
+	std::string const text =
+		"%%MatrixMarket matrix coordinate real skew-symmetric\n"
+		"9 9 2\n"
+		"3 1 4.0\n"
+		"6 5 7.0\n";
+
+	auto A = load< mla::matrix::SparseCCS<Scalar> >(text);
+
+	BOOST_CHECK_EQUAL( A.data.values.size(), 4 );
+	BOOST_CHECK_EQUAL( A.getValue(2,0), 4 );
+	BOOST_CHECK_EQUAL( A.getValue(0,2), -4 );
+	BOOST_CHECK_EQUAL( A.getValue(5,4), 7 );
+	BOOST_CHECK_EQUAL( A.getValue(4,5), -7 );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( coordinate_pattern_and_integer, Scalar, scalar_list )
+{
+	auto A = load< mla::matrix::SparseCRS<Scalar> >(
+		"%%MatrixMarket matrix coordinate pattern general\n"
+		"2 2 2\n"
+		"1 2\n"
+		"2 1\n");
+
+	BOOST_CHECK_EQUAL( A.data.values.size(), 2 );
+	BOOST_CHECK_EQUAL( A.getValue(0,1), 1 );
+	BOOST_CHECK_EQUAL( A.getValue(1,0), 1 );
+
+	auto B = load< mla::matrix::SparseCRS<Scalar> >(
+		"%%MatrixMarket Matrix Coordinate Integer General\r\n"
+		"2 2 1\r\n"
+		"2 2 -7\r\n");
+
+	BOOST_CHECK_EQUAL( B.data.values.size(), 1 );
+	BOOST_CHECK_EQUAL( B.getValue(1,1), -7 );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( coordinate_unsorted_duplicates, Scalar, scalar_list )
+{
+	std::string const text =
+		"%%MatrixMarket matrix coordinate real general\n"
+		"2 3 5\n"
+		"1 3 1.0\n"
+		"1 1 2.0\n"
+		"1 3 3.0\n"
+		"2 2 4.0\n"
+		"2 1 5.0";	// no newline at the end of the file
+
+	auto A = load< mla::matrix::SparseCRS<Scalar> >(text);
+
+	std::vector<size_t> const row_pointer = {0, 2, 4};
+	std::vector<size_t> const column_index = {0, 2, 0, 1};
+	std::vector<Scalar> const values = {2, 4, 5, 4};
+	BOOST_CHECK( A.data.row_pointer == row_pointer );
+	BOOST_CHECK( A.data.column_index == column_index );
+	BOOST_CHECK( A.data.values == values );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( malformed_files, Scalar, scalar_list )
+{
+	typedef mla::matrix::SparseCRS<Scalar> Matrix;
+
+	// wrong number of entries
+	BOOST_CHECK_THROW( load<Matrix>("%%MatrixMarket matrix coordinate real general\n2 2 3\n1 1 1.0\n2 2 1.0\n"), LAException );
+
+	// out of range
+	BOOST_CHECK_THROW( load<Matrix>("%%MatrixMarket matrix coordinate real general\n2 2 1\n3 1 1.0\n"), LAException );
+	BOOST_CHECK_THROW( load<Matrix>("%%MatrixMarket matrix coordinate real general\n2 2 1\n0 1 1.0\n"), LAException );
+
+	// garbage
+	BOOST_CHECK_THROW( load<Matrix>("%%MatrixMarket matrix coordinate real general\n2 2 1\n1 1 abc\n"), LAException );
+	BOOST_CHECK_THROW( load<Matrix>("%%MatrixMarket matrix coordinate real general\n2 2 1\n1 1 1.0 2.0\n"), LAException );
+
+	// integers that overflow a size_t, which would otherwise wrap around to valid values
+	BOOST_CHECK_THROW( load<Matrix>("%%MatrixMarket matrix coordinate real general\n4 4 1\n18446744073709551618 1 2.0\n"), LAException );
+	BOOST_CHECK_THROW( load<Matrix>("%%MatrixMarket matrix coordinate real general\n4 4 1\n1 18446744073709551618 2.0\n"), LAException );
+	BOOST_CHECK_THROW( load<Matrix>("%%MatrixMarket matrix coordinate real general\n18446744073709551620 4 1\n1 1 2.0\n"), LAException );
+	BOOST_CHECK_THROW( load<Matrix>("%%MatrixMarket matrix coordinate real general\n4 18446744073709551620 1\n1 1 2.0\n"), LAException );
+	BOOST_CHECK_THROW( load<Matrix>("%%MatrixMarket matrix coordinate real general\n4 4 18446744073709551617\n1 1 2.0\n"), LAException );
+
+	// a huge number of entries in the header, over several chunks, isn't reserved up front
+	for(size_t chunk_size: {4, 16, 1 << 22})
+	{
+		BOOST_CHECK_THROW( load<Matrix>("%%MatrixMarket matrix coordinate real general\n2 2 1000000000000000000\n1 1 1.0\n2 2 1.0\n2 1 1.0\n", chunk_size), LAException );
+	}
+
+	// unsupported formats
+	BOOST_CHECK_THROW( load<Matrix>("%%MatrixMarket matrix coordinate complex general\n2 2 1\n1 1 1.0 2.0\n"), LAException );
+	BOOST_CHECK_THROW( load<Matrix>("%%MatrixMarket matrix array real general\n2 2\n1\n2\n3\n4\n"), LAException );
+	BOOST_CHECK_THROW( load<Matrix>("2 2 1\n1 1 1.0\n"), LAException );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( bcsstk14_against_MatrixMarket, Scalar, scalar_list )
+{
+	std::string const file_path = FULL_MATRIX_MARKET_FILES_PATH "coordinate/bcsstk14.mtx";
+
+	// reference, with the MatrixMarket parser
+	mla::MatrixMarket parser;
+	mla::matrix::SparseDOK<Scalar> expected;
+	std::ifstream file(file_path, std::ifstream::in);
+	BOOST_REQUIRE( file.is_open() );
+	parser.parse(file, expected);
+
+	mla::MatrixMarketLoader loader(file_path);
+	BOOST_CHECK_EQUAL( loader.header().rows, 1806 );
+	BOOST_CHECK_EQUAL( loader.header().nnz, 32630 );
+	BOOST_CHECK_EQUAL( loader.header().symmetry, mla::MatrixMarketLoader::SYMMETRY_SYMMETRIC );
+
+	// small chunks, to be parsed in parallel
+	for(size_t chunk_size: {(size_t)1 << 22, (size_t)4096, (size_t)64})
+	{
+		loader.setChunkSize(chunk_size);
+
+		mla::matrix::SparseCRS<Scalar> A;
+		loader.load(A);
+
+		mla::matrix::SparseCCS<Scalar> B;
+		loader.load(B);
+
+		BOOST_REQUIRE_EQUAL( A.rows(), 1806 );
+		BOOST_REQUIRE_EQUAL( A.columns(), 1806 );
+		BOOST_REQUIRE_EQUAL( A.data.values.size(), expected.data.key_value_map.size() );
+		BOOST_REQUIRE_EQUAL( B.data.values.size(), expected.data.key_value_map.size() );
+
+		for(auto const &kv: expected.data.key_value_map)
+		{
+			BOOST_REQUIRE_EQUAL( A.getValue(kv.first.first, kv.first.second), kv.second );
+			BOOST_REQUIRE_EQUAL( B.getValue(kv.first.first, kv.first.second), kv.second );
+		}
+
+		for(size_t i = 0; i < A.rows(); i++)
+		{
+			for(size_t k = A.data.row_pointer[i]+1; k < A.data.row_pointer[i+1]; k++)
+			{
+				BOOST_REQUIRE_LT( A.data.column_index[k-1], A.data.column_index[k] );
+			}
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,10 +4,13 @@
 #include <boost/test/test_case_template.hpp>
 #include <boost/mpl/list.hpp>
 
+#include <limits>
+
 
 #include <mla/matrix/all.h++>
 #include <mla/vector/all.h++>
 #include <mla/matrix/convert.h++>
+#include <mla/matrix/Assembler.h++>
 
 #include <mla/solvers/CG.h++>
 
@@ -20,6 +23,49 @@ typedef boost::mpl::list<
 > matrix_type_list;
 
 
+typedef boost::mpl::list<float, double> scalar_type_list;
+
+
+/**
+ * Builds the 5-point laplacian of a n-by-n grid, which is symmetric positive definite
+ */
+template<typename Scalar>
+mla::matrix::SparseCRS<Scalar>
+laplacian(size_t n)
+{
+	mla::matrix::Assembler<Scalar> assembler(n*n, n*n);
+	for(size_t i = 0; i < n*n; i++)
+	{
+		assembler.add(i, i, 4);
+		if(i % n > 0)	assembler.add(i, i-1, -1);
+		if(i % n+1 < n)	assembler.add(i, i+1, -1);
+		if(i >= n)	assembler.add(i, i-n, -1);
+		if(i+n < n*n)	assembler.add(i, i+n, -1);
+	}
+
+	mla::matrix::SparseCRS<Scalar> A;
+	assembler.assemble(A);
+	return A;
+}
+
+
+/**
+ * Checks that x solves [A]{x} = {b}
+ */
+template<typename Scalar>
+void
+check_solution(mla::matrix::SparseCRS<Scalar> &A, mla::vector::Dense<Scalar> &x, mla::vector::Dense<Scalar> &b, double tolerance)
+{
+	mla::vector::Dense<Scalar> Ax(b.size());
+	mla::gemv( (Scalar)1, A, x, (Scalar)0, Ax);
+
+	for(size_t i = 0; i < b.size(); i++)
+	{
+		BOOST_CHECK_SMALL( (double)(Ax.getValue(i) - b.getValue(i)), tolerance);
+	}
+}
+
+
 BOOST_AUTO_TEST_SUITE(test_solvers)
 
 
@@ -110,6 +156,205 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( solve_unit_3, MatrixType, matrix_type_list )
 }
 
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( pcg_identity, Scalar, scalar_type_list )
+{
+	auto A = laplacian<Scalar>(8);
+	mla::vector::Dense<Scalar> x(A.rows()), b(A.rows());
+	for(size_t i = 0; i < b.size(); i++)
+	{
+		b.setValue(i, (Scalar)(1 + i % 3));
+	}
+
+	mla::PCG<Scalar, mla::matrix::SparseCRS> solver;
+	solver.compute(A);
+	BOOST_CHECK_EQUAL( solver.solve(x, b, 1e-5, 200), mla::OK );
+
+	check_solution(A, x, b, 1e-3);
+
+	auto const &statistics = solver.statistics();
+	BOOST_CHECK_GT( statistics.iterations, 1u );
+	BOOST_CHECK_EQUAL( statistics.residual_history.size(), statistics.iterations+1 );
+	BOOST_CHECK_LE( statistics.residual_history.back(), 1e-5 );
+}
+
+
+BOOST_AUTO_TEST_CASE( pcg_large_iteration_cap )
+{
+	auto A = laplacian<double>(8);
+	mla::vector::Dense<double> x(A.rows()), b(A.rows());
+	for(size_t i = 0; i < b.size(); i++)
+	{
+		b.setValue(i, (double)(1 + i % 3));
+	}
+
+	mla::PCG<double, mla::matrix::SparseCRS> solver;
+	solver.compute(A);
+
+	// the cap isn't an allocation size
+	for(size_t max_iterations: {(size_t)1000000000, std::numeric_limits<size_t>::max()})
+	{
+		x.setZero();
+		BOOST_CHECK_EQUAL( solver.solve(x, b, 1e-8, max_iterations), mla::OK );
+		check_solution(A, x, b, 1e-6);
+		BOOST_CHECK_EQUAL( solver.statistics().residual_history.size(), solver.statistics().iterations+1 );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( pcg_jacobi, Scalar, scalar_type_list )
+{
+	auto A = laplacian<Scalar>(8);
+	mla::vector::Dense<Scalar> x(A.rows()), b(A.rows());
+	b.setValue(0, 1);
+	b.setValue(A.rows()-1, 2);
+
+	mla::PCG<Scalar, mla::matrix::SparseCRS, mla::JacobiPreconditioner> solver;
+	solver.compute(A);
+
+	BOOST_CHECK_CLOSE( solver.preconditioner().inverseDiagonal().getValue(3,3), (Scalar)0.25, 0.001f);
+
+	BOOST_CHECK_EQUAL( solver.solve(x, b, 1e-5, 200), mla::OK );
+	check_solution(A, x, b, 1e-3);
+}
+
+
+BOOST_AUTO_TEST_CASE( pcg_jacobi_DenseRowMajor )
+{
+	size_t const n = 5;
+	mla::matrix::DenseRowMajor<double> A(n, n);
+	mla::vector::Dense<double> x(n), b(n);
+	for(size_t i = 0; i < n; i++)
+	{
+		A.setValue(i, i, 2.0 + i);
+		if(i > 0)
+		{
+			A.setValue(i, i-1, -1);
+			A.setValue(i-1, i, -1);
+		}
+		b.setValue(i, 1);
+	}
+
+	mla::PCG<double, mla::matrix::DenseRowMajor, mla::JacobiPreconditioner> solver;
+	solver.compute(A);
+	BOOST_CHECK_EQUAL( solver.solve(x, b, 1e-10, 20), mla::OK );
+
+	for(size_t i = 0; i < n; i++)
+	{
+		double Ax = 0;
+		for(size_t j = 0; j < n; j++)
+		{
+			Ax += A.getValue(i,j)*x.getValue(j);
+		}
+		BOOST_CHECK_SMALL( Ax - b.getValue(i), 1e-8 );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( pcg_ssor, Scalar, scalar_type_list )
+{
+	auto A = laplacian<Scalar>(8);
+	mla::vector::Dense<Scalar> x(A.rows()), b(A.rows());
+	for(size_t i = 0; i < b.size(); i++)
+	{
+		b.setValue(i, 1);
+	}
+
+	mla::PCG<Scalar, mla::matrix::SparseCRS> cg;
+	cg.compute(A);
+	cg.solve(x, b, 1e-5, 200);
+
+	x.setZero();
+	mla::PCG<Scalar, mla::matrix::SparseCRS, mla::SSORPreconditioner> solver(mla::SSORPreconditioner<Scalar>(1.5));
+	solver.compute(A);
+	BOOST_CHECK_EQUAL( solver.solve(x, b, 1e-5, 200), mla::OK );
+
+	check_solution(A, x, b, 1e-3);
+	BOOST_CHECK_LT( solver.statistics().iterations, cg.statistics().iterations );
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( pcg_ic0, Scalar, scalar_type_list )
+{
+	auto A = laplacian<Scalar>(8);
+	mla::vector::Dense<Scalar> x(A.rows()), b(A.rows());
+	for(size_t i = 0; i < b.size(); i++)
+	{
+		b.setValue(i, 1);
+	}
+
+	mla::PCG<Scalar, mla::matrix::SparseCRS> cg;
+	cg.compute(A);
+	cg.solve(x, b, 1e-5, 200);
+
+	x.setZero();
+	mla::PCG<Scalar, mla::matrix::SparseCRS, mla::IC0Preconditioner> solver;
+	solver.compute(A);
+	BOOST_CHECK_EQUAL( solver.solve(x, b, 1e-5, 200), mla::OK );
+
+	check_solution(A, x, b, 1e-3);
+	BOOST_CHECK_LT( solver.statistics().iterations, cg.statistics().iterations );
+}
+
+
+BOOST_AUTO_TEST_CASE( pcg_ic0_tridiagonal )
+{
+	// a tridiagonal matrix has no fill-in, so IC(0) is its exact Cholesky factor
+	size_t const n = 20;
+	mla::matrix::Assembler<double> assembler(n, n);
+	for(size_t i = 0; i < n; i++)
+	{
+		assembler.add(i, i, 2);
+		if(i > 0)	assembler.add(i, i-1, -1);
+		if(i+1 < n)	assembler.add(i, i+1, -1);
+	}
+	mla::matrix::SparseCRS<double> A;
+	assembler.assemble(A);
+
+	mla::vector::Dense<double> x(n), b(n);
+	b.setValue(n/2, 1);
+
+	mla::PCG<double, mla::matrix::SparseCRS, mla::IC0Preconditioner> solver;
+	solver.compute(A);
+	BOOST_CHECK_EQUAL( solver.solve(x, b, 1e-10, 10), mla::OK );
+	BOOST_CHECK_EQUAL( solver.statistics().iterations, 1u );
+
+	check_solution(A, x, b, 1e-10);
+}
+
+
+BOOST_AUTO_TEST_CASE( pcg_zero_rhs )
+{
+	auto A = laplacian<double>(4);
+	mla::vector::Dense<double> x(A.rows()), b(A.rows());
+	x.setValue(0, 1);
+
+	mla::PCG<double, mla::matrix::SparseCRS> solver;
+	solver.compute(A);
+	BOOST_CHECK_EQUAL( solver.solve(x, b, 1e-8, 10), mla::OK );
+	BOOST_CHECK_EQUAL( x.getValue(0), 0 );
+	BOOST_CHECK_EQUAL( solver.statistics().iterations, 0u );
+}
+
+
+BOOST_AUTO_TEST_CASE( pcg_not_positive_definite )
+{
+	size_t const n = 4;
+	mla::matrix::SparseCRS<double> A(n, n);
+	A.setEye();
+	A.setValue(2, 2, -1);
+
+	mla::vector::Dense<double> x(n), b(n);
+	b.setValue(2, 1);
+
+	mla::PCG<double, mla::matrix::SparseCRS> solver;
+	solver.compute(A);
+	BOOST_CHECK_EQUAL( solver.solve(x, b, 1e-8, 10), mla::ERR_NOT_POSITIVE_DEFINITE );
+
+	mla::IC0Preconditioner<double> ic0;
+	BOOST_CHECK_THROW( ic0.compute(A), LAException );
+}
+
+
 
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,249 @@
+#define BOOST_TEST_MODULE matrix
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+
+
+#include <mla/matrix/all.h++>
+#include <mla/vector/all.h++>
+#include <mla/matrix/convert.h++>
+#include <mla/matrix/Assembler.h++>
+
+#include <mla/solvers/Cholesky.h++>
+
+
+typedef boost::mpl::list<float, double> scalar_type_list;
+
+
+/**
+ * Builds the 5-point laplacian of a n-by-n grid, plus shift on the diagonal
+ */
+template<typename Scalar>
+mla::matrix::Assembler<Scalar>
+laplacian(size_t n, Scalar shift = 0)
+{
+	mla::matrix::Assembler<Scalar> assembler(n*n, n*n);
+	for(size_t i = 0; i < n*n; i++)
+	{
+		assembler.add(i, i, 4 + shift);
+		if(i % n > 0)	assembler.add(i, i-1, -1);
+		if(i % n+1 < n)	assembler.add(i, i+1, -1);
+		if(i >= n)	assembler.add(i, i-n, -1);
+		if(i+n < n*n)	assembler.add(i, i+n, -1);
+	}
+	return assembler;
+}
+
+
+/**
+ * Checks that x solves [A]{x} = {b}
+ */
+template<typename Scalar>
+void
+check_solution(mla::matrix::SparseCRS<Scalar> &A, mla::vector::Dense<Scalar> const &x, mla::vector::Dense<Scalar> const &b, double tolerance)
+{
+	for(size_t i = 0; i < A.rows(); i++)
+	{
+		double Ax = 0;
+		for(size_t k = A.data.row_pointer[i]; k < A.data.row_pointer[i+1]; k++)
+		{
+			Ax += A.data.values[k]*x.data[A.data.column_index[k]];
+		}
+		BOOST_CHECK_SMALL( Ax - b.getValue(i), tolerance );
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(test_solvers)
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( cholesky_dense, Scalar, scalar_type_list )
+{
+	size_t const n = 4;
+	mla::matrix::DenseRowMajor<Scalar> A(n, n), L;
+	mla::vector::Dense<Scalar> x(n), b(n);
+
+	for(size_t i = 0; i < n; i++)
+	{
+		A.setValue(i, i, 4);
+		if(i > 0)
+		{
+			A.setValue(i, i-1, 1);
+			A.setValue(i-1, i, 1);
+		}
+		b.setValue(i, (Scalar)(i+1));
+	}
+
+	BOOST_CHECK_EQUAL( mla::cholesky(A, x, b, L), mla::OK );
+	BOOST_CHECK_CLOSE( L.getValue(0,0), (Scalar)2, 0.001f );
+	BOOST_CHECK_CLOSE( L.getValue(1,0), (Scalar)0.5, 0.001f );
+	BOOST_CHECK_EQUAL( L.getValue(0,1), (Scalar)0 );
+
+	for(size_t i = 0; i < n; i++)
+	{
+		Scalar Ax = 0;
+		for(size_t j = 0; j < n; j++)
+		{
+			Ax += A.getValue(i,j)*x.getValue(j);
+		}
+		BOOST_CHECK_CLOSE( Ax, b.getValue(i), 0.01f );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( sparse_cholesky_orderings, Scalar, scalar_type_list )
+{
+	typedef mla::SparseCholesky<Scalar> Cholesky;
+
+	auto assembler = laplacian<Scalar>(7);
+	mla::matrix::SparseCRS<Scalar> A;
+	mla::matrix::SparseCCS<Scalar> B;
+	assembler.assemble(A);
+	assembler.resize(0,0);
+	laplacian<Scalar>(7).assemble(B);
+
+	mla::vector::Dense<Scalar> x, b(A.rows());
+	for(size_t i = 0; i < b.size(); i++)
+	{
+		b.setValue(i, (Scalar)(1 + i % 5));
+	}
+
+	size_t nnz_natural = 0;
+	for(auto ordering: {Cholesky::ORDERING_NATURAL, Cholesky::ORDERING_RCM, Cholesky::ORDERING_AMD})
+	{
+		Cholesky crs(ordering);
+		BOOST_CHECK_EQUAL( crs.factorize(A), mla::OK );
+		BOOST_CHECK_EQUAL( crs.solve(x, b), mla::OK );
+		check_solution(A, x, b, 1e-3);
+
+		Cholesky ccs(ordering);
+		BOOST_CHECK_EQUAL( ccs.factorize(B), mla::OK );
+		BOOST_CHECK_EQUAL( ccs.nnz(), crs.nnz() );
+		BOOST_CHECK_EQUAL( ccs.solve(x, b), mla::OK );
+		check_solution(A, x, b, 1e-3);
+
+		if(ordering == Cholesky::ORDERING_NATURAL)
+			nnz_natural = crs.nnz();
+		else
+			BOOST_CHECK_LT( crs.nnz(), nnz_natural );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE( sparse_cholesky_factor )
+{
+	// L L^T must reproduce P A P^T
+	auto assembler = laplacian<double>(5, 1);
+	mla::matrix::SparseCRS<double> A;
+	assembler.assemble(A);
+
+	mla::SparseCholesky<double> cholesky;
+	BOOST_CHECK_EQUAL( cholesky.factorize(A), mla::OK );
+	BOOST_CHECK_LT( cholesky.supernodes(), A.rows() );
+
+	mla::matrix::SparseCCS<double> L;
+	cholesky.getFactor(L);
+	BOOST_CHECK_EQUAL( L.data.values.size(), cholesky.nnz() );
+
+	size_t const n = A.rows();
+	mla::matrix::DenseRowMajor<double> LLt(n, n);
+	for(size_t k = 0; k < n; k++)
+	{
+		for(size_t p = L.data.column_pointer[k]; p < L.data.column_pointer[k+1]; p++)
+		{
+			for(size_t q = L.data.column_pointer[k]; q < L.data.column_pointer[k+1]; q++)
+			{
+				size_t const i = L.data.row_index[p], j = L.data.row_index[q];
+				LLt.setValue(i, j, LLt.getValue(i,j) + L.data.values[p]*L.data.values[q]);
+			}
+		}
+	}
+
+	auto const &permutation = cholesky.data.permutation;
+	for(size_t i = 0; i < n; i++)
+	{
+		for(size_t j = 0; j < n; j++)
+		{
+			BOOST_CHECK_SMALL( LLt.getValue(i,j) - A.getValue(permutation[i], permutation[j]), 1e-10 );
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE( sparse_cholesky_refactorize )
+{
+	auto assembler = laplacian<double>(6);
+	mla::matrix::SparseCRS<double> A;
+	assembler.assemble(A);
+
+	mla::SparseCholesky<double> cholesky;
+	cholesky.analyze(A);
+	BOOST_CHECK( cholesky.isAnalyzed() );
+	BOOST_CHECK( !cholesky.isFactorized() );
+	BOOST_CHECK_EQUAL( cholesky.factorize(A), mla::OK );
+
+	// same sparsity pattern, new values
+	auto shifted = laplacian<double>(6, 3);
+	mla::matrix::SparseCRS<double> B;
+	shifted.assemble(B);
+	BOOST_CHECK_EQUAL( cholesky.factorize(B), mla::OK );
+
+	mla::vector::Dense<double> x, b(B.rows());
+	b.setValue(0, 1);
+	b.setValue(20, -2);
+	BOOST_CHECK_EQUAL( cholesky.solve(x, b), mla::OK );
+	check_solution(B, x, b, 1e-10);
+
+	// a different sparsity pattern is rejected
+	mla::matrix::SparseCRS<double> C(B.rows(), B.columns());
+	C.setEye();
+	BOOST_CHECK_THROW( cholesky.factorize(C), LAException );
+}
+
+
+BOOST_AUTO_TEST_CASE( sparse_cholesky_lower_triangle )
+{
+	// only the lower triangle of A is stored
+	size_t const n = 10;
+	mla::matrix::Assembler<double> full(n, n), lower(n, n);
+	for(size_t i = 0; i < n; i++)
+	{
+		full.add(i, i, 3);
+		lower.add(i, i, 3);
+		if(i > 0)
+		{
+			full.add(i, i-1, -1);
+			full.add(i-1, i, -1);
+			lower.add(i, i-1, -1);
+		}
+	}
+
+	mla::matrix::SparseCRS<double> A;
+	mla::matrix::SparseCCS<double> A_lower;
+	full.assemble(A);
+	lower.assemble(A_lower);
+
+	mla::vector::Dense<double> x, b(n);
+	b.setValue(n-1, 1);
+
+	BOOST_CHECK_EQUAL( mla::cholesky(A_lower, x, b), mla::OK );
+	check_solution(A, x, b, 1e-12);
+}
+
+
+BOOST_AUTO_TEST_CASE( sparse_cholesky_not_positive_definite )
+{
+	size_t const n = 5;
+	mla::matrix::SparseCRS<double> A(n, n);
+	A.setEye();
+	A.setValue(3, 3, -2);
+
+	mla::vector::Dense<double> x, b(n);
+	mla::SparseCholesky<double> cholesky;
+	BOOST_CHECK_EQUAL( cholesky.factorize(A), mla::ERR_NOT_POSITIVE_DEFINITE );
+	BOOST_CHECK_THROW( cholesky.solve(x, b), LAException );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
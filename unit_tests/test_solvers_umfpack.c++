@@ -8,6 +8,7 @@
 #include <mla/matrix/all.h++>
 #include <mla/vector/all.h++>
 #include <mla/matrix/convert.h++>
+#include <mla/matrix/Assembler.h++>
 
 #include <mla/solvers/umfpack.h++>
 
@@ -111,6 +112,138 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( solve_unit_3, MatrixType, matrix_type_list )
 }
 
 
+/**
+ * Builds a nonsymmetric tridiagonal matrix with the given diagonal
+ */
+mla::matrix::SparseCCS<double>
+tridiagonal(size_t n, double diagonal)
+{
+	mla::matrix::Assembler<double> assembler(n, n);
+	for(size_t i = 0; i < n; i++)
+	{
+		assembler.add(i, i, diagonal);
+		if(i > 0)	assembler.add(i, i-1, -1);
+		if(i+1 < n)	assembler.add(i, i+1, -2);
+	}
+
+	mla::matrix::SparseCCS<double> A;
+	assembler.assemble(A);
+	return A;
+}
+
+
+/**
+ * Checks that x solves [A]{x} = {b}
+ */
+void
+check_solution(mla::matrix::SparseCCS<double> const &A, mla::vector::Dense<double> const &x, mla::vector::Dense<double> const &b)
+{
+	for(size_t i = 0; i < A.rows(); i++)
+	{
+		double Ax = 0;
+		for(size_t j = 0; j < A.columns(); j++)
+		{
+			Ax += A.getValue(i,j)*x.getValue(j);
+		}
+		BOOST_CHECK_SMALL( Ax - b.getValue(i), 1e-10 );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE( factorization_many_rhs )
+{
+	size_t const n = 10;
+	auto A = tridiagonal(n, 4);
+
+	mla::UmfpackFactorization lu;
+	BOOST_CHECK( !lu.isFactorized() );
+	BOOST_CHECK_EQUAL( lu.factorize(A), mla::OK );
+	BOOST_CHECK( lu.isAnalyzed() );
+	BOOST_CHECK( lu.isFactorized() );
+
+	std::vector<mla::vector::Dense<double> > x, b(3, mla::vector::Dense<double>(n));
+	for(size_t k = 0; k < b.size(); k++)
+	{
+		b[k].setValue(k, 1);
+		b[k].setValue(n-1, (double)k);
+	}
+
+	BOOST_CHECK_EQUAL( lu.solve(x, b), mla::OK );
+	BOOST_REQUIRE_EQUAL( x.size(), b.size() );
+	for(size_t k = 0; k < b.size(); k++)
+	{
+		check_solution(A, x[k], b[k]);
+	}
+
+	// the columns of B as right-hand sides
+	mla::matrix::DenseRowMajor<double> X, B(n, b.size());
+	for(size_t k = 0; k < b.size(); k++)
+	{
+		for(size_t i = 0; i < n; i++)
+		{
+			B.setValue(i, k, b[k].getValue(i));
+		}
+	}
+
+	BOOST_CHECK_EQUAL( lu.solve(X, B), mla::OK );
+	BOOST_REQUIRE_EQUAL( X.columns(), b.size() );
+	for(size_t k = 0; k < b.size(); k++)
+	{
+		for(size_t i = 0; i < n; i++)
+		{
+			BOOST_CHECK_CLOSE( X.getValue(i, k), x[k].getValue(i), 1e-8 );
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE( factorization_refactorize )
+{
+	size_t const n = 8;
+	auto A = tridiagonal(n, 4);
+
+	mla::UmfpackFactorization lu;
+	BOOST_CHECK_EQUAL( lu.analyze(A), mla::OK );
+	BOOST_CHECK( !lu.isFactorized() );
+	BOOST_CHECK_EQUAL( lu.factorize(A), mla::OK );
+
+	// same sparsity pattern, new values
+	auto B = tridiagonal(n, 9);
+	BOOST_CHECK_EQUAL( lu.refactorize(B), mla::OK );
+
+	mla::vector::Dense<double> x, b(n);
+	b.setValue(0, 1);
+	b.setValue(n/2, -3);
+	BOOST_CHECK_EQUAL( lu.solve(x, b), mla::OK );
+	check_solution(B, x, b);
+
+	// a different sparsity pattern requires a new analysis
+	mla::matrix::SparseCCS<double> C(n, n);
+	C.setEye();
+	BOOST_CHECK_THROW( lu.refactorize(C), LAException );
+	BOOST_CHECK_EQUAL( lu.factorize(C), mla::OK );
+	BOOST_CHECK_EQUAL( lu.solve(x, b), mla::OK );
+	check_solution(C, x, b);
+}
+
+
+BOOST_AUTO_TEST_CASE( factorization_errors )
+{
+	mla::UmfpackFactorization lu;
+	mla::vector::Dense<double> x, b(4);
+	mla::matrix::SparseCCS<double> A(4, 4);
+	A.setEye();
+
+	BOOST_CHECK_THROW( lu.refactorize(A), LAException );
+
+	BOOST_CHECK_EQUAL( lu.analyze(A), mla::OK );
+	BOOST_CHECK_THROW( lu.solve(x, b), LAException );
+
+	mla::matrix::SparseCCS<double> rectangular(4, 3);
+	BOOST_CHECK_THROW( lu.analyze(rectangular), LAException );
+}
+
+
 
 BOOST_AUTO_TEST_SUITE_END()
 